@@ -110,6 +110,24 @@ def lookup_rfid():
 
     except Exception as e:
         return jsonify({"status": "error", "message": str(e)}), 500
+
+@master.route('/rfid_registry', methods=['GET'])
+def rfid_registry():
+    # Full RFID -> UPC table, pushed to the cart at session start
+    try:
+        conn = get_db_connection()
+        rows = conn.execute("SELECT rfid_id, upc FROM ProductRFIDs").fetchall()
+        conn.close()
+
+        products = [{"rfid_id": row["rfid_id"], "upc": row["upc"]} for row in rows]
+
+        return jsonify({
+            "status": "success",
+            "products": products
+        })
+
+    except Exception as e:
+        return jsonify({"status": "error", "message": str(e)}), 500
     
 @master.route('/update_stock', methods=['POST'])
 def update_stock():
@@ -41,6 +41,13 @@ TRANSFER_UUID = "81de7ab2-7bb5-4a08-91ad-73165d9d2bb0"
 MISC_UUID = "b8ce8946-c4d4-486a-91fe-9fea2a670262"
 
 OFFSET_TOLERANCE = 12
+REG_BATCH_MAX_LEN = 180
+GRAMS_PER_OZ = 28.3495
+EW_TOLERANCE_FRACTION = 0.10
+EW_MIN_TOLERANCE_G = 15
+
+# Produce weighings expected on the cart per UPC (grams), so a removed row can be taken back out
+expected_produce = {}
 
 # Database helper functions
 def get_setting_conn():
@@ -355,12 +362,29 @@ async def handle_upc_notification(sender, data):
         cart_item = add_to_cart(product, 1)
         notify_ui(cart_item)
 
+        # Let the cart check the settled weight against this item locally
+        weight_g = float(product.get("weight") or 0.0) * GRAMS_PER_OZ
+        if weight_g > 0:
+            tol_g = max(EW_MIN_TOLERANCE_G, weight_g * EW_TOLERANCE_FRACTION)
+            asyncio.create_task(send_ble_command_async(f"EW_ADD,{upc},{weight_g:.0f},{tol_g:.0f}"))
+
     except Exception as e:
         print(f"Failed to add UPC {upc} to cart: {e}", file=sys.stderr)
 
 async def handle_produce_weight_notification(sender, data):
     try:
         weight_str = data.decode().strip()
+
+        # Streaming mode (PS_START): "L:<oz>" while the scale moves, "S:<oz>" once settled
+        if weight_str[:2] in ("L:", "S:"):
+            live_json = {
+                "produce-weight-live": float(weight_str[2:]),
+                "settled": weight_str[0] == "S"
+            }
+            print("PRODUCE_WEIGHT_JSON:" + json.dumps(live_json))
+            sys.stdout.flush()
+            return
+
         print(f"Received produce weight via BLE: {weight_str} oz", file=sys.stderr)
 
         weight = float(weight_str)
@@ -384,6 +408,27 @@ async def handle_produce_weight_notification(sender, data):
     except Exception as e:
         print(f"Error handling produce weight: {e}", file=sys.stderr)
 
+def item_verification_payload(passed, measured_oz, expected_oz, tags=(), rfid_upcs=(),
+                              verdict=None, confidence=None, reasons=0, scanned=None, placed=None):
+    # One ITEM_VERIFICATION_JSON shape for both the Pi check and the on-device [IV] VERDICT
+    verdict = verdict or ("OK" if passed else "FAIL")
+    return {
+        "item-verification-received": {
+            "status": "failed" if verdict == "FAIL" else "success",
+            "verdict": verdict,
+            "confidence": confidence,
+            "reasons": reasons,
+            "measured_weight": measured_oz,
+            "expected_weight": expected_oz,
+            "weight_difference": abs(measured_oz - expected_oz),
+            "tags_scanned": list(tags),
+            "rfid_upcs": list(rfid_upcs),
+            "items_scanned": scanned,
+            "items_placed": placed,
+            "verification_passed": passed
+        }
+    }
+
 async def handle_item_verification_notification(sender, data):
     MASTER_URL = get_master_url()
     # item rfid will only send unique tags
@@ -455,17 +500,9 @@ async def handle_item_verification_notification(sender, data):
         else:
             print("No tags scanned; skipping RFID/cart verification.", file=sys.stderr)
 
-        verification_json = {
-            "item-verification-received": {
-                "status": "success" if verification_passed else "failed",
-                "measured_weight": weight,
-                "expected_weight": total_cart_weight,
-                "weight_difference": diff,
-                "tags_scanned": tags,
-                "rfid_upcs": list(scanned_upcs) if num_tags > 0 else [],
-                "verification_passed": verification_passed
-            }
-        }
+        verification_json = item_verification_payload(
+            verification_passed, weight, total_cart_weight, tags,
+            scanned_upcs if num_tags > 0 else [])
 
         print("ITEM_VERIFICATION_JSON:" + json.dumps(verification_json), flush=True)
 
@@ -633,6 +670,16 @@ async def handle_misc_notification(sender, data):
 
                 print("IMU_ACTIVITY_JSON:" + json.dumps(imu_status_json), flush=True)
 
+            elif component == "IV" and message.startswith("VERDICT"):
+                # [IV] VERDICT <OK|SUSPECT|FAIL> <confidence> <reasons> <measured_g> <expected_g> <scanned> <placed>
+                _, level, confidence, reasons, measured_g, expected_g, scanned, placed = message.split()
+                # The device verdict carries counts, not tag lists: those stay empty
+                verification_json = item_verification_payload(
+                    level == "OK", float(measured_g) / GRAMS_PER_OZ, float(expected_g) / GRAMS_PER_OZ,
+                    verdict=level, confidence=int(confidence), reasons=int(reasons, 16),
+                    scanned=int(scanned), placed=int(placed))
+                print("ITEM_VERIFICATION_JSON:" + json.dumps(verification_json), flush=True)
+
             else:
                 other_status_json = {
                     "component": component,
@@ -656,6 +703,53 @@ async def send_ble_command_async(command_char):
     except Exception as e:
         return {"status": "error", "message": str(e)}
 
+async def expect_produce(upc, weight_oz):
+    # Produce confirmed into the cart: expect this weighing on the cart scale
+    weight_g = weight_oz * GRAMS_PER_OZ
+    if weight_g <= 0:
+        return
+    tol_g = max(EW_MIN_TOLERANCE_G, weight_g * EW_TOLERANCE_FRACTION)
+    expected_produce.setdefault(upc, []).append(weight_g)
+    await send_ble_command_async(f"EW_ADD,{upc},{weight_g:.0f},{tol_g:.0f}")
+
+async def unexpect_item(upc, qty):
+    # Item removed from the cart: its RFID tags are no longer covered by a scan,
+    # and a produce row takes back all of its weighings
+    if int(qty) > 0:
+        await send_ble_command_async(f"REG_UNSCAN,{upc},{int(qty)}")
+    if upc in expected_produce:
+        for weight_g in expected_produce.pop(upc):
+            await send_ble_command_async(f"EW_REMOVE,{upc},{weight_g:.0f}")
+        return
+    for _ in range(max(0, int(qty))):
+        await send_ble_command_async(f"EW_REMOVE,{upc}")
+
+async def push_rfid_registry():
+    # Send the RFID -> UPC table to the ESP32 so it can flag unscanned items locally
+    # REG_ADD,<epc>,<upc>,<epc>,<upc>... batched to stay within one BLE write
+    MASTER_URL = get_master_url()
+    try:
+        response = requests.get(f"{MASTER_URL}/rfid_registry", timeout=10)
+        response.raise_for_status()
+        products = response.json().get("products", [])
+    except requests.RequestException as e:
+        print(f"Warning: Could not fetch RFID registry: {e}", file=sys.stderr)
+        return
+
+    await send_ble_command_async("REG_CLEAR")
+
+    batch = "REG_ADD"
+    for p in products:
+        pair = f",{p['rfid_id']},{p['upc']}"
+        if len(batch) + len(pair) > REG_BATCH_MAX_LEN:
+            await send_ble_command_async(batch)
+            batch = "REG_ADD"
+        batch += pair
+    if batch != "REG_ADD":
+        await send_ble_command_async(batch)
+
+    print(f"RFID registry pushed ({len(products)} tags)", file=sys.stderr)
+
 async def wait_for_device(name, timeout=30):
     for _ in range(timeout):
         devices = await BleakScanner.discover()
@@ -1398,6 +1492,29 @@ if __name__ == "__main__":
                         send_ble_command_async(cmd)
                     )
                     print(f"Measured Produce Weight Cmd Sent", file=sys.stderr)
+                elif cmd.startswith("PS_START") or cmd == "PS_STOP":
+                    asyncio.get_event_loop().run_until_complete(
+                        send_ble_command_async(cmd)
+                    )
+                    print(f"{cmd} Cmd Sent", file=sys.stderr)
+                elif cmd.startswith("PRODUCE_ADDED,"):
+                    # PRODUCE_ADDED,<upc>,<oz> once the weighing is in the cart
+                    try:
+                        _, upc, weight_oz = cmd.split(",")
+                        asyncio.get_event_loop().run_until_complete(
+                            expect_produce(upc, float(weight_oz))
+                        )
+                    except ValueError:
+                        print(f"Invalid command: {cmd}", file=sys.stderr)
+                elif cmd.startswith("ITEM_REMOVED,"):
+                    # ITEM_REMOVED,<upc>,<qty> after update_cart took it out
+                    try:
+                        _, upc, qty = cmd.split(",")
+                        asyncio.get_event_loop().run_until_complete(
+                            unexpect_item(upc, float(qty))
+                        )
+                    except ValueError:
+                        print(f"Invalid command: {cmd}", file=sys.stderr)
                 elif cmd == "PAY_START":
                     asyncio.get_event_loop().run_until_complete(
                         send_ble_command_async(cmd)
@@ -1418,6 +1535,14 @@ if __name__ == "__main__":
                         send_ble_command_async(cmd)
                     )
                     print(f"CT_START Cmd Sent", file=sys.stderr)
+                    # Empty expected basket, enables the on-cart weight check
+                    expected_produce.clear()
+                    asyncio.get_event_loop().run_until_complete(
+                        send_ble_command_async("EW_CLEAR")
+                    )
+                    asyncio.get_event_loop().run_until_complete(
+                        push_rfid_registry()
+                    )
                 elif cmd == "CT_CLEAR":
                     asyncio.get_event_loop().run_until_complete(
                         send_ble_command_async(cmd)
@@ -24,6 +24,12 @@ function sendProduceWeightReceived(weight) {
   }
 }
 
+function sendProduceWeightLive(live) {
+  if (mainWindow && !mainWindow.isDestroyed()) {
+    mainWindow.webContents.send("produce-weight-live", live);
+  }
+}
+
 function sendItemVerificationReceived(verification) {
   if (mainWindow && !mainWindow.isDestroyed()) {
     mainWindow.webContents.send("item-verification-received", verification);
@@ -122,6 +128,8 @@ app.whenReady().then(() => {
         if (parsed["produce-weight-received"]) {
           console.log("Received produce weight:", parsed["produce-weight-received"]);
           sendProduceWeightReceived(parsed["produce-weight-received"]);
+        } else if (parsed["produce-weight-live"] !== undefined) {
+          sendProduceWeightLive(parsed);
         }
       } catch (err) {
         console.error("Failed to parse PRODUCE_WEIGHT_JSON:", err, str);
@@ -1,6 +1,7 @@
 const { contextBridge, ipcRenderer } = require("electron");
 
 let paymentListener = null;
+let produceWeightLiveListener = null;
 
 contextBridge.exposeInMainWorld("electronAPI", {
   // Run a Python function and get JSON result
@@ -42,6 +43,19 @@ contextBridge.exposeInMainWorld("electronAPI", {
       produceWeightListener = null;
     }
   },
+
+  // Subscribe to live produce weight while streaming ({ "produce-weight-live": oz, settled })
+  onProduceWeightLive: (callback) => {
+    produceWeightLiveListener = (event, live) => callback(live);
+    ipcRenderer.on("produce-weight-live", produceWeightLiveListener);
+  },
+
+  removeProduceWeightLive: () => {
+    if (produceWeightLiveListener) {
+      ipcRenderer.removeListener("produce-weight-live", produceWeightLiveListener);
+      produceWeightLiveListener = null;
+    }
+  },
   
   // Subscribe to item verification events
   onItemVerificationReceived: (callback) => {
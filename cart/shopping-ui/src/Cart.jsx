@@ -34,6 +34,7 @@ const Cart = ({
   const [showWeighingPrompt, setShowWeighingPrompt] = useState(false);
   const [currentWeight, setCurrentWeight] = useState(0);
   const [calculatedPrice, setCalculatedPrice] = useState(0);
+  const [liveWeight, setLiveWeight] = useState(null);
   const [showPaymentModal, setShowPaymentModal] = useState(false);
   const [paymentMessage, setPaymentMessage] = useState("");
   const [showUnresolvedModal, setShowUnresolvedModal] = useState(false);
@@ -205,6 +206,11 @@ const Cart = ({
 
           const product = result.product;
 
+          // Expect this weighing on the cart scale now that it is in the cart
+          await window.electronAPI.sendStdinCommand(
+            `PRODUCE_ADDED,${product.upc},${weight}`
+          );
+
           setItems((prevItems) => {
             const existing = prevItems.find((i) => i.upc === product.upc);
             if (existing) {
@@ -234,6 +240,25 @@ const Cart = ({
     };
   }, []);
 
+  // Live scale reading while the weighing modal is open
+  useEffect(() => {
+    if (!showWeighingPrompt) return;
+
+    window.electronAPI.onProduceWeightLive((live) => {
+      setLiveWeight({
+        oz: Number(live["produce-weight-live"]),
+        settled: Boolean(live.settled),
+      });
+    });
+    window.electronAPI.sendStdinCommand("PS_START");
+
+    return () => {
+      window.electronAPI.sendStdinCommand("PS_STOP");
+      window.electronAPI.removeProduceWeightLive();
+      setLiveWeight(null);
+    };
+  }, [showWeighingPrompt]);
+
   useEffect(() => {
     if (!showWeightStep) return;
 
@@ -931,6 +956,12 @@ const Cart = ({
                   Place item on scale. Please stay still for the most accurate
                   reading.
                 </h3>
+                {liveWeight && (
+                  <p>
+                    On scale: {liveWeight.oz.toFixed(2)} oz
+                    {liveWeight.settled ? " (steady)" : ""}
+                  </p>
+                )}
                 <button
                   style={{ marginTop: "10px" }}
                   onClick={() => {
@@ -968,7 +999,10 @@ const Cart = ({
                     <p>Price: ${calculatedPrice}</p>
                   </>
                 ) : (
-                  <p>Waiting for weight...</p>
+                  <p>
+                    Waiting for weight...
+                    {liveWeight && ` ${liveWeight.oz.toFixed(2)} oz`}
+                  </p>
                 )}
                 <button
                   style={{ marginTop: "10px" }}
@@ -1085,6 +1119,10 @@ const Cart = ({
 
                     console.log("Python update_cart result:", result);
 
+                    await window.electronAPI.sendStdinCommand(
+                      `ITEM_REMOVED,${itemToRemove.upc},${removeQty}`
+                    );
+
                     if (removeQty >= itemToRemove.qty) {
                       setItems(items.filter((i) => i.upc !== itemToRemove.upc));
                     } else {
@@ -157,8 +157,8 @@ function App() {
           measuredWeight: verification.measured_weight,
           expectedWeight: verification.expected_weight,
           weightDifference: verification.weight_difference,
-          scannedTags: verification.tags_scanned,
-          rfidUpcs: verification.rfid_upcs,
+          scannedTags: verification.tags_scanned || [],
+          rfidUpcs: verification.rfid_upcs || [],
         });
       }
     );
@@ -207,9 +207,14 @@ LINE_RE = re.compile(
     r'Antenn\w*:\s*(?P<antenna>\d+)\s*\|\s*'
     r'Time:\s*(?P<time>\d+)\s*ms\s*$'
 )
+#companion csv for the dead-reckoned track the cart logs between RFID bursts
+def odomPath(csv_path):
+    return os.path.splitext(csv_path)[0] + "_odom.csv"
+
 #helper function
 def txt_to_csv(in_path, out_path):
     rows = []
+    odom_rows = []
     buffer = ""
     brace_count = 0
 
@@ -246,6 +251,19 @@ def txt_to_csv(in_path, out_path):
                         except (ValueError, TypeError):
                             continue
 
+                    for item in data.get("odom", []):
+                        try:
+                            odom_rows.append([
+                                int(item["time"]),
+                                float(item["x"]),
+                                float(item["y"]),
+                                float(item.get("heading", 0)),
+                                int(item.get("steps", 0)),
+                                int(item.get("fix", 0))
+                            ])
+                        except (KeyError, ValueError, TypeError):
+                            continue
+
                 except json.JSONDecodeError:
                     # Could not parse, skip and print warning
                     print(f"⚠ Skipping invalid JSON fragment:\n{buffer}\n")
@@ -260,6 +278,14 @@ def txt_to_csv(in_path, out_path):
 
     print(f"Wrote {len(rows)} rows to {out_path}")
 
+    if odom_rows:
+        odom_path = odomPath(out_path)
+        with open(odom_path, "w", newline="", encoding="utf-8") as f:
+            writer = csv.writer(f)
+            writer.writerow(["Time_ms", "X_m", "Y_m", "Heading", "Steps", "Fix"])
+            writer.writerows(odom_rows)
+        print(f"Wrote {len(odom_rows)} odometry points to {odom_path}")
+
 # Path finding algorithm implemented using a Kalman filter which predicts the path given very noisy data  
 class Kalman:
     def __init__ (self, dt=1.0):
@@ -319,6 +345,7 @@ def findTag(RFID_val):
 
 # Base directory for generated images
 GENERATED_IMAGES_DIR = 'generated_images'
+ODOM_MIN_SEGMENT_M = 1.0 #shorter dead-reckoned stretches reuse the previous fit
 LOG_BASE_DIR = 'cart_logs'
 
 def get_image_save_path(cart_id, image_type, timestamp=None, session_number=None):
@@ -451,8 +478,46 @@ class Path:
                 burstX = []
                 burstY = []
                 burstTime = []
+        self.fuseOdometry(file)
         for p in self.path_arr:
             print("X: ", p[0], " | Y: ", p[1], " | Time: ", p[2])
+
+    # Fill the gaps between RFID fixes with the cart's dead-reckoned track (if the session has one).
+    # Each stretch is rotated and scaled so it leaves one fix and lands on the next, which absorbs
+    # both the compass-to-map rotation and the stride length error.
+    def fuseOdometry(self, file):
+        odom_file = odomPath(file)
+        if len(self.path_arr) == 0 or not os.path.exists(odom_file):
+            return
+        odom = pd.read_csv(odom_file).sort_values("Time_ms")
+        if len(odom) < 2:
+            return
+
+        ot = odom["Time_ms"].to_numpy(dtype=float)
+        oz = odom["X_m"].to_numpy(dtype=float) - 1j * odom["Y_m"].to_numpy(dtype=float) #map y grows down, odometry y is north
+        fixes = np.array(self.path_arr)
+        ft = fixes[:, 2]
+        fz = fixes[:, 0] + 1j * fixes[:, 1]
+        oz_fix = np.interp(ft, ot, oz.real) + 1j * np.interp(ft, ot, oz.imag)
+
+        dense = []
+        r = None #odometry metres -> map pixels, as a rotation + scale
+        for i in range(len(fixes)):
+            dense.append(fixes[i])
+            if i + 1 < len(fixes):
+                d_odom = oz_fix[i + 1] - oz_fix[i]
+                d_map = fz[i + 1] - fz[i]
+                if abs(d_odom) > ODOM_MIN_SEGMENT_M and abs(d_map) > 0:
+                    r = d_map / d_odom
+                seg = (ot > ft[i]) & (ot < ft[i + 1])
+            else:
+                seg = ot > ft[i] #after the last fix: carry on with the last fit
+            if r is None:
+                continue
+            for t, z in zip(ot[seg], oz[seg]):
+                p = fz[i] + r * (z - oz_fix[i])
+                dense.append(np.array([p.real, p.imag, t]))
+        self.path_arr = dense
             
     def plotPathPoints(self, img, timestamp=None, save=True, show=False, session_number=None):
         """Plot path points with arrows and optionally save to organized folder."""
@@ -688,7 +753,8 @@ def process_daily_logs(store_schematic_path, store_width, tag_spacing, rfid_map_
     for cart_id in cart_folders:
         cart_folder_path = os.path.join(date_log_folder, cart_id)
         # Look for .csv files (converted from .txt) for processing
-        csv_files = sorted(glob.glob(os.path.join(cart_folder_path, '*.csv')))
+        csv_files = sorted(f for f in glob.glob(os.path.join(cart_folder_path, '*.csv'))
+                           if not f.endswith('_odom.csv'))
         
         if not csv_files:
             print(f"  {cart_id}: No CSV files found")
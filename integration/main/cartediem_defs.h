@@ -7,6 +7,16 @@
 #define ENABLE_ITEM_VERIFICATION 1
 #define ENABLE_CART_TRACKING 1
 #define ENABLE_PROXIMITY_SENSOR 1
+#define ENABLE_LOAD_CELL_SPI 1                 // Default backend: each HX711 has its own sampler, the cart cell read over SPI
+#define ENABLE_LOAD_CELL_GROUP 0               // Alternative: clock both HX711s together over GPIO (needs ENABLE_LOAD_CELL_SPI 0)
+#define ENABLE_IMU_FIFO 1                      // Batch IMU samples in the chip FIFO (needs IMU_INT_PIN), else poll
+#define ENABLE_IMU_WAKE_ON_MOTION 1            // Park the IMU when idle, resume on its motion interrupt (needs IMU_INT_PIN)
+#define ENABLE_IMU_CLASSIFIER 1                // Label FIFO windows parked/pushed/bumped/lifted/tilted (needs ENABLE_IMU_FIFO, esp-dsp)
+#define ENABLE_IMU_ALERTS 1                    // Tip/lift/impact alerts over BLE from the FIFO stream (needs ENABLE_IMU_FIFO)
+
+#if ENABLE_LOAD_CELL_SPI && ENABLE_LOAD_CELL_GROUP
+#error "ENABLE_LOAD_CELL_GROUP bit-bangs every HX711 over GPIO; set ENABLE_LOAD_CELL_SPI to 0 to use it"
+#endif
 
 // 2. ADJUSTABLE PARAMETERS
 #define BUTTON_COOLDOWN_MS 1000             // Button press cooldown time
@@ -15,15 +25,87 @@
 
 // 2.1. RTOS PERIODIC TASK PARAMETERS
 #define IV_TASK_PRIORITY 9
-#define ITEM_VERIFICATION_INTERVAL_MS 10000  // Interval for periodic RFID scan for Item Verification
+#define IV_FALLBACK_INTERVAL_MS 60000        // Slow periodic RFID scan when no trigger arrives
+#define IV_TRIGGER_DEBOUNCE_MS 1500          // Triggers arriving within this window share one RFID scan
+#define IV_MIN_SCAN_INTERVAL_MS 3000         // Minimum gap between two RFID scans
+#define IV_VERDICT_INTERVAL_MS 1000          // Interval to re-evaluate the Item Verification verdict
+#define IV_CLEAR_PIN ""                      // Staff code for IV_CLEAR,<pin> (unfreezes checkout): required, set per store
+#define IV_CLEAR_MAX_TRIES 3                 // Wrong codes before IV_CLEAR locks out
+#define IV_CLEAR_LOCKOUT_MS 60000
+#define TAG_MIN_READS 3                      // Reads per scan expected from a tag inside the basket
+#define TAG_RSSI_IN_BASKET 70                // Mean RSSI typical for tags inside the basket
+#define TAG_RSSI_AMBIENT 55                  // Mean RSSI below this is typical for shelf tags
+#define TAG_MAX_RSSI_SPREAD 8                // Max RSSI spread within a scan for a stationary tag
+#define TAG_PERSIST_SCANS 3                  // Consecutive scans before a tag counts as persistent
+#define IV_FUSION_WINDOW_MS 10000            // Max time between a barcode and its weight change before it is flagged
+#define IV_FUSION_MIN_ITEM_G 20.0f           // Settled weight changes (in g) smaller than this are not items
+
+#define LOAD_CELL_TASK_PRIORITY 10            // HX711 sampler, woken by each conversion
+#define WEIGHT_FILTER_TASK_PRIORITY 9        // Filter chain, woken by each sample
+#define WF_OUTLIER_G 200.0f                  // Samples this far (in g) from the median are spikes...
+#define WF_OUTLIER_PERSIST 3                 // ...unless this many arrive in a row
+#define WF_IIR_ALPHA 0.3f                    // IIR smoothing after the median (1 = none)
+#define WF_SETTLE_WINDOW_MS 800              // Time the weight must stay in the band to count as settled
+#define WF_SETTLE_BAND_G 5.0f                // Peak-to-peak variation (in g) allowed while settled
+#define WF_MIN_CHANGE_G 20.0f                // Settled change (in g) reported as an item added/removed
+#define WF_STILL_WINDOW_MS 1000              // Cart must be still this long before weights are trusted again
+#define PRODUCE_STREAM_TASK_PRIORITY 6
+#define PRODUCE_STREAM_PERIOD_MS 100         // Default live produce weight rate (PS_START)
+#define PRODUCE_STREAM_THRESHOLD_G 2.0f      // Default change (in g) pushed between settles
+#define PRODUCE_STREAM_TIMEOUT_MS 60000      // Default time before the stream stops itself
+#define CUSUM_DRIFT_G 8.0f                   // Cart step detector slack: smaller deviations never accumulate
+#define CUSUM_THRESHOLD_G 40.0f              // Cumulative deviation (in g) that raises a step alarm
+#define CUSUM_CONFIRM_SAMPLES 5              // Samples averaged after an alarm to measure the step
+#define CUSUM_MOTION_HOLDOFF_MS 500          // Detector stays frozen this long after the cart stops
+#define LOAD_CELL_HEALTH_TASK_PRIORITY 4
+#define LC_HEALTH_INTERVAL_MS 1000           // Load cell health / auto-zero check period
+#define LC_STALL_MS 1000                     // No conversion for this long means the HX711 is gone
+#define LC_STUCK_SAMPLES 20                  // Identical raw codes in a row reported as a stuck line
+#define LC_AZ_BAND_G 3.0f                    // Auto-zero only tracks a settled weight within +/- this of zero...
+#define LC_AZ_GAIN 0.25f                     // ...removing this fraction of it per check...
+#define LC_AZ_MAX_STEP_G 0.2f                // ...at most this much per check...
+#define LC_AZ_MAX_TOTAL_G 30.0f              // ...and this much in total before reporting DRIFT
 
 #define IMU_TASK_PRIORITY 7
-#define IMU_MONITOR_INTERVAL_MS 15000        // 15 seconds
+#define IMU_EVENT_INTERVAL_MS 15000          // Event layer: idle/resume bookkeeping period
 #define IMU_IDLE_TIME_MINUTES 5             // 1 minutes
 #define IMU_MOVING_THRESHOLD 0.1f          // Threshold (in g) to consider IMU as moving
+#define IMU_MOTION_POLL_MS 100               // Fast motion state for the weight pipeline
+#define IMU_MOTION_ACCEL_G 0.05f             // |accel| deviation from its learned resting value (in g) counted as motion
+#define IMU_MOTION_GYRO_DPS 8.0f             // Rotation rate (in dps) counted as motion
+#define IMU_BENCH_MAX_ITERATIONS 1000        // IMU_BENCH cap (it blocks the BLE host task while it runs)
+#define IMU_FIFO_TASK_PRIORITY 8
+#define IMU_FIFO_ODR_HZ 100                  // Sample layer: accel + gyro rate while batching in the chip FIFO
+#define IMU_FIFO_BATCH_MS 100                // FIFO batch period (one wakeup and one bulk read each, bounds alert latency)
+#define IMU_WOM_THRESHOLD_MG 40              // Accel change (in mg) that wakes a parked IMU
+#define IMU_PARKED_ACCEL_HZ 20               // Low-power accel cycle rate while parked
+#define IMU_AHRS_TASK_PRIORITY 6
+#define IMU_AHRS_BETA 0.1f                   // Madgwick gain (higher = faster accel/mag correction, noisier)
+#define IMU_AHRS_POLL_HZ 50                  // Orientation update rate when the FIFO isn't running
+#define IMU_MAG_CAL_TASK_PRIORITY 4
+#define IMU_MAG_CAL_TIMEOUT_MS 60000         // IMU_MAGCAL gives up if the cart isn't turned within this
+#define IMU_MAG_CAL_SAMPLE_HZ 20             // Magnetometer sampling during calibration
+#define IMU_MAG_CAL_COVERAGE_DEG 300         // Heading span collected before the ellipse fit
+#define IMU_CLASS_WINDOW_MS 1280             // Feature layer: classifier window (nearest power of two in samples, 50% hop)
+#define IMU_CLASS_PUSH_VAR_G2 0.0004f        // |accel| variance (g^2) counted as rolling (~20 mg std)
+#define IMU_CLASS_PUSH_GYRO_DPS 5.0f         // or gyro RMS (dps)
+#define IMU_CLASS_BUMP_JERK_GPS 20.0f        // Isolated jerk spike (g/s) counted as a bump
+#define IMU_CLASS_LIFT_G 0.08f               // Sustained vertical accel (g) counted as a lift
+#define IMU_CLASS_TILT_DEG 25.0f             // Gravity this far off the level reference is a tilt
+#define IMU_ALERT_TASK_PRIORITY 11           // Above the sensors: alerts go out as soon as they're queued
+#define IMU_ALERT_TIP_DEG 35.0f              // Tilt from level counted as tipped over
+#define IMU_ALERT_TIP_MS 100                 // and held this long
+#define IMU_ALERT_LIFT_G 0.15f               // Upward accel (g, gravity removed) counted as a lift
+#define IMU_ALERT_LIFT_MS 80                 // averaged over this long
+#define IMU_ALERT_IMPACT_G 1.5f              // |accel| this far from its resting value in one sample is an impact
+#define IMU_ALERT_COOLDOWN_MS 2000           // Repeat alerts of one type are held back this long
 
 #define CT_TASK_PRIORITY 8
 #define CART_TRACKING_INTERVAL_MS 5000     // 5 seconds
+#define CT_ODOM_STRIDE_M 0.6f               // Cart travel per detected push/step (calibrate per store)
+#define CT_ODOM_STEP_G 0.04f                // Accel bump (in g) counted as a push
+#define CT_ODOM_MIN_STEP_MS 300             // Fastest plausible push cadence
+#define CT_ODOM_POINT_MS 500                // Dead-reckoned track point spacing while moving
 
 // 2.2. PAYMENT PARAMETERS
 #define AUTHORIZED_UID {0x1A, 0x83, 0x26, 0x03, 0xBC}
@@ -49,10 +131,29 @@
 #include "interfaces/ble_barcode_nimble.h"
 #include "interfaces/cart_tracking.h"
 #include "interfaces/imu.h"
+#include "interfaces/imu_fifo.h"
+#include "interfaces/imu_wake.h"
+#include "interfaces/imu_ahrs.h"
+#include "interfaces/imu_mag_cal.h"
+#include "interfaces/imu_level.h"
+#include "interfaces/imu_classifier.h"
+#include "interfaces/imu_alert.h"
+#include "interfaces/imu_rates.h"
+#include "interfaces/cart_odometry.h"
 #include "interfaces/item_rfid.h"
+#include "interfaces/iv_trigger.h"
+#include "interfaces/tag_classifier.h"
+#include "interfaces/tag_registry.h"
+#include "interfaces/iv_fusion.h"
 #include "interfaces/loadcells.h"
+#include "interfaces/loadcell_group.h"
+#include "interfaces/loadcell_health.h"
+#include "interfaces/weight_filter.h"
+#include "interfaces/weight_stream.h"
+#include "interfaces/weight_cusum.h"
 #include "interfaces/mfrc522.h"
 #include "interfaces/proximity_sensor.h"
+#include "interfaces/task_stop.h"
 
 #if USING_DEVKIT == 0   // === Custom PCB ===
 // === I2C: Proximity Sensor, IMU, ===
@@ -60,6 +161,7 @@
 #define SDA_PIN GPIO_NUM_8
 
 #define PROXIMITY_INT_PIN GPIO_NUM_6
+#define IMU_INT_PIN GPIO_NUM_7
 
 // === SPI: Payment ===
 #define MOSI_PIN GPIO_NUM_11
@@ -74,6 +176,7 @@
 #define TOP_LOAD_CLK_PIN GPIO_NUM_39
 #define BOTTOM_LOAD_DATA_PIN GPIO_NUM_40
 #define BOTTOM_LOAD_CLK_PIN GPIO_NUM_41
+#define CART_LOAD_SPI_HOST SPI3_HOST     // SPI2 is used by the payment reader
 
 
 // === UART: Barcode scanner, Item RFID, Customer RFID ===
@@ -100,6 +203,7 @@
 #define SDA_PIN GPIO_NUM_8
 
 #define PROXIMITY_INT_PIN GPIO_NUM_6
+#define IMU_INT_PIN GPIO_NUM_7
 
 // === SPI: Payment ===
 #define MOSI_PIN GPIO_NUM_11
@@ -114,6 +218,7 @@
 #define TOP_LOAD_CLK_PIN GPIO_NUM_39
 #define BOTTOM_LOAD_DATA_PIN GPIO_NUM_40
 #define BOTTOM_LOAD_CLK_PIN GPIO_NUM_41
+#define CART_LOAD_SPI_HOST SPI3_HOST     // SPI2 is used by the payment reader
 
 
 // === UART: Barcode scanner, Item RFID, Customer RFID ===
@@ -0,0 +1,211 @@
+#include "cart_odometry.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+static const char *TAG = "CART_ODOM";
+
+#define CART_ODOM_BASE_TAU_S   1.0f    // Gravity/tilt tracking time constant
+#define CART_ODOM_BUMP_ALPHA   0.25f   // Smoothing on the bump signal (about 4 samples)
+#define CART_ODOM_DEG_TO_RAD   0.017453292f
+
+static portMUX_TYPE odom_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Wall clock in ms, same as the cart tracking burst timestamps
+ */
+static uint32_t cart_odometry_wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/**
+ * @brief Queue the current pose for the next session log write
+ */
+static void cart_odometry_emit(CartOdometry *odom, bool fix) {
+    cart_odom_point_t p = {
+        .t_ms = cart_odometry_wall_ms(),
+        .x_m = odom->x_m,
+        .y_m = odom->y_m,
+        .heading_deg = odom->heading_deg,
+        .steps = odom->steps,
+        .fix = fix,
+    };
+    portENTER_CRITICAL(&odom_spinlock);
+    if (odom->count < CART_ODOM_MAX_POINTS) {
+        odom->points[odom->count++] = p;
+    } else {
+        odom->dropped++;
+    }
+    portEXIT_CRITICAL(&odom_spinlock);
+}
+
+/**
+ * @brief FIFO subscriber: count pushes in the block and advance the pose along the heading
+ */
+static void cart_odometry_on_block(void *ctx, const imu_fifo_block_t *blk) {
+    CartOdometry *odom = (CartOdometry *)ctx;
+    if (!odom->running || blk->count == 0) {
+        return;
+    }
+
+    imu_ahrs_state_t att;
+    odom->heading_deg = imu_ahrs_get(odom->ahrs, &att) ? att.heading_deg : odom->dev->direction_deg;
+
+    float inv_lsb = 1.0f / blk->accel_lsb_per_g;
+    float base_alpha = 1.0f / (CART_ODOM_BASE_TAU_S * blk->odr_hz);
+    int64_t sample_us = (int64_t)(1000000.0f / blk->odr_hz);
+    int64_t t_us = blk->t_us - (int64_t)(blk->count - 1) * sample_us;
+    int64_t min_step_us = (int64_t)odom->cfg.min_step_ms * 1000;
+    uint32_t pushes = 0;
+
+    for (uint16_t i = 0; i < blk->count; i++, t_us += sample_us) {
+        const int16_t *a = blk->samples[i].accel;
+        float mag = sqrtf((float)a[0] * a[0] + (float)a[1] * a[1] + (float)a[2] * a[2]) * inv_lsb;
+        if (odom->base_g == 0.0f) {
+            odom->base_g = mag;
+        }
+        odom->base_g += (mag - odom->base_g) * base_alpha;
+        odom->bump_g += ((mag - odom->base_g) - odom->bump_g) * CART_ODOM_BUMP_ALPHA;
+
+        if (odom->bump_g < 0.0f) {
+            odom->armed = true;
+        } else if (odom->armed && odom->bump_g > odom->cfg.step_g &&
+                   t_us - odom->last_step_us >= min_step_us) {
+            odom->armed = false;
+            odom->last_step_us = t_us;
+            pushes++;
+        }
+    }
+
+    if (pushes > 0) {
+        // One heading per block: the cart can't turn much in a batch period
+        float h = odom->heading_deg * CART_ODOM_DEG_TO_RAD;
+        float d = pushes * odom->cfg.stride_m;
+        odom->x_m += d * sinf(h);
+        odom->y_m += d * cosf(h);
+        odom->steps += pushes;
+        odom->since_fix_m += d;
+        odom->moved = true;
+    }
+
+    if (odom->moved && blk->t_us - odom->last_point_us >= (int64_t)odom->cfg.point_ms * 1000) {
+        odom->moved = false;
+        odom->last_point_us = blk->t_us;
+        cart_odometry_emit(odom, false);
+    }
+}
+
+/**
+ * @brief Create the tracker and subscribe it to the FIFO (before the FIFO starts)
+ */
+CartOdometry *cart_odometry_create(ICM20948_t *dev, ImuFifo *fifo, ImuAhrs *ahrs, const cart_odom_config_t *config) {
+    if (dev == NULL || fifo == NULL || config == NULL || config->stride_m <= 0.0f) {
+        return NULL;
+    }
+    CartOdometry *odom = (CartOdometry *)calloc(1, sizeof(CartOdometry));
+    if (odom == NULL) {
+        return NULL;
+    }
+    odom->dev = dev;
+    odom->ahrs = ahrs;
+    odom->cfg = *config;
+    if (imu_fifo_subscribe(fifo, cart_odometry_on_block, odom) != ESP_OK) {
+        ESP_LOGE(TAG, "Could not subscribe to the IMU FIFO");
+        free(odom);
+        return NULL;
+    }
+    return odom;
+}
+
+/**
+ * @brief Destroy the tracker
+ */
+void cart_odometry_destroy(CartOdometry *odom) {
+    // The FIFO has no unsubscribe: only safe once the FIFO is destroyed too
+    free(odom);
+}
+
+/**
+ * @brief Start a track at (0, 0), dropping anything not yet written
+ */
+void cart_odometry_start(CartOdometry *odom) {
+    if (odom == NULL) return;
+    odom->running = false;
+    portENTER_CRITICAL(&odom_spinlock);
+    odom->count = 0;
+    odom->dropped = 0;
+    portEXIT_CRITICAL(&odom_spinlock);
+
+    odom->x_m = 0.0f;
+    odom->y_m = 0.0f;
+    odom->steps = 0;
+    odom->since_fix_m = 0.0f;
+    odom->moved = true;        // first block drops the origin point
+    odom->last_point_us = 0;
+    odom->running = true;
+    ESP_LOGI(TAG, "Track started (%.2f m per push)", odom->cfg.stride_m);
+}
+
+/**
+ * @brief Stop tracking (the pending track can still be written)
+ */
+void cart_odometry_stop(CartOdometry *odom) {
+    if (odom == NULL || !odom->running) return;
+    odom->running = false;
+    ESP_LOGI(TAG, "Track stopped (%lu pushes, %lu points dropped)", odom->steps, odom->dropped);
+}
+
+/**
+ * @brief Mark the current pose as taken at an RFID burst
+ */
+void cart_odometry_fix(CartOdometry *odom) {
+    if (odom == NULL || !odom->running) return;
+    ESP_LOGD(TAG, "Fix after %.1f m dead reckoned", odom->since_fix_m);
+    odom->since_fix_m = 0.0f;
+    cart_odometry_emit(odom, true);
+}
+
+/**
+ * @brief Append the pending track to a session log as one {"odom": [...]} record
+ */
+esp_err_t cart_odometry_write(CartOdometry *odom, const char *path) {
+    if (odom == NULL || path == NULL) return ESP_ERR_INVALID_ARG;
+
+    cart_odom_point_t *pts = (cart_odom_point_t *)malloc(sizeof(odom->points));
+    if (pts == NULL) return ESP_ERR_NO_MEM;
+
+    portENTER_CRITICAL(&odom_spinlock);
+    uint16_t n = odom->count;
+    memcpy(pts, odom->points, n * sizeof(cart_odom_point_t));
+    odom->count = 0;
+    portEXIT_CRITICAL(&odom_spinlock);
+
+    if (n == 0) {
+        free(pts);
+        return ESP_OK;
+    }
+
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        ESP_LOGE(TAG, "FAILED to open session file");
+        free(pts);
+        return ESP_FAIL;
+    }
+    fprintf(f, "{ \"odom\": [\n");
+    for (int i = 0; i < n; i++) {
+        fprintf(f,
+            "  {\"time\":%lu, \"x\":%.2f, \"y\":%.2f, \"heading\":%.1f, \"steps\":%lu, \"fix\":%d}%s\n",
+            (unsigned long)pts[i].t_ms, pts[i].x_m, pts[i].y_m, pts[i].heading_deg,
+            pts[i].steps, pts[i].fix, (i == n - 1) ? "" : ",");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+    free(pts);
+    return ESP_OK;
+}
@@ -0,0 +1,110 @@
+#ifndef CART_ODOMETRY_H
+#define CART_ODOMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "imu.h"
+#include "imu_fifo.h"
+#include "imu_ahrs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CART_ODOM_MAX_POINTS 64   // Track points held between session log writes
+
+/**
+ * @brief One dead-reckoned pose
+ */
+typedef struct {
+    uint32_t t_ms;             /**< Wall clock ms, same clock (and wrap) as the RFID burst times */
+    float x_m;                 /**< East of the session start */
+    float y_m;                 /**< North of the session start */
+    float heading_deg;
+    uint32_t steps;            /**< Pushes counted since the session start */
+    bool fix;                  /**< Taken right after an RFID burst */
+} cart_odom_point_t;
+
+/**
+ * @brief Push detector and track tuning
+ */
+typedef struct {
+    float stride_m;            /**< Distance the cart rolls per detected push/step */
+    float step_g;              /**< Accel bump (in g, gravity removed) counted as a push */
+    uint32_t min_step_ms;      /**< Fastest plausible cadence */
+    uint32_t point_ms;         /**< Track point spacing while moving */
+} cart_odom_config_t;
+
+/**
+ * @brief Step/push dead reckoning between RFID fixes
+ *
+ * Pushes are peaks in the FIFO accel magnitude; each one advances the pose by
+ * stride_m along the AHRS heading. The track is written into the cart tracking
+ * session log ahead of each RFID burst so the Pi can pin it to the tag fixes.
+ */
+typedef struct CartOdometry {
+    ICM20948_t *dev;
+    ImuAhrs *ahrs;             // may be NULL (heading then comes from dev->direction_deg)
+    cart_odom_config_t cfg;
+
+    // Push detector (FIFO task only)
+    float base_g;              // slow |accel| average (gravity + tilt)
+    float bump_g;              // smoothed |accel| - base_g
+    bool armed;                // bump went negative since the last push
+    int64_t last_step_us;
+
+    // Pose (FIFO task only)
+    float x_m;
+    float y_m;
+    float heading_deg;
+    uint32_t steps;
+    float since_fix_m;
+    int64_t last_point_us;
+    bool moved;
+
+    // Track, guarded by a spinlock between the FIFO and cart tracking tasks
+    cart_odom_point_t points[CART_ODOM_MAX_POINTS];
+    uint16_t count;
+    uint32_t dropped;
+
+    volatile bool running;
+} CartOdometry;
+
+/**
+ * @brief Create the tracker and subscribe it to the FIFO (before the FIFO starts)
+ */
+CartOdometry *cart_odometry_create(ICM20948_t *dev, ImuFifo *fifo, ImuAhrs *ahrs, const cart_odom_config_t *config);
+
+/**
+ * @brief Destroy the tracker
+ */
+void cart_odometry_destroy(CartOdometry *odom);
+
+/**
+ * @brief Start a track at (0, 0), dropping anything not yet written
+ */
+void cart_odometry_start(CartOdometry *odom);
+
+/**
+ * @brief Stop tracking (the pending track can still be written)
+ */
+void cart_odometry_stop(CartOdometry *odom);
+
+/**
+ * @brief Mark the current pose as taken at an RFID burst
+ */
+void cart_odometry_fix(CartOdometry *odom);
+
+/**
+ * @brief Append the pending track to a session log as one {"odom": [...]} record
+ *
+ * @return ESP_OK (also when there was nothing to write) or ESP_FAIL if the file can't be opened
+ */
+esp_err_t cart_odometry_write(CartOdometry *odom, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CART_ODOMETRY_H
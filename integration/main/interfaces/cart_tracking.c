@@ -106,8 +106,8 @@ void printBurst(void) {
 }
 
 void startSession(void){
-    remove("/spiffs/session.log");  // ensure old file is gone
-    FILE *f = fopen("/spiffs/session.log", "w");
+    remove(CT_SESSION_LOG);  // ensure old file is gone
+    FILE *f = fopen(CT_SESSION_LOG, "w");
     if (f) {
         fclose(f);
         ESP_LOGI("SESSION", "Session started, new log created.");
@@ -123,7 +123,7 @@ void startSession(void){
 #endif
 
 void endSession(bool sendBLE) {
-    FILE *f = fopen("/spiffs/session.log", "rb");
+    FILE *f = fopen(CT_SESSION_LOG, "rb");
     if (f) {
         if (sendBLE) {
             if (ble_is_connected()) {
@@ -233,7 +233,7 @@ void endSession(bool sendBLE) {
             fclose(f);
         }
     }
-    remove("/spiffs/session.log");
+    remove(CT_SESSION_LOG);
 }
 
 //------FILE stuff ------
@@ -254,7 +254,7 @@ void InitFileSystem(void) {
 
 //---save each burst to the file
 void saveBurstToFile(void) {
-    FILE *f = fopen("/spiffs/session.log", "a");
+    FILE *f = fopen(CT_SESSION_LOG, "a");
     if (!f) {
         ESP_LOGE(TAG, "FAILED to open session file");
         return;
@@ -2,11 +2,14 @@
 #define CART_TRACKING_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define CT_SESSION_LOG "/spiffs/session.log"   // Session log sent on CT_STOP
+
 /**
  * @brief Initialize the file system (SPIFFS)
  */
@@ -1,6 +1,10 @@
 #include "imu.h"
+#include "cartediem_defs.h"
 #include "math.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include <string.h>
 
 #define TAG "ICM20948"
 
@@ -28,43 +32,121 @@ static void activity_timer_callback(TimerHandle_t xTimer)
 /* I2C helpers                                                                */
 /* -------------------------------------------------------------------------- */
 
+#define ICM20948_MAX_BURST_WRITE 8   // Consecutive registers coalesced into one write
+#define ICM20948_REST_STEADY_G   0.01f  // |accel| spread below this (with the gyro quiet) is at rest
+#define ICM20948_REST_ALPHA      0.1f   // Resting |accel| tracking per steady sample/block
+
 /**
- * @brief Read multiple bytes from ICM20948 register
+ * @brief Read multiple bytes from ICM20948 register (current bank)
  */
 static esp_err_t icm20948_read_bytes(ICM20948_t *device, uint8_t reg, uint8_t *data, size_t len)
 {
+    device->bus_transactions++;
     return i2c_master_transmit_receive(device->dev_handle, &reg, 1, data, len, -1);
 }
 
 /**
- * @brief Write single byte to ICM20948 register
+ * @brief Write consecutive registers from reg in one transaction (current bank)
+ */
+static esp_err_t icm20948_write_burst(ICM20948_t *device, uint8_t reg, const uint8_t *values, size_t len)
+{
+    uint8_t write_buf[1 + ICM20948_MAX_BURST_WRITE];
+    write_buf[0] = reg;
+    memcpy(&write_buf[1], values, len);
+    device->bus_transactions++;
+    return i2c_master_transmit(device->dev_handle, write_buf, 1 + len, -1);
+}
+
+/**
+ * @brief Switch bank unless already there (caller holds bus_lock)
+ */
+static esp_err_t icm20948_set_bank(ICM20948_t *dev, uint8_t bank)
+{
+    if (dev->bank == bank) {
+        return ESP_OK;
+    }
+    esp_err_t ret = icm20948_write_burst(dev, ICM20948_REG_BANK_SEL, &bank, 1);
+    dev->bank = (ret == ESP_OK) ? bank : ICM20948_BANK_UNKNOWN;
+    return ret;
+}
+
+/**
+ * @brief Read registers from a bank (bank switch and read are atomic)
+ */
+esp_err_t icm20948_read_regs(ICM20948_t *dev, uint8_t bank, uint8_t reg, uint8_t *data, size_t len)
+{
+    xSemaphoreTake(dev->bus_lock, portMAX_DELAY);
+    esp_err_t ret = icm20948_set_bank(dev, bank);
+    if (ret == ESP_OK) {
+        ret = icm20948_read_bytes(dev, reg, data, len);
+    }
+    xSemaphoreGive(dev->bus_lock);
+    return ret;
+}
+
+/**
+ * @brief Write one register in a bank
  */
-static esp_err_t icm20948_write_byte(ICM20948_t *device, uint8_t reg, uint8_t value)
+static esp_err_t icm20948_write_reg(ICM20948_t *dev, uint8_t bank, uint8_t reg, uint8_t value)
 {
-    uint8_t write_buf[2] = { reg, value };
-    return i2c_master_transmit(device->dev_handle, write_buf, sizeof(write_buf), -1);
+    icm20948_reg_write_t w = { bank, reg, value };
+    return icm20948_write_regs(dev, &w, 1);
 }
 
 /**
- * @brief Read 16-bit signed value from ICM20948
+ * @brief Read 16-bit signed value from ICM20948 (bank 0)
  */
 static int16_t icm20948_read_int16(ICM20948_t *device, uint8_t reg_high)
 {
-    uint8_t data[2];
-    icm20948_read_bytes(device, reg_high, data, 2);
+    uint8_t data[2] = {0};
+    icm20948_read_regs(device, ICM20948_BANK_0, reg_high, data, 2);
     return (int16_t)((data[0] << 8) | data[1]);
 }
 
+/**
+ * @brief Write a register sequence in order, switching banks only when the bank changes
+ */
+esp_err_t icm20948_write_regs(ICM20948_t *dev, const icm20948_reg_write_t *seq, size_t count)
+{
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(dev->bus_lock, portMAX_DELAY);
+
+    size_t i = 0;
+    while (i < count && ret == ESP_OK) {
+        // Coalesce a run of consecutive registers in the same bank into one burst
+        uint8_t values[ICM20948_MAX_BURST_WRITE];
+        size_t run = 0;
+        do {
+            values[run] = seq[i + run].value;
+            run++;
+        } while (i + run < count && run < ICM20948_MAX_BURST_WRITE &&
+                 seq[i + run].bank == seq[i].bank &&
+                 seq[i + run].reg == seq[i].reg + run);
+
+        ret = icm20948_set_bank(dev, seq[i].bank);
+        if (ret == ESP_OK) {
+            ret = icm20948_write_burst(dev, seq[i].reg, values, run);
+        }
+        i += run;
+    }
+
+    xSemaphoreGive(dev->bus_lock);
+    return ret;
+}
+
 /* -------------------------------------------------------------------------- */
 /* Bank select                                                                */
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Select register bank on ICM20948
+ * @brief Select register bank on ICM20948 (skipped if already selected)
  */
 esp_err_t icm20948_select_bank(ICM20948_t *dev, uint8_t bank)
 {
-    return icm20948_write_byte(dev, ICM20948_REG_BANK_SEL, bank);
+    xSemaphoreTake(dev->bus_lock, portMAX_DELAY);
+    esp_err_t ret = icm20948_set_bank(dev, bank);
+    xSemaphoreGive(dev->bus_lock);
+    return ret;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -78,49 +160,39 @@ esp_err_t icm20948_init_mag(ICM20948_t *dev)
 {
     esp_err_t ret;
 
-    // --- Step 1: Enable I2C master (Bank 0, USER_CTRL) ---
-    icm20948_select_bank(dev, ICM20948_BANK_0);
-    ret = icm20948_write_byte(dev, REG_USER_CTRL, USER_CTRL_I2C_MST_ENABLE);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to enable I2C master (USER_CTRL)");
-        return ret;
-    }
-
-    // --- Step 2: Configure I2C master clock (Bank 3, I2C_MST_CTRL) ---
-    icm20948_select_bank(dev, ICM20948_BANK_3);
-    ret = icm20948_write_byte(dev, REG_I2C_MST_CTRL, 0x07); // ~400 kHz
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set I2C_MST_CTRL");
-        return ret;
-    }
-
-    // --- Step 3: Use SLV1 to write AK09916 CNTL2 = 100 Hz continuous mode ---
+    // --- Steps 1-3: Enable I2C master, set its clock, use SLV1 to write
+    // AK09916 CNTL2 = 100 Hz continuous mode (DO first so SLV1 ADDR..CTRL go in one burst) ---
     // NOTE: For ICM-20948, I2C_SLVx_ADDR uses:
     //   bit7 = R/W, bits[6:0] = 7-bit address
     //   So: write = 0x0C, read = 0x8C
-    ret  = icm20948_write_byte(dev, REG_I2C_SLV1_ADDR, AK09916_I2C_ADDR);          // Write mode, R/W=0
-    ret |= icm20948_write_byte(dev, REG_I2C_SLV1_REG,  AK09916_REG_CNTL2);
-    ret |= icm20948_write_byte(dev, REG_I2C_SLV1_DO,   AK09916_MODE_100HZ);
-    ret |= icm20948_write_byte(dev, REG_I2C_SLV1_CTRL, 0x81);  // enable, 1 byte
+    const icm20948_reg_write_t mag_mode_seq[] = {
+        { ICM20948_BANK_0, REG_USER_CTRL,     USER_CTRL_I2C_MST_ENABLE },
+        { ICM20948_BANK_3, REG_I2C_MST_CTRL,  0x07 },                  // ~400 kHz
+        { ICM20948_BANK_3, REG_I2C_SLV1_DO,   AK09916_MODE_100HZ },
+        { ICM20948_BANK_3, REG_I2C_SLV1_ADDR, AK09916_I2C_ADDR },      // Write mode, R/W=0
+        { ICM20948_BANK_3, REG_I2C_SLV1_REG,  AK09916_REG_CNTL2 },
+        { ICM20948_BANK_3, REG_I2C_SLV1_CTRL, 0x81 },                  // enable, 1 byte
+    };
+    ret = icm20948_write_regs(dev, mag_mode_seq, sizeof(mag_mode_seq) / sizeof(mag_mode_seq[0]));
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure I2C_SLV1 for CNTL2 write");
+        ESP_LOGE(TAG, "Failed to configure I2C master / SLV1 for CNTL2 write");
         return ret;
     }
 
     vTaskDelay(pdMS_TO_TICKS(20)); // Allow magnetometer to enter mode
 
-    // --- Step 4: Configure SLV0 to read 8 bytes starting at ST1 ---
-    ret  = icm20948_write_byte(dev, REG_I2C_SLV0_ADDR, AK09916_I2C_ADDR | 0x80); // Read mode, R/W=1
-    ret |= icm20948_write_byte(dev, REG_I2C_SLV0_REG,  AK09916_REG_ST1);
-    ret |= icm20948_write_byte(dev, REG_I2C_SLV0_CTRL, 0x88);  // enable, 8 bytes
+    // --- Step 4: Configure SLV0 to read ST1..ST2 (9 bytes): the ST2 read releases the next sample ---
+    const icm20948_reg_write_t mag_read_seq[] = {
+        { ICM20948_BANK_3, REG_I2C_SLV0_ADDR, AK09916_I2C_ADDR | 0x80 },  // Read mode, R/W=1
+        { ICM20948_BANK_3, REG_I2C_SLV0_REG,  AK09916_REG_ST1 },
+        { ICM20948_BANK_3, REG_I2C_SLV0_CTRL, 0x80 | AK09916_READ_LEN },  // enable, 9 bytes
+    };
+    ret = icm20948_write_regs(dev, mag_read_seq, sizeof(mag_read_seq) / sizeof(mag_read_seq[0]));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure I2C_SLV0 for mag read");
         return ret;
     }
 
-    // Back to Bank 0
-    icm20948_select_bank(dev, ICM20948_BANK_0);
-
     ESP_LOGI(TAG, "Magnetometer initialized (AK09916 @ 100Hz)");
     return ESP_OK;
 }
@@ -141,6 +213,9 @@ void icm20948_init(ICM20948_t *device, i2c_master_bus_handle_t bus_handle)
     };
 
     ESP_ERROR_CHECK(i2c_master_bus_add_device(bus_handle, &dev_cfg, &device->dev_handle));
+    device->bus_lock = xSemaphoreCreateMutex();
+    device->bank = ICM20948_BANK_UNKNOWN;
+    device->bus_transactions = 0;
 
     // Default sensitivities (will be updated by set_* functions)
     device->accel.sensitivity = 16384.0f; // ±2g
@@ -150,23 +225,38 @@ void icm20948_init(ICM20948_t *device, i2c_master_bus_handle_t bus_handle)
     device->status           = STANDBY;
     device->direction_deg    = 0.0f;
     device->idle_counter_ms  = 0;
+    device->event_ms         = IMU_EVENT_INTERVAL_MS;
+    device->idle_ms          = IMU_IDLE_TIME_MINUTES * 60 * 1000;
+    device->activity_check_ms = 0;
     device->activity_timer   = NULL;
     device->idle_event_queue = NULL;
     device->last_queue_send_ms = 0;
     device->first_queue_send_done = false;
     device->was_idle_long = false;
     device->motion_after_idle_queue = NULL;
-
-    // --- Full chip reset ---
-    icm20948_write_byte(device, ICM20948_PWR_MGMT_1, 0x80);  // DEVICE_RESET
+    device->in_motion = false;
+    device->motion_change_ms = 0;
+    device->last_motion_ms = 0;
+    device->rest_g = 1.0f;
+    device->motion_prev_g = 0.0f;
+    device->fifo_active = false;
+    device->fifo_odr_hz = 0.0f;
+    device->parked = false;
+    device->mag_update_ms = 0;
+    device->mag_overflows = 0;
+    device->mag_stale = 0;
+    memset(device->mag_last_raw, 0, sizeof(device->mag_last_raw));
+    icm20948_set_mag_cal(device, NULL);
+
+    // --- Full chip reset (REG_BANK_SEL comes back as bank 0) ---
+    icm20948_write_reg(device, ICM20948_BANK_0, ICM20948_PWR_MGMT_1, 0x80);  // DEVICE_RESET
     vTaskDelay(pdMS_TO_TICKS(100));
+    device->bank = ICM20948_BANK_0;
 
-    // --- Wake up, select best clock (auto PLL) ---
-    icm20948_write_byte(device, ICM20948_PWR_MGMT_1, 0x01);  // CLKSEL=1, SLEEP=0
+    // --- Wake up, select best clock (auto PLL), enable accel + gyro on all axes ---
+    icm20948_write_reg(device, ICM20948_BANK_0, ICM20948_PWR_MGMT_1, 0x01);  // CLKSEL=1, SLEEP=0
     vTaskDelay(pdMS_TO_TICKS(10));
-
-    // --- Enable accel + gyro on all axes ---
-    icm20948_write_byte(device, ICM20948_PWR_MGMT_2, 0x00);
+    icm20948_write_reg(device, ICM20948_BANK_0, ICM20948_PWR_MGMT_2, 0x00);
 
     // --- Configure full scale ranges (Bank 2) ---
     icm20948_set_gyroDPS(device, 250); // ±250 dps
@@ -174,7 +264,7 @@ void icm20948_init(ICM20948_t *device, i2c_master_bus_handle_t bus_handle)
 
     // WHO_AM_I check
     uint8_t who = 0;
-    icm20948_read_bytes(device, ICM20948_WHO_AM_I, &who, 1);
+    icm20948_read_regs(device, ICM20948_BANK_0, ICM20948_WHO_AM_I, &who, 1);
     if (who != 0xEA) {
         ESP_LOGE(TAG, "ICM20948 WHO_AM_I mismatch: 0x%02X (expected 0xEA)", who);
     } else {
@@ -196,8 +286,7 @@ void icm20948_init(ICM20948_t *device, i2c_master_bus_handle_t bus_handle)
  */
 float icm20948_compute_heading(ICM20948_t *dev)
 {
-    icm20948_read_mag(dev);
-    icm20948_read_accel(dev);
+    icm20948_read_all(dev);
 
     // If magnetometer is not actually returning data, don't pretend we have a heading
     if (dev->mag.x == 0.0f && dev->mag.y == 0.0f && dev->mag.z == 0.0f) {
@@ -230,6 +319,20 @@ float icm20948_compute_heading(ICM20948_t *dev)
  */
 bool icm20948_is_moving(ICM20948_t *dev)
 {
+    // Parked: any motion would have raised the wake-on-motion interrupt
+    if (dev->parked) {
+        dev->status = LOWPOWER;
+        return false;
+    }
+
+    // With the FIFO running every sample has been looked at: moving if any block since the last check moved
+    if (dev->fifo_active) {
+        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        bool moving = dev->in_motion || now - dev->last_motion_ms < dev->event_ms;
+        dev->status = moving ? MOVING : IDLE;
+        return moving;
+    }
+
     icm20948_read_accel(dev);
     float mag = sqrtf(dev->accel.x * dev->accel.x +
                       dev->accel.y * dev->accel.y +
@@ -242,6 +345,101 @@ bool icm20948_is_moving(ICM20948_t *dev)
     return moving;
 }
 
+/**
+ * @brief Follow the resting |accel| (1 g plus the sensor's scale and offset error) while steady
+ */
+static void icm20948_learn_rest(ICM20948_t *dev, float a, bool steady)
+{
+    if (steady && a >= 0.2f) {
+        dev->rest_g += (a - dev->rest_g) * ICM20948_REST_ALPHA;
+    }
+}
+
+/**
+ * @brief Sample accel + gyro and update in_motion (pushing, bumps, rotation)
+ */
+bool icm20948_update_motion(ICM20948_t *dev)
+{
+    icm20948_read_all(dev);
+
+    // At rest the accel magnitude holds its resting value and the gyro reads ~0 whatever the tilt
+    float a = sqrtf(dev->accel.x * dev->accel.x +
+                    dev->accel.y * dev->accel.y +
+                    dev->accel.z * dev->accel.z);
+    float w = sqrtf(dev->gyro.x * dev->gyro.x +
+                    dev->gyro.y * dev->gyro.y +
+                    dev->gyro.z * dev->gyro.z);
+    bool moving = fabsf(a - dev->rest_g) > IMU_MOTION_ACCEL_G || w > IMU_MOTION_GYRO_DPS;
+    icm20948_learn_rest(dev, a, fabsf(a - dev->motion_prev_g) < ICM20948_REST_STEADY_G &&
+                                w < IMU_MOTION_GYRO_DPS);
+    dev->motion_prev_g = a;
+    if (a < 0.2f) {
+        moving = false;  // IMU not answering (all zeros): don't hold the scales hostage
+    }
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (moving) {
+        dev->last_motion_ms = now;
+    }
+    if (moving != dev->in_motion) {
+        dev->in_motion = moving;
+        dev->motion_change_ms = now;
+    }
+    return moving;
+}
+
+/**
+ * @brief Update in_motion from a block of FIFO samples
+ */
+bool icm20948_update_motion_block(ICM20948_t *dev, const icm20948_fifo_sample_t *samples, size_t count)
+{
+    if (count == 0) {
+        return dev->in_motion;
+    }
+
+    // Averaged over the block so single noisy samples at full rate don't count as motion
+    float a_sum = 0.0f, a_sq = 0.0f, dev_sq = 0.0f, w_sum = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float ax = samples[i].accel[0] / dev->accel.sensitivity;
+        float ay = samples[i].accel[1] / dev->accel.sensitivity;
+        float az = samples[i].accel[2] / dev->accel.sensitivity;
+        float gx = samples[i].gyro[0] / dev->gyro.sensitivity;
+        float gy = samples[i].gyro[1] / dev->gyro.sensitivity;
+        float gz = samples[i].gyro[2] / dev->gyro.sensitivity;
+        float a = sqrtf(ax * ax + ay * ay + az * az);
+        a_sum += a;
+        a_sq += a * a;
+        dev_sq += (a - dev->rest_g) * (a - dev->rest_g);
+        w_sum += sqrtf(gx * gx + gy * gy + gz * gz);
+    }
+    float a_mean = a_sum / count;
+    float a_std = sqrtf(fmaxf(a_sq / count - a_mean * a_mean, 0.0f));
+    bool moving = sqrtf(dev_sq / count) > IMU_MOTION_ACCEL_G || w_sum / count > IMU_MOTION_GYRO_DPS;
+    icm20948_learn_rest(dev, a_mean, count > 1 && a_std < ICM20948_REST_STEADY_G &&
+                                     w_sum / count < IMU_MOTION_GYRO_DPS);
+    if (a_mean < 0.2f) {
+        moving = false;  // IMU not answering (all zeros): don't hold the scales hostage
+    }
+
+    const icm20948_fifo_sample_t *last = &samples[count - 1];
+    dev->accel.x = last->accel[0] / dev->accel.sensitivity;
+    dev->accel.y = last->accel[1] / dev->accel.sensitivity;
+    dev->accel.z = last->accel[2] / dev->accel.sensitivity;
+    dev->gyro.x = last->gyro[0] / dev->gyro.sensitivity;
+    dev->gyro.y = last->gyro[1] / dev->gyro.sensitivity;
+    dev->gyro.z = last->gyro[2] / dev->gyro.sensitivity;
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (moving) {
+        dev->last_motion_ms = now;
+    }
+    if (moving != dev->in_motion) {
+        dev->in_motion = moving;
+        dev->motion_change_ms = now;
+    }
+    return moving;
+}
+
 /* -------------------------------------------------------------------------- */
 /* Activity monitor                                                           */
 /* -------------------------------------------------------------------------- */
@@ -251,9 +449,14 @@ bool icm20948_is_moving(ICM20948_t *dev)
  */
 void icm20948_activity_task(ICM20948_t *dev)
 {
+    // Count real elapsed time, so changing event_ms (or a late tick) doesn't skew the idle time
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint32_t elapsed = dev->activity_check_ms ? now - dev->activity_check_ms : dev->event_ms;
+    dev->activity_check_ms = now;
+
     if (!icm20948_is_moving(dev)) {
-        dev->idle_counter_ms += IMU_MONITOR_INTERVAL_MS;
-        if (dev->idle_counter_ms >= IMU_IDLE_TIME_MINUTES * 60 * 1000) {
+        dev->idle_counter_ms += elapsed;
+        if (dev->idle_counter_ms >= dev->idle_ms) {
             dev->was_idle_long = true;  // Mark that we've been idle for 5+ minutes
 
             // Send idle event to queue (non-blocking from task context)
@@ -284,8 +487,8 @@ void icm20948_activity_task(ICM20948_t *dev)
     } else {
         // Motion detected
         if (dev->was_idle_long) {
-            // IMU was idle for 5+ minutes and motion just resumed (IMU_MONITOR_INTERVAL_MS)
-            ESP_LOGI(TAG, "Motion detected after %u minute idle - sending motion event", IMU_MONITOR_INTERVAL_MS);
+            // IMU was idle for idle_ms+ and motion just resumed
+            ESP_LOGI(TAG, "Motion detected after %lu s idle - sending motion event", dev->idle_counter_ms / 1000);
             if (dev->motion_after_idle_queue) {
                 uint32_t motion_event = 1;
                 xQueueSend(dev->motion_after_idle_queue, &motion_event, 0);
@@ -299,6 +502,15 @@ void icm20948_activity_task(ICM20948_t *dev)
     }
 }
 
+/**
+ * @brief Set the event layer: activity check period and the still time counted as idle
+ */
+void icm20948_set_event_rate(ICM20948_t *dev, uint32_t event_ms, uint32_t idle_ms)
+{
+    dev->event_ms = event_ms;
+    dev->idle_ms = idle_ms;
+}
+
 /* -------------------------------------------------------------------------- */
 /* Accel / Gyro read                                                          */
 /* -------------------------------------------------------------------------- */
@@ -308,7 +520,6 @@ void icm20948_activity_task(ICM20948_t *dev)
  */
 esp_err_t icm20948_read_accel(ICM20948_t *device)
 {
-    icm20948_select_bank(device, ICM20948_BANK_0);
     int16_t ax_raw = icm20948_read_int16(device, ICM20948_ACCEL_XOUT_H);
     int16_t ay_raw = icm20948_read_int16(device, ICM20948_ACCEL_YOUT_H);
     int16_t az_raw = icm20948_read_int16(device, ICM20948_ACCEL_ZOUT_H);
@@ -325,7 +536,6 @@ esp_err_t icm20948_read_accel(ICM20948_t *device)
  */
 esp_err_t icm20948_read_gyro(ICM20948_t *device)
 {
-    icm20948_select_bank(device, ICM20948_BANK_0);
     int16_t gx_raw = icm20948_read_int16(device, ICM20948_GYRO_XOUT_H);
     int16_t gy_raw = icm20948_read_int16(device, ICM20948_GYRO_YOUT_H);
     int16_t gz_raw = icm20948_read_int16(device, ICM20948_GYRO_ZOUT_H);
@@ -338,36 +548,481 @@ esp_err_t icm20948_read_gyro(ICM20948_t *device)
 }
 
 /* -------------------------------------------------------------------------- */
-/* Magnetometer read (EXT_SENS_DATA_00..07 -> AK09916)                       */
+/* Magnetometer read (EXT_SENS_DATA_00..08 -> AK09916)                       */
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Read magnetometer data
+ * @brief Check the mag status bytes and scale the reading to uT (calibrated or not)
  */
-esp_err_t icm20948_read_mag(ICM20948_t *dev)
+esp_err_t icm20948_mag_convert(ICM20948_t *dev, const icm20948_raw_sample_t *raw, float ut[3], bool calibrated)
+{
+    if (raw->mag_st2 & AK09916_ST2_HOFL) {
+        dev->mag_overflows++;
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    // The I2C master polls the AK09916 faster than it converts, so DRDY is often already
+    // consumed: a changed reading is new too. Only an unchanged one for too long is stale.
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if ((raw->mag_st1 & AK09916_ST1_DRDY) || memcmp(raw->mag, dev->mag_last_raw, sizeof(dev->mag_last_raw)) != 0) {
+        memcpy(dev->mag_last_raw, raw->mag, sizeof(dev->mag_last_raw));
+        dev->mag_update_ms = now;
+    } else if (now - dev->mag_update_ms > AK09916_STALE_MS) {
+        dev->mag_stale++;
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!calibrated) {
+        for (int i = 0; i < 3; i++) {
+            ut[i] = raw->mag[i] * AK09916_SENSITIVITY;
+        }
+        return ESP_OK;
+    }
+
+    const float x = raw->mag[0], y = raw->mag[1], z = raw->mag[2];
+    for (int i = 0; i < 3; i++) {
+        ut[i] = dev->mag_xform[i][0] * x + dev->mag_xform[i][1] * y + dev->mag_xform[i][2] * z - dev->mag_bias[i];
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Use a hard/soft-iron calibration in the read path (NULL = sensitivity only)
+ */
+void icm20948_set_mag_cal(ICM20948_t *dev, const icm20948_mag_cal_t *cal)
 {
-    icm20948_select_bank(dev, ICM20948_BANK_0);
+    if (cal == NULL) {
+        memset(&dev->mag_cal, 0, sizeof(dev->mag_cal));
+        for (int i = 0; i < 3; i++) {
+            dev->mag_cal.soft[i][i] = 1.0f;
+        }
+        dev->mag_calibrated = false;
+    } else {
+        dev->mag_cal = *cal;
+        dev->mag_calibrated = true;
+    }
+
+    // soft * (counts * sens - hard) = (soft * sens) * counts - soft * hard
+    for (int i = 0; i < 3; i++) {
+        dev->mag_bias[i] = 0.0f;
+        for (int j = 0; j < 3; j++) {
+            dev->mag_xform[i][j] = dev->mag_cal.soft[i][j] * AK09916_SENSITIVITY;
+            dev->mag_bias[i] += dev->mag_cal.soft[i][j] * dev->mag_cal.hard_ut[j];
+        }
+    }
+}
 
-    uint8_t raw[8] = {0};
-    esp_err_t ret = icm20948_read_bytes(dev, EXT_SENS_DATA_00, raw, 8);
+/**
+ * @brief Load the magnetometer calibration saved in NVS (keeps the current one if none)
+ */
+esp_err_t icm20948_mag_cal_load(ICM20948_t *dev)
+{
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(ICM20948_MAG_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    icm20948_mag_cal_t cal;
+    size_t len = sizeof(cal);
+    ret = nvs_get_blob(nvs, "cal", &cal, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (len != sizeof(cal)) {
+        ESP_LOGW(TAG, "Ignoring invalid magnetometer calibration in NVS");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    icm20948_set_mag_cal(dev, &cal);
+    ESP_LOGI(TAG, "Loaded magnetometer calibration (hard iron %.1f %.1f %.1f uT)",
+             cal.hard_ut[0], cal.hard_ut[1], cal.hard_ut[2]);
+    return ESP_OK;
+}
+
+/**
+ * @brief Apply a magnetometer calibration and save it to NVS
+ */
+esp_err_t icm20948_mag_cal_save(ICM20948_t *dev, const icm20948_mag_cal_t *cal)
+{
+    if (cal == NULL) return ESP_ERR_INVALID_ARG;
+    icm20948_set_mag_cal(dev, cal);
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(ICM20948_MAG_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs, "cal", cal, sizeof(*cal));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Magnetometer calibration applied but not saved: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief Back to sensitivity-only readings and erase the saved calibration
+ */
+esp_err_t icm20948_mag_cal_reset(ICM20948_t *dev)
+{
+    icm20948_set_mag_cal(dev, NULL);
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(ICM20948_MAG_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_erase_key(nvs, "cal");
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    }
+    nvs_close(nvs);
+    return ret;
+}
+
+/**
+ * @brief Read magnetometer data (left unchanged if the sample is invalid or stale)
+ */
+esp_err_t icm20948_read_mag(ICM20948_t *dev)
+{
+    uint8_t buf[AK09916_READ_LEN] = {0};
+    esp_err_t ret = icm20948_read_regs(dev, ICM20948_BANK_0, EXT_SENS_DATA_00, buf, sizeof(buf));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read EXT_SENS_DATA: %d", ret);
         return ret;
     }
 
-    // raw[0] = ST1, raw[1..6] = HXL..HZH
-    // We ignore ST1/ST2 status here for now.
-    int16_t mx = (int16_t)((raw[2] << 8) | raw[1]);
-    int16_t my = (int16_t)((raw[4] << 8) | raw[3]);
-    int16_t mz = (int16_t)((raw[6] << 8) | raw[5]);
+    // buf[0] = ST1, buf[1..6] = HXL..HZH, buf[7] = TMPS, buf[8] = ST2
+    icm20948_raw_sample_t raw = { .mag_st1 = buf[0], .mag_tmps = buf[7], .mag_st2 = buf[8] };
+    for (int i = 0; i < 3; i++) {
+        raw.mag[i] = (int16_t)((buf[2 + 2 * i] << 8) | buf[1 + 2 * i]);
+    }
+
+    float ut[3];
+    ret = icm20948_mag_convert(dev, &raw, ut, true);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    dev->mag.x = ut[0];
+    dev->mag.y = ut[1];
+    dev->mag.z = ut[2];
+    return ESP_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Burst read (ACCEL_XOUT_H..EXT_SENS_DATA_08 in one transaction)             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Read accel, gyro and mag registers in one burst (unscaled)
+ */
+esp_err_t icm20948_read_raw(ICM20948_t *device, icm20948_raw_sample_t *raw)
+{
+    uint8_t buf[ICM20948_BURST_LEN];
+
+    esp_err_t ret = icm20948_read_regs(device, ICM20948_BANK_0, ICM20948_ACCEL_XOUT_H, buf, sizeof(buf));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // ICM-20948 registers are big-endian, the AK09916 copies in EXT_SENS_DATA little-endian
+    for (int i = 0; i < 3; i++) {
+        raw->accel[i] = (int16_t)((buf[2 * i] << 8) | buf[2 * i + 1]);
+        raw->gyro[i]  = (int16_t)((buf[6 + 2 * i] << 8) | buf[6 + 2 * i + 1]);
+        raw->mag[i]   = (int16_t)((buf[16 + 2 * i] << 8) | buf[15 + 2 * i]);
+    }
+    raw->temp     = (int16_t)((buf[12] << 8) | buf[13]);
+    raw->mag_st1  = buf[14];
+    raw->mag_tmps = buf[21];
+    raw->mag_st2  = buf[22];
+    return ESP_OK;
+}
+
+/**
+ * @brief Read accel, gyro and mag in one burst and update the scaled values
+ */
+esp_err_t icm20948_read_all(ICM20948_t *device)
+{
+    icm20948_raw_sample_t raw;
+    esp_err_t ret = icm20948_read_raw(device, &raw);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    device->accel.x = (float)raw.accel[0] / device->accel.sensitivity;
+    device->accel.y = (float)raw.accel[1] / device->accel.sensitivity;
+    device->accel.z = (float)raw.accel[2] / device->accel.sensitivity;
+
+    device->gyro.x = (float)raw.gyro[0] / device->gyro.sensitivity;
+    device->gyro.y = (float)raw.gyro[1] / device->gyro.sensitivity;
+    device->gyro.z = (float)raw.gyro[2] / device->gyro.sensitivity;
+
+    // An overflowed or stalled magnetometer keeps its last good reading
+    float ut[3];
+    if (icm20948_mag_convert(device, &raw, ut, true) == ESP_OK) {
+        device->mag.x = ut[0];
+        device->mag.y = ut[1];
+        device->mag.z = ut[2];
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Time per-register sampling against the burst read (blocks the caller)
+ */
+esp_err_t icm20948_benchmark_bus(ICM20948_t *device, uint32_t iterations, icm20948_bench_t *result)
+{
+    if (iterations == 0 || result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Per-register path: one read per axis + one mag read
+    uint32_t tx = device->bus_transactions;
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        icm20948_read_accel(device);
+        icm20948_read_gyro(device);
+        if (icm20948_read_mag(device) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+    int64_t per_register = esp_timer_get_time() - start;
+    uint32_t per_register_tx = device->bus_transactions - tx;
+
+    // Burst path: one read
+    tx = device->bus_transactions;
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (icm20948_read_all(device) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+    int64_t burst = esp_timer_get_time() - start;
+    uint32_t burst_tx = device->bus_transactions - tx;
+
+    result->iterations = iterations;
+    result->per_register_us = (uint32_t)(per_register / iterations);
+    result->burst_us = (uint32_t)(burst / iterations);
+    result->per_register_transactions = (uint8_t)((per_register_tx + iterations / 2) / iterations);
+    result->burst_transactions = (uint8_t)((burst_tx + iterations / 2) / iterations);
+
+    ESP_LOGI(TAG, "Bus time per 9-axis sample over %lu runs: per-register %lu us (%d transactions), burst %lu us (%d transactions)",
+             iterations, result->per_register_us, result->per_register_transactions,
+             result->burst_us, result->burst_transactions);
+    return ESP_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* FIFO (accel + gyro packets, drained in bulk)                               */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Gyro sample rate divider nearest to an ODR
+ */
+static uint32_t icm20948_gyro_div(uint32_t odr_hz)
+{
+    uint32_t gyro_div = (ICM20948_GYRO_BASE_HZ + odr_hz / 2) / odr_hz - 1;
+    return gyro_div > 0xFF ? 0xFF : gyro_div;   // ~4.3 Hz floor
+}
+
+/**
+ * @brief Rate the FIFO actually runs at for a requested ODR (nearest sample rate divider)
+ */
+float icm20948_fifo_rate_hz(uint32_t odr_hz)
+{
+    if (odr_hz == 0) {
+        return 0.0f;
+    }
+    return (float)ICM20948_GYRO_BASE_HZ / (1 + icm20948_gyro_div(odr_hz));
+}
+
+/**
+ * @brief Set the accel/gyro ODR, reset the FIFO and start filling it; INT1 pulses per sample
+ */
+esp_err_t icm20948_fifo_enable(ICM20948_t *device, uint32_t odr_hz)
+{
+    if (odr_hz == 0 || odr_hz > ICM20948_GYRO_BASE_HZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t gyro_div = icm20948_gyro_div(odr_hz);
+    uint32_t accel_div = (ICM20948_ACCEL_BASE_HZ + odr_hz / 2) / odr_hz - 1;
+
+    const icm20948_reg_write_t seq[] = {
+        { ICM20948_BANK_2, ICM20948_GYRO_SMPLRT_DIV,    (uint8_t)gyro_div },
+        { ICM20948_BANK_2, ICM20948_ACCEL_SMPLRT_DIV_1, (uint8_t)((accel_div >> 8) & 0x0F) },
+        { ICM20948_BANK_2, ICM20948_ACCEL_SMPLRT_DIV_2, (uint8_t)(accel_div & 0xFF) },
+        { ICM20948_BANK_0, REG_USER_CTRL,         USER_CTRL_I2C_MST_ENABLE },   // FIFO off while resetting
+        { ICM20948_BANK_0, ICM20948_FIFO_EN_1,    0x00 },
+        { ICM20948_BANK_0, ICM20948_FIFO_EN_2,    0x00 },
+        { ICM20948_BANK_0, ICM20948_FIFO_RST,     0x1F },
+        { ICM20948_BANK_0, ICM20948_FIFO_MODE,    0x00 },
+        { ICM20948_BANK_0, ICM20948_FIFO_RST,     0x00 },
+        { ICM20948_BANK_0, ICM20948_INT_PIN_CFG,  0x00 },
+        { ICM20948_BANK_0, ICM20948_INT_ENABLE_1, INT_ENABLE_1_RAW_DATA_RDY },
+        { ICM20948_BANK_0, ICM20948_FIFO_EN_2,    FIFO_EN_2_ACCEL | FIFO_EN_2_GYRO_XYZ },
+        { ICM20948_BANK_0, REG_USER_CTRL,         USER_CTRL_I2C_MST_ENABLE | USER_CTRL_FIFO_ENABLE },
+    };
+    esp_err_t ret = icm20948_write_regs(device, seq, sizeof(seq) / sizeof(seq[0]));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable FIFO: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    device->fifo_odr_hz = icm20948_fifo_rate_hz(odr_hz);
+    device->fifo_active = true;
+    ESP_LOGI(TAG, "FIFO enabled at %.1f Hz (accel + gyro)", device->fifo_odr_hz);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop filling the FIFO and disable the sample interrupt
+ */
+esp_err_t icm20948_fifo_disable(ICM20948_t *device)
+{
+    const icm20948_reg_write_t seq[] = {
+        { ICM20948_BANK_0, REG_USER_CTRL,         USER_CTRL_I2C_MST_ENABLE },
+        { ICM20948_BANK_0, ICM20948_INT_ENABLE_1, 0x00 },
+        { ICM20948_BANK_0, ICM20948_FIFO_EN_2,    0x00 },
+    };
+    device->fifo_active = false;
+    return icm20948_write_regs(device, seq, sizeof(seq) / sizeof(seq[0]));
+}
+
+/**
+ * @brief Drain up to max whole samples from the FIFO in one bulk read
+ */
+esp_err_t icm20948_fifo_read(ICM20948_t *device, icm20948_fifo_sample_t *samples, size_t max, size_t *count)
+{
+    uint8_t cnt[2];
+    *count = 0;
+    esp_err_t ret = icm20948_read_regs(device, ICM20948_BANK_0, ICM20948_FIFO_COUNTH, cnt, 2);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    size_t bytes = ((cnt[0] & 0x1F) << 8) | cnt[1];
+
+    // Stream mode overwrites the oldest bytes when full, so packet boundaries are lost
+    if (bytes > ICM20948_FIFO_SIZE - ICM20948_FIFO_PACKET) {
+        const icm20948_reg_write_t rst[] = {
+            { ICM20948_BANK_0, ICM20948_FIFO_RST, 0x1F },
+            { ICM20948_BANK_0, ICM20948_FIFO_RST, 0x00 },
+        };
+        icm20948_write_regs(device, rst, 2);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t n = bytes / ICM20948_FIFO_PACKET;
+    if (n > max) {
+        n = max;
+    }
+    if (n > ICM20948_FIFO_MAX_SAMPLES) {
+        n = ICM20948_FIFO_MAX_SAMPLES;
+    }
+    if (n == 0) {
+        return ESP_OK;
+    }
 
-    dev->mag.x = (float)mx * AK09916_SENSITIVITY;
-    dev->mag.y = (float)my * AK09916_SENSITIVITY;
-    dev->mag.z = (float)mz * AK09916_SENSITIVITY;
+    uint8_t buf[ICM20948_FIFO_MAX_SAMPLES * ICM20948_FIFO_PACKET];
+    ret = icm20948_read_regs(device, ICM20948_BANK_0, ICM20948_FIFO_R_W, buf, n * ICM20948_FIFO_PACKET);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *p = &buf[i * ICM20948_FIFO_PACKET];
+        for (int k = 0; k < 3; k++) {
+            samples[i].accel[k] = (int16_t)((p[2 * k] << 8) | p[2 * k + 1]);
+            samples[i].gyro[k]  = (int16_t)((p[6 + 2 * k] << 8) | p[6 + 2 * k + 1]);
+        }
+    }
+    *count = n;
     return ESP_OK;
 }
 
+/* -------------------------------------------------------------------------- */
+/* Wake-on-motion (parked, low-power accel cycle)                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Park: gyro off, accel in low-power cycle mode, INT1 pulses on motion above thr_mg
+ */
+esp_err_t icm20948_wom_enable(ICM20948_t *device, uint32_t thr_mg, uint32_t cycle_hz)
+{
+    if (cycle_hz == 0 || thr_mg == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t thr = (thr_mg + 2) / 4;
+    if (thr > 0xFF) {
+        thr = 0xFF;
+    }
+    uint32_t accel_div = (ICM20948_ACCEL_BASE_HZ + cycle_hz / 2) / cycle_hz - 1;
+    if (accel_div > 0xFFF) {
+        accel_div = 0xFFF;
+    }
+
+    const icm20948_reg_write_t seq[] = {
+        { ICM20948_BANK_0, ICM20948_INT_ENABLE_1,       0x00 },
+        { ICM20948_BANK_2, ICM20948_ACCEL_SMPLRT_DIV_1, (uint8_t)(accel_div >> 8) },
+        { ICM20948_BANK_2, ICM20948_ACCEL_SMPLRT_DIV_2, (uint8_t)(accel_div & 0xFF) },
+        { ICM20948_BANK_2, ICM20948_ACCEL_INTEL_CTRL,   ACCEL_INTEL_EN_CMP_PREV },
+        { ICM20948_BANK_2, ICM20948_ACCEL_WOM_THR,      (uint8_t)thr },
+        { ICM20948_BANK_0, ICM20948_INT_ENABLE,         INT_ENABLE_WOM },
+        { ICM20948_BANK_0, ICM20948_LP_CONFIG,          LP_CONFIG_I2C_MST_CYCLE | LP_CONFIG_ACCEL_CYCLE },
+        { ICM20948_BANK_0, ICM20948_PWR_MGMT_1,         PWR_MGMT_1_LP_EN | PWR_MGMT_1_CLKSEL_AUTO },
+        { ICM20948_BANK_0, ICM20948_PWR_MGMT_2,         PWR_MGMT_2_GYRO_OFF },
+    };
+    esp_err_t ret = icm20948_write_regs(device, seq, sizeof(seq) / sizeof(seq[0]));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable wake-on-motion: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    uint8_t status;
+    icm20948_read_int_status(device, &status);  // drop anything latched before parking
+    device->parked = true;
+    device->status = LOWPOWER;
+    ESP_LOGI(TAG, "Parked: wake-on-motion above %lu mg, accel cycling at %.1f Hz",
+             thr * 4, (float)ICM20948_ACCEL_BASE_HZ / (1 + accel_div));
+    return ESP_OK;
+}
+
+/**
+ * @brief Leave wake-on-motion and return to full power (accel + gyro on)
+ */
+esp_err_t icm20948_wom_disable(ICM20948_t *device)
+{
+    const icm20948_reg_write_t seq[] = {
+        { ICM20948_BANK_0, ICM20948_LP_CONFIG,        LP_CONFIG_I2C_MST_CYCLE },
+        { ICM20948_BANK_0, ICM20948_PWR_MGMT_1,       PWR_MGMT_1_CLKSEL_AUTO },
+        { ICM20948_BANK_0, ICM20948_PWR_MGMT_2,       0x00 },
+        { ICM20948_BANK_0, ICM20948_INT_ENABLE,       0x00 },
+        { ICM20948_BANK_2, ICM20948_ACCEL_SMPLRT_DIV_1, 0x00 },   // full rate until the FIFO sets it
+        { ICM20948_BANK_2, ICM20948_ACCEL_SMPLRT_DIV_2, 0x00 },
+        { ICM20948_BANK_2, ICM20948_ACCEL_INTEL_CTRL, 0x00 },
+    };
+    esp_err_t ret = icm20948_write_regs(device, seq, sizeof(seq) / sizeof(seq[0]));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to leave wake-on-motion: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    device->parked = false;
+    device->status = MOVING;
+    return ESP_OK;
+}
+
+/**
+ * @brief Read (and clear) INT_STATUS
+ */
+esp_err_t icm20948_read_int_status(ICM20948_t *device, uint8_t *status)
+{
+    return icm20948_read_regs(device, ICM20948_BANK_0, ICM20948_INT_STATUS, status, 1);
+}
+
 /* -------------------------------------------------------------------------- */
 /* Full-scale settings                                                        */
 /* -------------------------------------------------------------------------- */
@@ -386,10 +1041,7 @@ esp_err_t icm20948_set_gyroDPS(ICM20948_t *device, uint32_t dps)
         default:   return ESP_FAIL;
     }
 
-    icm20948_select_bank(device, ICM20948_BANK_2);
-    icm20948_write_byte(device, ICM20948_GYRO_CONFIG_1, (fs_sel << 1));
-    icm20948_select_bank(device, ICM20948_BANK_0);
-    return ESP_OK;
+    return icm20948_write_reg(device, ICM20948_BANK_2, ICM20948_GYRO_CONFIG_1, (fs_sel << 1) | ICM20948_DLPF_ON);
 }
 
 /**
@@ -406,8 +1058,5 @@ esp_err_t icm20948_set_accelG(ICM20948_t *device, uint8_t g)
         default: return ESP_FAIL;
     }
 
-    icm20948_select_bank(device, ICM20948_BANK_2);
-    icm20948_write_byte(device, ICM20948_ACCEL_CONFIG, (fs_sel << 1));
-    icm20948_select_bank(device, ICM20948_BANK_0);
-    return ESP_OK;
+    return icm20948_write_reg(device, ICM20948_BANK_2, ICM20948_ACCEL_CONFIG, (fs_sel << 1) | ICM20948_DLPF_ON);
 }
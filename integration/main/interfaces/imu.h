@@ -1,11 +1,13 @@
 #pragma once
 #include "imu_defs.h"
-#include "cartediem_defs.h"
 #include "stdint.h"
+#include "stdbool.h"
+#include "esp_err.h"
 #include "driver/i2c_master.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/timers.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 enum IMUstatus {
     SLEEP,
@@ -22,6 +24,62 @@ typedef struct {
     float sensitivity;
 } SensData_t;
 
+/**
+ * @brief One 9-axis sample as read in a single burst (ACCEL_XOUT_H..EXT_SENS_DATA_08)
+ *
+ * Same layout as the register block, with the byte order fixed up.
+ */
+typedef struct __attribute__((packed)) {
+    int16_t accel[3];
+    int16_t gyro[3];
+    int16_t temp;
+    uint8_t mag_st1;        // AK09916 ST1 (bit 0 = data ready)
+    int16_t mag[3];
+    uint8_t mag_tmps;       // AK09916 dummy register between HZH and ST2
+    uint8_t mag_st2;        // AK09916 ST2 (bit 3 = overflow)
+} icm20948_raw_sample_t;
+
+#define ICM20948_MAG_NVS_NAMESPACE "imu_mag"
+
+/**
+ * @brief Magnetometer hard/soft-iron calibration: corrected = soft * (reading - hard)
+ */
+typedef struct {
+    float hard_ut[3];       // offset from magnets/steel that turn with the cart
+    float soft[3][3];       // ellipsoid -> sphere (field distortion from the frame)
+} icm20948_mag_cal_t;
+
+/**
+ * @brief Bus time for one 9-axis sample, per-register reads vs. one burst
+ */
+typedef struct {
+    uint32_t iterations;
+    uint32_t per_register_us;   // mean time per sample (one read per axis)
+    uint32_t burst_us;          // mean time per sample (icm20948_read_all)
+    uint8_t per_register_transactions;  // measured, bank selects included
+    uint8_t burst_transactions;
+} icm20948_bench_t;
+
+#define ICM20948_FIFO_PACKET      12   // Accel + gyro, big-endian, as the chip writes them
+#define ICM20948_FIFO_MAX_SAMPLES (ICM20948_FIFO_SIZE / ICM20948_FIFO_PACKET)
+
+/**
+ * @brief One FIFO sample (raw counts, scale with the accel/gyro sensitivity)
+ */
+typedef struct {
+    int16_t accel[3];
+    int16_t gyro[3];
+} icm20948_fifo_sample_t;
+
+/**
+ * @brief One register write in a configuration sequence
+ */
+typedef struct {
+    uint8_t bank;           // ICM20948_BANK_x
+    uint8_t reg;
+    uint8_t value;
+} icm20948_reg_write_t;
+
 typedef struct {
     SensData_t accel;
     SensData_t gyro;
@@ -30,14 +88,48 @@ typedef struct {
     float direction_deg;  // facing direction (yaw)
     i2c_master_dev_handle_t dev_handle;
 
-    // Activity tracking
+    // Register access: bank switch + transfer happen under bus_lock, bank caches REG_BANK_SEL
+    SemaphoreHandle_t bus_lock;
+    uint8_t bank;                    // ICM20948_BANK_UNKNOWN until the first select
+    uint32_t bus_transactions;       // I2C transfers issued (bank selects included)
+
+    // Activity tracking (event layer: runs every event_ms, idle after idle_ms of real time)
     uint32_t idle_counter_ms;
+    uint32_t event_ms;
+    uint32_t idle_ms;
+    uint32_t activity_check_ms;      // Tick time of the last icm20948_activity_task, 0 = never
     TimerHandle_t activity_timer;
     QueueHandle_t idle_event_queue;  // Queue to notify main task of idle events
     uint32_t last_queue_send_ms;     // Timestamp of last queue send (for 1-min throttling)
     bool first_queue_send_done;      // Flag to track first queue send
     bool was_idle_long;              // Flag to track if IMU was idle for 5+ minutes
     QueueHandle_t motion_after_idle_queue;  // Queue to notify main task when motion resumes after idle
+
+    // Fast motion state (icm20948_update_motion), read by the weight pipeline
+    volatile bool in_motion;
+    volatile uint32_t motion_change_ms;     // Last time in_motion changed
+    volatile uint32_t last_motion_ms;       // Last block that showed motion (FIFO path)
+    float rest_g;                           // Learned |accel| at rest (centre of the motion band)
+    float motion_prev_g;                    // Last polled |accel| (steadiness check)
+
+    // Parked in low-power wake-on-motion (icm20948_wom_enable)
+    volatile bool parked;
+
+    // FIFO batching (icm20948_fifo_enable)
+    volatile bool fifo_active;
+    float fifo_odr_hz;                      // Actual rate after the divider
+
+    // Magnetometer correction, folded with the sensitivity: uT = mag_xform * counts - mag_bias
+    icm20948_mag_cal_t mag_cal;
+    float mag_xform[3][3];
+    float mag_bias[3];
+    bool mag_calibrated;
+
+    // Magnetometer sample checks (icm20948_mag_convert)
+    int16_t mag_last_raw[3];
+    uint32_t mag_update_ms;                 // Last time a new AK09916 sample was seen
+    uint32_t mag_overflows;                 // Samples dropped for ST2 overflow
+    uint32_t mag_stale;                     // Reads rejected because the sample stopped updating
 } ICM20948_t;
 
 /**
@@ -60,6 +152,95 @@ esp_err_t icm20948_read_gyro(ICM20948_t *device);
  */
 esp_err_t icm20948_read_mag(ICM20948_t *device);
 
+/**
+ * @brief Check the mag status bytes and scale the reading to uT (calibrated or not)
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_RESPONSE on overflow, ESP_ERR_INVALID_STATE if the sample stopped updating
+ */
+esp_err_t icm20948_mag_convert(ICM20948_t *device, const icm20948_raw_sample_t *raw, float ut[3], bool calibrated);
+
+/**
+ * @brief Use a hard/soft-iron calibration in the read path (NULL = sensitivity only)
+ */
+void icm20948_set_mag_cal(ICM20948_t *device, const icm20948_mag_cal_t *cal);
+
+/**
+ * @brief Load the magnetometer calibration saved in NVS (keeps the current one if none)
+ */
+esp_err_t icm20948_mag_cal_load(ICM20948_t *device);
+
+/**
+ * @brief Apply a magnetometer calibration and save it to NVS
+ */
+esp_err_t icm20948_mag_cal_save(ICM20948_t *device, const icm20948_mag_cal_t *cal);
+
+/**
+ * @brief Back to sensitivity-only readings and erase the saved calibration
+ */
+esp_err_t icm20948_mag_cal_reset(ICM20948_t *device);
+
+/**
+ * @brief Read accel, gyro and mag registers in one burst (unscaled)
+ */
+esp_err_t icm20948_read_raw(ICM20948_t *device, icm20948_raw_sample_t *raw);
+
+/**
+ * @brief Read accel, gyro and mag in one burst and update the scaled values
+ */
+esp_err_t icm20948_read_all(ICM20948_t *device);
+
+/**
+ * @brief Read registers from a bank (bank switch and read are atomic)
+ */
+esp_err_t icm20948_read_regs(ICM20948_t *device, uint8_t bank, uint8_t reg, uint8_t *data, size_t len);
+
+/**
+ * @brief Set the accel/gyro ODR, reset the FIFO and start filling it; INT1 pulses per sample
+ */
+esp_err_t icm20948_fifo_enable(ICM20948_t *device, uint32_t odr_hz);
+
+/**
+ * @brief Rate the FIFO actually runs at for a requested ODR (nearest sample rate divider)
+ */
+float icm20948_fifo_rate_hz(uint32_t odr_hz);
+
+/**
+ * @brief Stop filling the FIFO and disable the sample interrupt
+ */
+esp_err_t icm20948_fifo_disable(ICM20948_t *device);
+
+/**
+ * @brief Drain up to max whole samples from the FIFO in one bulk read
+ *
+ * @return ESP_ERR_INVALID_STATE if the FIFO overflowed (it is reset, *count = 0)
+ */
+esp_err_t icm20948_fifo_read(ICM20948_t *device, icm20948_fifo_sample_t *samples, size_t max, size_t *count);
+
+/**
+ * @brief Park: gyro off, accel in low-power cycle mode, INT1 pulses on motion above thr_mg
+ */
+esp_err_t icm20948_wom_enable(ICM20948_t *device, uint32_t thr_mg, uint32_t cycle_hz);
+
+/**
+ * @brief Leave wake-on-motion and return to full power (accel + gyro on)
+ */
+esp_err_t icm20948_wom_disable(ICM20948_t *device);
+
+/**
+ * @brief Read (and clear) INT_STATUS
+ */
+esp_err_t icm20948_read_int_status(ICM20948_t *device, uint8_t *status);
+
+/**
+ * @brief Update in_motion from a block of FIFO samples
+ */
+bool icm20948_update_motion_block(ICM20948_t *dev, const icm20948_fifo_sample_t *samples, size_t count);
+
+/**
+ * @brief Time per-register sampling against the burst read (blocks the caller)
+ */
+esp_err_t icm20948_benchmark_bus(ICM20948_t *device, uint32_t iterations, icm20948_bench_t *result);
+
 /**
  * @brief Set gyroscope full scale range (dps)
  */
@@ -80,6 +261,11 @@ float icm20948_compute_heading(ICM20948_t *device);
  */
 bool icm20948_is_moving(ICM20948_t *device);
 
+/**
+ * @brief Sample accel + gyro and update in_motion (pushing, bumps, rotation)
+ */
+bool icm20948_update_motion(ICM20948_t *dev);
+
 /**
  * @brief Check if device is moving fast
  */
@@ -91,10 +277,22 @@ bool icm20948_is_fast_moving(ICM20948_t *dev);
 void icm20948_activity_task(ICM20948_t *device);
 
 /**
- * @brief Select register bank on ICM20948
+ * @brief Set the event layer: activity check period and the still time counted as idle
+ */
+void icm20948_set_event_rate(ICM20948_t *device, uint32_t event_ms, uint32_t idle_ms);
+
+/**
+ * @brief Select register bank on ICM20948 (skipped if already selected)
  */
 esp_err_t icm20948_select_bank(ICM20948_t *dev, uint8_t bank);
 
+/**
+ * @brief Write a register sequence in order, switching banks only when the bank changes
+ *
+ * Consecutive registers in the same bank are coalesced into one burst write.
+ */
+esp_err_t icm20948_write_regs(ICM20948_t *dev, const icm20948_reg_write_t *seq, size_t count);
+
 /**
  * @brief Initialize AK09916 magnetometer
  */
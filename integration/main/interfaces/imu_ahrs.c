@@ -0,0 +1,365 @@
+#include "imu_ahrs.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "IMU_AHRS";
+
+#define IMU_AHRS_DEG_TO_RAD   0.017453292f
+#define IMU_AHRS_RAD_TO_DEG   57.29578f
+#define IMU_AHRS_READ_SPINS   4          // Seqlock retries before a reader yields to the writer
+#define IMU_AHRS_WAIT_MS      1000       // Longest wait for a FIFO batch before re-checking the source
+
+/**
+ * @brief 1 / sqrt(x)
+ */
+static inline float imu_ahrs_inv_sqrt(float x) {
+    return 1.0f / sqrtf(x);
+}
+
+/**
+ * @brief Madgwick step from gyro (rad/s) and accel only (heading drifts with the gyro)
+ */
+static void imu_ahrs_update_imu(ImuAhrs *ahrs, float gx, float gy, float gz, float ax, float ay, float az) {
+    float *q = ahrs->q;
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float beta = ahrs->cfg.beta;
+
+    float qd0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qd1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qd2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qd3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+        float n = imu_ahrs_inv_sqrt(ax * ax + ay * ay + az * az);
+        ax *= n; ay *= n; az *= n;
+
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+        n = imu_ahrs_inv_sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+
+        qd0 -= beta * s0 * n;
+        qd1 -= beta * s1 * n;
+        qd2 -= beta * s2 * n;
+        qd3 -= beta * s3 * n;
+    }
+
+    q0 += qd0 * ahrs->dt;
+    q1 += qd1 * ahrs->dt;
+    q2 += qd2 * ahrs->dt;
+    q3 += qd3 * ahrs->dt;
+    float n = imu_ahrs_inv_sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q[0] = q0 * n; q[1] = q1 * n; q[2] = q2 * n; q[3] = q3 * n;
+}
+
+/**
+ * @brief Madgwick step from gyro (rad/s), accel and mag (any unit)
+ */
+static void imu_ahrs_update_marg(ImuAhrs *ahrs, float gx, float gy, float gz,
+                                 float ax, float ay, float az, float mx, float my, float mz) {
+    if (mx == 0.0f && my == 0.0f && mz == 0.0f) {
+        imu_ahrs_update_imu(ahrs, gx, gy, gz, ax, ay, az);
+        return;
+    }
+
+    float *q = ahrs->q;
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float beta = ahrs->cfg.beta;
+
+    float qd0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qd1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qd2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qd3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+        float n = imu_ahrs_inv_sqrt(ax * ax + ay * ay + az * az);
+        ax *= n; ay *= n; az *= n;
+        n = imu_ahrs_inv_sqrt(mx * mx + my * my + mz * mz);
+        mx *= n; my *= n; mz *= n;
+
+        float _2q0mx = 2.0f * q0 * mx, _2q0my = 2.0f * q0 * my, _2q0mz = 2.0f * q0 * mz;
+        float _2q1mx = 2.0f * q1 * mx;
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _2q0q2 = 2.0f * q0 * q2, _2q2q3 = 2.0f * q2 * q3;
+        float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+        float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+        float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+        // Earth's field direction in the earth frame (only x and z components)
+        float hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
+        float hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+        float _2bx = sqrtf(hx * hx + hy * hy);
+        float _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+        float _4bx = 2.0f * _2bx, _4bz = 2.0f * _2bz;
+
+        // Gradient descent step on the accel + mag objective
+        float fa0 = 2.0f * q1q3 - _2q0q2 - ax;
+        float fa1 = 2.0f * q0q1 + _2q2q3 - ay;
+        float fa2 = 1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az;
+        float fm0 = _2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+        float fm1 = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+        float fm2 = _2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz;
+
+        float s0 = -_2q2 * fa0 + _2q1 * fa1 - _2bz * q2 * fm0 + (-_2bx * q3 + _2bz * q1) * fm1 + _2bx * q2 * fm2;
+        float s1 = _2q3 * fa0 + _2q0 * fa1 - 4.0f * q1 * fa2 + _2bz * q3 * fm0 + (_2bx * q2 + _2bz * q0) * fm1 + (_2bx * q3 - _4bz * q1) * fm2;
+        float s2 = -_2q0 * fa0 + _2q3 * fa1 - 4.0f * q2 * fa2 + (-_4bx * q2 - _2bz * q0) * fm0 + (_2bx * q1 + _2bz * q3) * fm1 + (_2bx * q0 - _4bz * q2) * fm2;
+        float s3 = _2q1 * fa0 + _2q2 * fa1 + (-_4bx * q3 + _2bz * q1) * fm0 + (-_2bx * q0 + _2bz * q2) * fm1 + _2bx * q1 * fm2;
+        n = imu_ahrs_inv_sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+
+        qd0 -= beta * s0 * n;
+        qd1 -= beta * s1 * n;
+        qd2 -= beta * s2 * n;
+        qd3 -= beta * s3 * n;
+    }
+
+    q0 += qd0 * ahrs->dt;
+    q1 += qd1 * ahrs->dt;
+    q2 += qd2 * ahrs->dt;
+    q3 += qd3 * ahrs->dt;
+    float n = imu_ahrs_inv_sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q[0] = q0 * n; q[1] = q1 * n; q[2] = q2 * n; q[3] = q3 * n;
+}
+
+/**
+ * @brief Convert the quaternion once and publish it under the sequence lock
+ */
+static void imu_ahrs_publish(ImuAhrs *ahrs, uint32_t steps, bool mag_valid) {
+    const float *q = ahrs->q;
+    float roll = atan2f(q[0] * q[1] + q[2] * q[3], 0.5f - q[1] * q[1] - q[2] * q[2]);
+    float pitch = asinf(fmaxf(-1.0f, fminf(1.0f, -2.0f * (q[1] * q[3] - q[0] * q[2]))));
+    float yaw = atan2f(q[1] * q[2] + q[0] * q[3], 0.5f - q[2] * q[2] - q[3] * q[3]);
+
+    // Compass heading grows clockwise, yaw counter-clockwise
+    float heading = -yaw * IMU_AHRS_RAD_TO_DEG;
+    if (heading < 0.0f) heading += 360.0f;
+
+    uint32_t seq = ahrs->seq;
+    __atomic_store_n(&ahrs->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(ahrs->state.q, q, sizeof(ahrs->state.q));
+    ahrs->state.heading_deg = heading;
+    ahrs->state.pitch_deg = pitch * IMU_AHRS_RAD_TO_DEG;
+    ahrs->state.roll_deg = roll * IMU_AHRS_RAD_TO_DEG;
+    ahrs->state.t_us = esp_timer_get_time();
+    ahrs->state.updates += steps;
+    ahrs->state.mag_valid = mag_valid;
+    __atomic_store_n(&ahrs->seq, seq + 2, __ATOMIC_RELEASE);
+
+    ahrs->dev->direction_deg = heading;
+}
+
+/**
+ * @brief Refresh the per-sample constants (sensitivity or rate may have changed)
+ */
+static void imu_ahrs_set_scales(ImuAhrs *ahrs, float rate_hz) {
+    ahrs->dt = 1.0f / rate_hz;
+    ahrs->accel_scale = 1.0f / ahrs->dev->accel.sensitivity;
+    ahrs->gyro_scale = IMU_AHRS_DEG_TO_RAD / ahrs->dev->gyro.sensitivity;
+}
+
+/**
+ * @brief Latest magnetometer reading in the accel/gyro frame, false if it isn't answering
+ */
+static bool imu_ahrs_read_mag(ImuAhrs *ahrs, float *mx, float *my, float *mz) {
+    if (icm20948_read_mag(ahrs->dev) != ESP_OK) {
+        *mx = *my = *mz = 0.0f;
+        return false;
+    }
+    // AK09916 axes: X matches, Y and Z are flipped relative to the accel/gyro
+    *mx = ahrs->dev->mag.x;
+    *my = -ahrs->dev->mag.y;
+    *mz = -ahrs->dev->mag.z;
+    return !(*mx == 0.0f && *my == 0.0f && *mz == 0.0f);
+}
+
+/**
+ * @brief FIFO subscriber: queue the block for the filter task
+ */
+static void imu_ahrs_on_block(void *ctx, const imu_fifo_block_t *blk) {
+    ImuAhrs *ahrs = (ImuAhrs *)ctx;
+    uint32_t head = ahrs->ring_head;
+    uint32_t tail = __atomic_load_n(&ahrs->ring_tail, __ATOMIC_ACQUIRE);
+    for (uint16_t i = 0; i < blk->count; i++) {
+        if (head - tail >= IMU_AHRS_RING_SIZE) {
+            ahrs->ring_dropped += blk->count - i;
+            break;
+        }
+        ahrs->ring[head & (IMU_AHRS_RING_SIZE - 1)] = blk->samples[i];
+        head++;
+    }
+    ahrs->ring_odr_hz = blk->odr_hz;
+    __atomic_store_n(&ahrs->ring_head, head, __ATOMIC_RELEASE);
+    if (ahrs->task != NULL) {
+        xTaskNotifyGive(ahrs->task);
+    }
+}
+
+/**
+ * @brief Run every queued FIFO sample through the filter (one mag read per batch)
+ */
+static void imu_ahrs_drain(ImuAhrs *ahrs) {
+    uint32_t tail = ahrs->ring_tail;
+    uint32_t head = __atomic_load_n(&ahrs->ring_head, __ATOMIC_ACQUIRE);
+    if (tail == head) {
+        return;
+    }
+
+    imu_ahrs_set_scales(ahrs, ahrs->ring_odr_hz);
+    float mx, my, mz;
+    bool mag_valid = imu_ahrs_read_mag(ahrs, &mx, &my, &mz);
+
+    uint32_t steps = head - tail;
+    for (; tail != head; tail++) {
+        const icm20948_fifo_sample_t *s = &ahrs->ring[tail & (IMU_AHRS_RING_SIZE - 1)];
+        imu_ahrs_update_marg(ahrs,
+                             s->gyro[0] * ahrs->gyro_scale, s->gyro[1] * ahrs->gyro_scale, s->gyro[2] * ahrs->gyro_scale,
+                             s->accel[0] * ahrs->accel_scale, s->accel[1] * ahrs->accel_scale, s->accel[2] * ahrs->accel_scale,
+                             mx, my, mz);
+    }
+    __atomic_store_n(&ahrs->ring_tail, tail, __ATOMIC_RELEASE);
+    imu_ahrs_publish(ahrs, steps, mag_valid);
+}
+
+/**
+ * @brief Filter task: follow the FIFO batches, or poll at poll_hz when it isn't running
+ */
+static void imu_ahrs_task(void *arg) {
+    ImuAhrs *ahrs = (ImuAhrs *)arg;
+    TickType_t period = pdMS_TO_TICKS(1000 / ahrs->cfg.poll_hz);
+    if (period == 0) period = 1;
+    TickType_t last_wake = xTaskGetTickCount();
+    bool polling = false;
+
+    while (ahrs->running) {
+        if (imu_fifo_is_running(ahrs->fifo) || ahrs->dev->parked) {
+            // Parked means still: nothing to integrate until the FIFO restarts
+            polling = false;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMU_AHRS_WAIT_MS));
+            if (ahrs->running) {
+                imu_ahrs_drain(ahrs);
+            }
+            continue;
+        }
+
+        if (!polling) {
+            polling = true;
+            last_wake = xTaskGetTickCount();
+            imu_ahrs_set_scales(ahrs, 1000.0f / (period * portTICK_PERIOD_MS));
+        }
+        xTaskDelayUntil(&last_wake, period);
+
+        icm20948_raw_sample_t raw;
+        if (!ahrs->running || icm20948_read_raw(ahrs->dev, &raw) != ESP_OK) {
+            continue;
+        }
+        // Calibrated uT, or all zero (gyro/accel-only step) when overflowed or stale
+        float m[3] = {0.0f, 0.0f, 0.0f};
+        if (icm20948_mag_convert(ahrs->dev, &raw, m, true) != ESP_OK) {
+            m[0] = m[1] = m[2] = 0.0f;
+        }
+        float mx = m[0];
+        float my = -m[1];
+        float mz = -m[2];
+        imu_ahrs_update_marg(ahrs,
+                             raw.gyro[0] * ahrs->gyro_scale, raw.gyro[1] * ahrs->gyro_scale, raw.gyro[2] * ahrs->gyro_scale,
+                             raw.accel[0] * ahrs->accel_scale, raw.accel[1] * ahrs->accel_scale, raw.accel[2] * ahrs->accel_scale,
+                             mx, my, mz);
+        imu_ahrs_publish(ahrs, 1, !(mx == 0.0f && my == 0.0f && mz == 0.0f));
+    }
+
+    task_stop_exit(&ahrs->stop);
+}
+
+/**
+ * @brief Create the filter and subscribe it to the FIFO (fifo may be NULL)
+ */
+ImuAhrs *imu_ahrs_create(ICM20948_t *dev, ImuFifo *fifo, const imu_ahrs_config_t *config) {
+    if (dev == NULL || config == NULL || config->poll_hz == 0) {
+        return NULL;
+    }
+    ImuAhrs *ahrs = (ImuAhrs *)calloc(1, sizeof(ImuAhrs));
+    if (ahrs == NULL) {
+        return NULL;
+    }
+    task_stop_init(&ahrs->stop);
+    ahrs->dev = dev;
+    ahrs->fifo = fifo;
+    ahrs->cfg = *config;
+    ahrs->q[0] = 1.0f;
+    if (fifo != NULL && imu_fifo_subscribe(fifo, imu_ahrs_on_block, ahrs) != ESP_OK) {
+        ESP_LOGW(TAG, "Could not subscribe to the FIFO, polling at %lu Hz", config->poll_hz);
+        ahrs->fifo = NULL;
+    }
+    return ahrs;
+}
+
+/**
+ * @brief Destroy the filter
+ */
+void imu_ahrs_destroy(ImuAhrs *ahrs) {
+    if (ahrs == NULL) return;
+    imu_ahrs_stop(ahrs);
+    free(ahrs);
+}
+
+/**
+ * @brief Start the filter task
+ */
+esp_err_t imu_ahrs_start(ImuAhrs *ahrs, UBaseType_t priority) {
+    if (ahrs == NULL) return ESP_ERR_INVALID_ARG;
+    if (ahrs->running) return ESP_OK;
+
+    // Drop anything queued while stopped, the orientation carries on from where it was
+    __atomic_store_n(&ahrs->ring_tail, ahrs->ring_head, __ATOMIC_RELEASE);
+    ahrs->running = true;
+    if (xTaskCreate(imu_ahrs_task, "imu_ahrs", 4096, ahrs, priority, &ahrs->task) != pdPASS) {
+        ahrs->running = false;
+        ESP_LOGE(TAG, "Failed to create AHRS task");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "AHRS started (beta %.2f, %s)", ahrs->cfg.beta,
+             ahrs->fifo ? "FIFO rate" : "polled");
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop the filter task
+ */
+void imu_ahrs_stop(ImuAhrs *ahrs) {
+    if (ahrs == NULL || !ahrs->running) return;
+    ahrs->running = false;
+    task_stop_join(&ahrs->stop, &ahrs->task);
+}
+
+/**
+ * @brief Copy the latest orientation (lock-free, safe from any task)
+ */
+bool imu_ahrs_get(const ImuAhrs *ahrs, imu_ahrs_state_t *out) {
+    if (ahrs == NULL) {
+        return false;
+    }
+    for (int spins = 0; ; spins++) {
+        uint32_t s1 = __atomic_load_n(&ahrs->seq, __ATOMIC_ACQUIRE);
+        if ((s1 & 1) == 0) {
+            memcpy(out, &ahrs->state, sizeof(*out));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&ahrs->seq, __ATOMIC_RELAXED) == s1) {
+                break;
+            }
+        }
+        // The writer may be preempted mid-update on this core: let it finish
+        if (spins >= IMU_AHRS_READ_SPINS) {
+            vTaskDelay(1);
+        }
+    }
+    return out->updates > 0;
+}
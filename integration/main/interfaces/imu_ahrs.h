@@ -0,0 +1,101 @@
+#ifndef IMU_AHRS_H
+#define IMU_AHRS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "imu.h"
+#include "imu_fifo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_AHRS_RING_SIZE 64   // FIFO samples queued for the filter task (power of two)
+
+/**
+ * @brief Latest orientation
+ */
+typedef struct {
+    float q[4];                /**< w, x, y, z (sensor frame to earth frame) */
+    float heading_deg;         /**< 0-360, magnetic */
+    float pitch_deg;
+    float roll_deg;
+    int64_t t_us;              /**< esp_timer time of the update */
+    uint32_t updates;          /**< Filter steps since start, 0 = no estimate yet */
+    bool mag_valid;            /**< Heading is mag-referenced (else gyro-only drift) */
+} imu_ahrs_state_t;
+
+/**
+ * @brief Filter tuning
+ */
+typedef struct {
+    float beta;                /**< Madgwick gain: higher trusts accel/mag more than the gyro */
+    uint32_t poll_hz;          /**< Fixed update rate when the FIFO isn't running */
+} imu_ahrs_config_t;
+
+/**
+ * @brief Madgwick MARG filter fed from the FIFO (or a fixed-rate poll without it)
+ *
+ * The task is the only writer of the state; readers use a sequence lock and never block it.
+ */
+typedef struct ImuAhrs {
+    ICM20948_t *dev;
+    ImuFifo *fifo;
+    imu_ahrs_config_t cfg;
+
+    // FIFO samples, filled in the FIFO task, drained by the filter task
+    icm20948_fifo_sample_t ring[IMU_AHRS_RING_SIZE];
+    volatile uint32_t ring_head;
+    volatile uint32_t ring_tail;
+    volatile uint32_t ring_dropped;
+    volatile float ring_odr_hz;
+
+    // Filter state (task only)
+    float q[4];
+    float dt;                  // precomputed 1 / rate
+    float accel_scale;         // LSB -> g
+    float gyro_scale;          // LSB -> rad/s
+
+    // Published state
+    volatile uint32_t seq;     // odd while the task is writing
+    imu_ahrs_state_t state;
+
+    TaskHandle_t task;
+    TaskStop stop;
+    volatile bool running;
+} ImuAhrs;
+
+/**
+ * @brief Create the filter and subscribe it to the FIFO (fifo may be NULL)
+ */
+ImuAhrs *imu_ahrs_create(ICM20948_t *dev, ImuFifo *fifo, const imu_ahrs_config_t *config);
+
+/**
+ * @brief Destroy the filter
+ */
+void imu_ahrs_destroy(ImuAhrs *ahrs);
+
+/**
+ * @brief Start the filter task
+ */
+esp_err_t imu_ahrs_start(ImuAhrs *ahrs, UBaseType_t priority);
+
+/**
+ * @brief Stop the filter task
+ */
+void imu_ahrs_stop(ImuAhrs *ahrs);
+
+/**
+ * @brief Copy the latest orientation (lock-free, safe from any task)
+ *
+ * @return false if there is no estimate yet
+ */
+bool imu_ahrs_get(const ImuAhrs *ahrs, imu_ahrs_state_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_AHRS_H
@@ -0,0 +1,198 @@
+#include "imu_alert.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <math.h>
+
+static const char *TAG = "IMU_ALERT";
+
+#define IMU_ALERT_TIP_HYST_DEG  5.0f     // Back this far under tip_deg before another tip
+#define IMU_ALERT_WAIT_MS       200      // Alert task re-checks running this often
+#define IMU_ALERT_DEG_TO_RAD    0.017453292f
+#define IMU_ALERT_RAD_TO_DEG    57.29578f
+
+/**
+ * @brief Queue an alert for the alert task unless its type is cooling down
+ */
+static void imu_alert_fire(ImuAlert *alert, imu_alert_type_t type, float value, int64_t t_us) {
+    if (!alert->running) {
+        return;
+    }
+    if (alert->last_us[type] != 0 &&
+        t_us - alert->last_us[type] < (int64_t)alert->cfg.cooldown_ms * 1000) {
+        return;
+    }
+    alert->last_us[type] = t_us;
+    alert->counts[type]++;
+    imu_alert_t a = { .type = type, .value = value, .t_us = t_us };
+    if (xQueueSend(alert->queue, &a, 0) != pdTRUE) {
+        alert->dropped++;
+    }
+}
+
+/**
+ * @brief FIFO subscriber: run the three detectors on every sample of the block
+ */
+static void imu_alert_on_block(void *ctx, const imu_fifo_block_t *blk) {
+    ImuAlert *alert = (ImuAlert *)ctx;
+    ImuLevel *level = alert->level;
+    if (blk->count == 0 || !imu_level_has_block(level, blk)) {
+        return;
+    }
+    if (level->gap) {
+        alert->lift_g = 0.0f;      // restart or overflow: don't average across the gap
+    }
+
+    const imu_alert_config_t *c = &alert->cfg;
+    float dt = 1.0f / blk->odr_hz;
+    float lift_alpha = c->lift_ms ? fminf(dt * 1000.0f / c->lift_ms, 1.0f) : 1.0f;
+    float rest_g = imu_level_rest_g(level);
+    int64_t sample_us = (int64_t)(1000000.0f * dt);
+    int64_t t_us = blk->t_us - (int64_t)(blk->count - 1) * sample_us;
+    int64_t tip_us = (int64_t)c->tip_ms * 1000;
+
+    for (uint16_t i = 0; i < blk->count; i++, t_us += sample_us) {
+        // Impact: one sample far from the resting magnitude
+        float dev = level->mag_g[i] - rest_g;
+        if (fabsf(dev) > c->impact_g) {
+            imu_alert_fire(alert, IMU_ALERT_IMPACT, dev, t_us);
+        }
+
+        if (!level->ref_valid) {
+            alert->tipped = false;
+            alert->tip_since_us = 0;
+            alert->lift_g = 0.0f;
+            continue;
+        }
+
+        // Tip: low-passed gravity away from the level reference for tip_ms
+        float cos_a = level->cos_tilt[i];
+        if (cos_a < alert->cos_tip) {
+            if (alert->tip_since_us == 0) {
+                alert->tip_since_us = t_us;
+            }
+            if (!alert->tipped && t_us - alert->tip_since_us >= tip_us) {
+                alert->tipped = true;
+                imu_alert_fire(alert, IMU_ALERT_TIP, acosf(fmaxf(cos_a, -1.0f)) * IMU_ALERT_RAD_TO_DEG, t_us);
+            }
+        } else if (cos_a > alert->cos_rearm) {
+            alert->tip_since_us = 0;
+            alert->tipped = false;
+        }
+
+        // Lift: acceleration along the level "up" beyond gravity, averaged over lift_ms
+        alert->lift_g += (level->up_g[i] - alert->lift_g) * lift_alpha;
+        if (alert->lift_g > c->lift_g) {
+            imu_alert_fire(alert, IMU_ALERT_LIFT, alert->lift_g, t_us);
+        }
+    }
+}
+
+/**
+ * @brief Alert task: deliver queued alerts as soon as they are detected
+ */
+static void imu_alert_task(void *arg) {
+    ImuAlert *alert = (ImuAlert *)arg;
+    imu_alert_t a;
+
+    while (alert->running) {
+        if (xQueueReceive(alert->queue, &a, pdMS_TO_TICKS(IMU_ALERT_WAIT_MS)) != pdTRUE) {
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        a.latency_us = (uint32_t)(now - a.t_us);
+        if (a.latency_us > alert->latency_us_max) {
+            alert->latency_us_max = a.latency_us;
+        }
+        ESP_LOGW(TAG, "%s %.2f (%lu us after the sample)", imu_alert_str(a.type), a.value, a.latency_us);
+        if (alert->cb) {
+            alert->cb(alert->ctx, &a);
+        }
+    }
+
+    task_stop_exit(&alert->stop);
+}
+
+/**
+ * @brief Create the detector and subscribe it to the FIFO (after the level tracker, before the FIFO starts)
+ */
+ImuAlert *imu_alert_create(ImuFifo *fifo, ImuLevel *level, const imu_alert_config_t *config,
+                           imu_alert_cb_t cb, void *ctx) {
+    if (fifo == NULL || level == NULL || config == NULL || config->tip_deg <= IMU_ALERT_TIP_HYST_DEG ||
+        config->lift_g <= 0.0f || config->impact_g <= 0.0f) {
+        return NULL;
+    }
+    ImuAlert *alert = (ImuAlert *)calloc(1, sizeof(ImuAlert));
+    if (alert == NULL) {
+        return NULL;
+    }
+    task_stop_init(&alert->stop);
+    alert->level = level;
+    alert->cfg = *config;
+    alert->cb = cb;
+    alert->ctx = ctx;
+    alert->cos_tip = cosf(config->tip_deg * IMU_ALERT_DEG_TO_RAD);
+    alert->cos_rearm = cosf((config->tip_deg - IMU_ALERT_TIP_HYST_DEG) * IMU_ALERT_DEG_TO_RAD);
+    alert->queue = xQueueCreate(IMU_ALERT_QUEUE_LEN, sizeof(imu_alert_t));
+    if (alert->queue == NULL) {
+        free(alert);
+        return NULL;
+    }
+    if (imu_fifo_subscribe(fifo, imu_alert_on_block, alert) != ESP_OK) {
+        ESP_LOGE(TAG, "Could not subscribe to the IMU FIFO");
+        vQueueDelete(alert->queue);
+        free(alert);
+        return NULL;
+    }
+    return alert;
+}
+
+/**
+ * @brief Destroy the detector (only with the FIFO, which has no unsubscribe)
+ */
+void imu_alert_destroy(ImuAlert *alert) {
+    if (alert == NULL) return;
+    imu_alert_stop(alert);
+    vQueueDelete(alert->queue);
+    free(alert);
+}
+
+/**
+ * @brief Start the alert task (detection runs whenever the FIFO does)
+ */
+esp_err_t imu_alert_start(ImuAlert *alert, UBaseType_t priority) {
+    if (alert == NULL) return ESP_ERR_INVALID_ARG;
+    if (alert->running) return ESP_OK;
+
+    xQueueReset(alert->queue);
+    alert->running = true;
+    if (xTaskCreate(imu_alert_task, "imu_alert", 3072, alert, priority, &alert->task) != pdPASS) {
+        alert->running = false;
+        ESP_LOGE(TAG, "Failed to create alert task");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Alerts on (tip %.0f deg, lift %.2f g, impact %.1f g)",
+             alert->cfg.tip_deg, alert->cfg.lift_g, alert->cfg.impact_g);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop the alert task (alerts detected meanwhile are dropped)
+ */
+void imu_alert_stop(ImuAlert *alert) {
+    if (alert == NULL || !alert->running) return;
+    alert->running = false;
+    task_stop_join(&alert->stop, &alert->task);
+}
+
+/**
+ * @brief Alert name for logs and BLE
+ */
+const char *imu_alert_str(imu_alert_type_t type) {
+    switch (type) {
+        case IMU_ALERT_TIP:    return "TIP";
+        case IMU_ALERT_LIFT:   return "LIFT";
+        case IMU_ALERT_IMPACT: return "IMPACT";
+        default:               return "UNKNOWN";
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef IMU_ALERT_H
+#define IMU_ALERT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "imu.h"
+#include "imu_fifo.h"
+#include "imu_level.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_ALERT_QUEUE_LEN 8   // Alerts waiting for the alert task
+
+/**
+ * @brief Safety/theft events
+ */
+typedef enum {
+    IMU_ALERT_TIP = 0,         /**< Gravity swung past tip_deg from level and stayed there */
+    IMU_ALERT_LIFT,            /**< Sustained upward acceleration */
+    IMU_ALERT_IMPACT,          /**< Single-sample |accel| spike */
+} imu_alert_type_t;
+
+/**
+ * @brief One alert, as handed to the callback
+ */
+typedef struct {
+    imu_alert_type_t type;
+    float value;               /**< Tilt in degrees (TIP) or g (LIFT, IMPACT) */
+    int64_t t_us;              /**< esp_timer time of the sample that triggered it */
+    uint32_t latency_us;       /**< Trigger sample to callback */
+} imu_alert_t;
+
+/**
+ * @brief Alert callback, runs in the alert task (never in the FIFO task)
+ */
+typedef void (*imu_alert_cb_t)(void *ctx, const imu_alert_t *alert);
+
+/**
+ * @brief Detector thresholds
+ */
+typedef struct {
+    float tip_deg;             /**< Tilt from the level reference counted as tipped */
+    uint32_t tip_ms;           /**< for at least this long */
+    float lift_g;              /**< Upward accel (gravity removed) counted as a lift */
+    uint32_t lift_ms;          /**< averaged over this long */
+    float impact_g;            /**< |accel| this far from its resting value in one sample */
+    uint32_t cooldown_ms;      /**< Quiet time per alert type after it fires */
+} imu_alert_config_t;
+
+/**
+ * @brief Per-sample tip/lift/impact detector on the FIFO blocks
+ *
+ * Tilt and vertical acceleration come from the shared ImuLevel reference.
+ * Detection runs inline in the FIFO subscriber (a few compares per sample);
+ * alerts are queued to a dedicated high-priority task so BLE delivery never
+ * waits on the main loop, the command handler or the FIFO task.
+ */
+typedef struct ImuAlert {
+    imu_alert_config_t cfg;
+    imu_alert_cb_t cb;
+    void *ctx;
+    ImuLevel *level;
+
+    // Detector (FIFO task only)
+    float cos_tip;             // cos(tip_deg), and with hysteresis, so the hot path has no acos
+    float cos_rearm;
+    float lift_g;              // vertical accel along ref minus 1 g, averaged over lift_ms
+    int64_t tip_since_us;      // first sample past tip_deg, 0 if level
+    bool tipped;
+    int64_t last_us[3];        // last alert per type (cooldown)
+
+    // Stats
+    uint32_t counts[3];
+    uint32_t dropped;
+    uint32_t latency_us_max;
+
+    QueueHandle_t queue;
+    TaskHandle_t task;
+    TaskStop stop;
+    volatile bool running;
+} ImuAlert;
+
+/**
+ * @brief Create the detector and subscribe it to the FIFO (after the level tracker, before the FIFO starts)
+ */
+ImuAlert *imu_alert_create(ImuFifo *fifo, ImuLevel *level, const imu_alert_config_t *config,
+                           imu_alert_cb_t cb, void *ctx);
+
+/**
+ * @brief Destroy the detector (only with the FIFO, which has no unsubscribe)
+ */
+void imu_alert_destroy(ImuAlert *alert);
+
+/**
+ * @brief Start the alert task (detection runs whenever the FIFO does)
+ */
+esp_err_t imu_alert_start(ImuAlert *alert, UBaseType_t priority);
+
+/**
+ * @brief Stop the alert task (alerts detected meanwhile are dropped)
+ */
+void imu_alert_stop(ImuAlert *alert);
+
+/**
+ * @brief Alert name for logs and BLE
+ */
+const char *imu_alert_str(imu_alert_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_ALERT_H
@@ -0,0 +1,291 @@
+#include "imu_classifier.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_dsp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "IMU_CLASS";
+
+#define IMU_CLASS_LIFT_AVG_S     0.16f   // Vertical accel averaging (rejects bumps and wheel vibration)
+#define IMU_CLASS_SPIKE_RATIO    4.0f    // Jerk peak / RMS above this is an isolated impact
+#define IMU_CLASS_RAD_TO_DEG     57.29578f
+
+static portMUX_TYPE class_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Whether a window/hop pair fits the buffers and the FFT
+ */
+bool imu_classifier_config_valid(const imu_class_config_t *config) {
+    uint32_t w = config->window;
+    return w >= IMU_CLASS_MIN_WINDOW && w <= IMU_CLASS_MAX_WINDOW && (w & (w - 1)) == 0 &&
+           config->hop > 0 && config->hop <= w;
+}
+
+/**
+ * @brief Spectral energy of the FFT bins covering [f_lo, f_hi) Hz
+ */
+static float imu_classifier_band(const ImuClassifier *clf, int n, float f_lo, float f_hi) {
+    int k0 = (int)ceilf(f_lo * n / clf->odr_hz);
+    int k1 = (int)ceilf(f_hi * n / clf->odr_hz);
+    if (k0 < 1) k0 = 1;
+    if (k1 > n / 2) k1 = n / 2;
+    if (k1 <= k0) {
+        return 0.0f;
+    }
+    // Bins are interleaved re, im: a contiguous dot product gives sum(re^2 + im^2)
+    float e = 0.0f;
+    dsps_dotprod_f32(&clf->fft[2 * k0], &clf->fft[2 * k0], &e, 2 * (k1 - k0));
+    return e * 2.0f / ((float)n * n);
+}
+
+/**
+ * @brief Features and class for the current (full) window
+ */
+static void imu_classifier_window(ImuClassifier *clf) {
+    uint32_t cycles0 = esp_cpu_get_cycle_count();
+    int64_t us0 = esp_timer_get_time();
+
+    const int n = clf->cfg.window;
+    const float inv_n = 1.0f / n;
+    imu_class_features_t f = { .window = n };
+
+    // |accel| mean and variance
+    float sum = 0.0f, ss = 0.0f;
+    dsps_dotprod_f32(clf->amag, clf->ones, &sum, n);
+    f.mean_g = sum * inv_n;
+    dsps_addc_f32(clf->amag, clf->work, n, -f.mean_g, 1, 1);
+    dsps_dotprod_f32(clf->work, clf->work, &ss, n);
+    f.var_g2 = ss * inv_n;
+
+    dsps_dotprod_f32(clf->gmag, clf->gmag, &ss, n);
+    f.gyro_rms_dps = sqrtf(ss * inv_n);
+
+    // Spectrum of the mean-removed |accel|, Hann windowed straight into the real slots
+    memset(clf->fft, 0, 2 * n * sizeof(float));
+    dsps_mul_f32(clf->work, clf->hann, clf->fft, n, 1, 1, 2);
+    dsps_fft2r_fc32(clf->fft, n);
+    dsps_bit_rev_fc32(clf->fft, n);
+    f.band_low = imu_classifier_band(clf, n, 0.5f, 3.0f);
+    f.band_mid = imu_classifier_band(clf, n, 3.0f, 10.0f);
+    f.band_high = imu_classifier_band(clf, n, 10.0f, clf->odr_hz * 0.5f);
+
+    // Jerk from the first difference
+    dsps_sub_f32(&clf->amag[1], clf->amag, clf->work, n - 1, 1, 1, 1);
+    dsps_dotprod_f32(clf->work, clf->work, &ss, n - 1);
+    f.jerk_rms_gps = sqrtf(ss / (n - 1)) * clf->odr_hz;
+    float peak = 0.0f;
+    for (int i = 0; i < n - 1; i++) {
+        float d = fabsf(clf->work[i]);
+        if (d > peak) peak = d;
+    }
+    f.jerk_peak_gps = peak * clf->odr_hz;
+
+    // Mean tilt against the shared level reference
+    bool level_valid = clf->level->ref_valid;
+    if (level_valid) {
+        float c = 0.0f;
+        dsps_dotprod_f32(clf->cos_tilt, clf->ones, &c, n);
+        f.tilt_deg = acosf(fmaxf(-1.0f, fminf(1.0f, c * inv_n))) * IMU_CLASS_RAD_TO_DEG;
+    }
+
+    // Vertical accel beyond resting gravity (from the level reference), short average
+    int len = (int)(IMU_CLASS_LIFT_AVG_S * clf->odr_hz);
+    if (len < 1) len = 1;
+    if (len > n) len = n;
+    float run = 0.0f;
+    for (int i = 0; i < n; i++) {
+        run += clf->up_g[i];
+        if (i >= len) run -= clf->up_g[i - len];
+        if (i >= len - 1) {
+            float dev = fabsf(run / len);
+            if (dev > f.lift_g) f.lift_g = dev;
+        }
+    }
+
+    // Most specific first: a lifted or tipped cart is also moving
+    const imu_class_config_t *c = &clf->cfg;
+    if (level_valid && f.tilt_deg > c->tilt_deg) {
+        f.cls = IMU_CLASS_TILTED;
+    } else if (f.lift_g > c->lift_g && f.band_high < f.band_low + f.band_mid) {
+        f.cls = IMU_CLASS_LIFTED;
+    } else if (f.jerk_peak_gps > c->bump_jerk_gps && f.jerk_peak_gps > IMU_CLASS_SPIKE_RATIO * f.jerk_rms_gps) {
+        f.cls = IMU_CLASS_BUMPED;
+    } else if (f.var_g2 > c->push_var_g2 || f.gyro_rms_dps > c->push_gyro_dps) {
+        f.cls = IMU_CLASS_PUSHED;
+    } else {
+        f.cls = IMU_CLASS_PARKED;
+    }
+
+    f.cpu_cycles = esp_cpu_get_cycle_count() - cycles0;
+    f.cpu_us = (uint32_t)(esp_timer_get_time() - us0);
+
+    portENTER_CRITICAL(&class_spinlock);
+    clf->cpu_us_avg += (f.cpu_us - clf->cpu_us_avg) * (clf->last.seq ? 0.0625f : 1.0f);
+    if (f.cpu_us > clf->cpu_us_max) clf->cpu_us_max = f.cpu_us;
+    f.cpu_us_avg = clf->cpu_us_avg;
+    f.cpu_us_max = clf->cpu_us_max;
+    f.seq = clf->last.seq + 1;
+    clf->last = f;
+    portEXIT_CRITICAL(&class_spinlock);
+
+    if (f.cls != clf->cls) {
+        clf->cls = f.cls;
+        if (clf->cb) {
+            clf->cb(clf->ctx, f.cls, &f);
+        }
+    }
+}
+
+/**
+ * @brief Apply a new window/hop (FIFO task)
+ */
+static void imu_classifier_apply(ImuClassifier *clf, const imu_class_config_t *config) {
+    clf->cfg = *config;
+    clf->filled = 0;
+    if (clf->hann_len != config->window) {
+        dsps_wind_hann_f32(clf->hann, config->window);
+        clf->hann_len = config->window;
+    }
+}
+
+/**
+ * @brief FIFO subscriber: append the block, classify each time a hop's worth has arrived
+ */
+static void imu_classifier_on_block(void *ctx, const imu_fifo_block_t *blk) {
+    ImuClassifier *clf = (ImuClassifier *)ctx;
+
+    if (clf->reconfigure) {
+        imu_class_config_t cfg;
+        portENTER_CRITICAL(&class_spinlock);
+        cfg = clf->pending;
+        clf->reconfigure = false;
+        portEXIT_CRITICAL(&class_spinlock);
+        imu_classifier_apply(clf, &cfg);
+    }
+
+    const ImuLevel *level = clf->level;
+    if (!imu_level_has_block(level, blk)) {
+        return;
+    }
+
+    // A rate change mid-window would smear the spectrum: start over
+    if (blk->odr_hz != clf->odr_hz) {
+        clf->odr_hz = blk->odr_hz;
+        clf->filled = 0;
+    }
+
+    float inv_dps = 1.0f / blk->gyro_lsb_per_dps;
+    const uint32_t n = clf->cfg.window;
+
+    for (uint16_t i = 0; i < blk->count; i++) {
+        const icm20948_fifo_sample_t *s = &blk->samples[i];
+        uint32_t k = clf->filled++;
+        clf->cos_tilt[k] = level->cos_tilt[i];
+        clf->up_g[k] = level->up_g[i];
+        clf->amag[k] = level->mag_g[i];
+        float gx = s->gyro[0] * inv_dps, gy = s->gyro[1] * inv_dps, gz = s->gyro[2] * inv_dps;
+        clf->gmag[k] = sqrtf(gx * gx + gy * gy + gz * gz);
+
+        if (clf->filled == n) {
+            imu_classifier_window(clf);
+
+            // Slide by one hop
+            uint32_t keep = n - clf->cfg.hop;
+            size_t shift = clf->cfg.hop * sizeof(float);
+            memmove(clf->cos_tilt, (uint8_t *)clf->cos_tilt + shift, keep * sizeof(float));
+            memmove(clf->up_g, (uint8_t *)clf->up_g + shift, keep * sizeof(float));
+            memmove(clf->amag, (uint8_t *)clf->amag + shift, keep * sizeof(float));
+            memmove(clf->gmag, (uint8_t *)clf->gmag + shift, keep * sizeof(float));
+            clf->filled = keep;
+        }
+    }
+}
+
+/**
+ * @brief Create the classifier and subscribe it to the FIFO (after the level tracker, before the FIFO starts)
+ */
+ImuClassifier *imu_classifier_create(ImuFifo *fifo, ImuLevel *level, const imu_class_config_t *config,
+                                     imu_class_cb_t cb, void *ctx) {
+    if (fifo == NULL || level == NULL || config == NULL || !imu_classifier_config_valid(config)) {
+        return NULL;
+    }
+
+    // One table for every window size up to the maximum (shared with any other esp-dsp FFT user)
+    esp_err_t ret = dsps_fft2r_init_fc32(NULL, IMU_CLASS_MAX_WINDOW);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "FFT init failed: %s", esp_err_to_name(ret));
+        return NULL;
+    }
+
+    ImuClassifier *clf = (ImuClassifier *)calloc(1, sizeof(ImuClassifier));
+    if (clf == NULL) {
+        return NULL;
+    }
+    clf->level = level;
+    clf->cb = cb;
+    clf->ctx = ctx;
+    clf->cls = IMU_CLASS_PARKED;
+    for (int i = 0; i < IMU_CLASS_MAX_WINDOW; i++) {
+        clf->ones[i] = 1.0f;
+    }
+    imu_classifier_apply(clf, config);
+
+    if (imu_fifo_subscribe(fifo, imu_classifier_on_block, clf) != ESP_OK) {
+        ESP_LOGE(TAG, "Could not subscribe to the IMU FIFO");
+        free(clf);
+        return NULL;
+    }
+    ESP_LOGI(TAG, "Classifying %lu-sample windows every %lu samples", config->window, config->hop);
+    return clf;
+}
+
+/**
+ * @brief Destroy the classifier (only with the FIFO, which has no unsubscribe)
+ */
+void imu_classifier_destroy(ImuClassifier *clf) {
+    free(clf);
+}
+
+/**
+ * @brief Change the window/hop and thresholds (restarts the window)
+ */
+esp_err_t imu_classifier_configure(ImuClassifier *clf, const imu_class_config_t *config) {
+    if (clf == NULL || config == NULL || !imu_classifier_config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&class_spinlock);
+    clf->pending = *config;
+    clf->reconfigure = true;
+    portEXIT_CRITICAL(&class_spinlock);
+    return ESP_OK;
+}
+
+/**
+ * @brief Copy the latest window's features
+ */
+bool imu_classifier_get(const ImuClassifier *clf, imu_class_features_t *out) {
+    if (clf == NULL || out == NULL) {
+        return false;
+    }
+    portENTER_CRITICAL(&class_spinlock);
+    *out = clf->last;
+    portEXIT_CRITICAL(&class_spinlock);
+    return out->seq > 0;
+}
+
+/**
+ * @brief Class name for logs and BLE
+ */
+const char *imu_class_str(imu_class_t cls) {
+    switch (cls) {
+        case IMU_CLASS_PARKED: return "PARKED";
+        case IMU_CLASS_PUSHED: return "PUSHED";
+        case IMU_CLASS_BUMPED: return "BUMPED";
+        case IMU_CLASS_LIFTED: return "LIFTED";
+        case IMU_CLASS_TILTED: return "TILTED";
+        default: return "UNKNOWN";
+    }
+}
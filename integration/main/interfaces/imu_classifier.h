@@ -0,0 +1,144 @@
+#ifndef IMU_CLASSIFIER_H
+#define IMU_CLASSIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "imu.h"
+#include "imu_fifo.h"
+#include "imu_level.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_CLASS_MAX_WINDOW 256   // Longest window in samples (power of two, sizes the FFT tables)
+#define IMU_CLASS_MIN_WINDOW 32
+
+/**
+ * @brief What the cart is doing over one window
+ */
+typedef enum {
+    IMU_CLASS_PARKED = 0,      /**< Still */
+    IMU_CLASS_PUSHED,          /**< Rolling: steady low/mid band energy */
+    IMU_CLASS_BUMPED,          /**< Short impact: jerk spike, high band energy */
+    IMU_CLASS_LIFTED,          /**< Sustained vertical acceleration */
+    IMU_CLASS_TILTED,          /**< Gravity off the level reference */
+} imu_class_t;
+
+/**
+ * @brief Window features (and what they cost to compute)
+ */
+typedef struct {
+    imu_class_t cls;
+    float mean_g;              /**< Mean |accel| */
+    float var_g2;              /**< Variance of |accel| */
+    float gyro_rms_dps;
+    float jerk_rms_gps;        /**< RMS of d|accel|/dt, g/s */
+    float jerk_peak_gps;
+    float band_low;            /**< |accel| spectral energy 0.5-3 Hz (push cadence) */
+    float band_mid;            /**< 3-10 Hz (wheel/floor vibration) */
+    float band_high;           /**< 10 Hz-Nyquist (impacts) */
+    float lift_g;              /**< Peak ~160 ms average of vertical accel minus resting gravity */
+    float tilt_deg;            /**< Mean tilt vs the level reference (0 until there is one) */
+    uint32_t cpu_cycles;       /**< Feature + classify cost for this window */
+    uint32_t cpu_us;
+    uint32_t window;           /**< Samples in the window */
+    uint32_t seq;              /**< Windows classified since start */
+    float cpu_us_avg;          /**< Running average cost per window */
+    uint32_t cpu_us_max;
+} imu_class_features_t;
+
+/**
+ * @brief Class change callback, runs in the FIFO task
+ */
+typedef void (*imu_class_cb_t)(void *ctx, imu_class_t cls, const imu_class_features_t *f);
+
+/**
+ * @brief Window length and class thresholds
+ */
+typedef struct {
+    uint32_t window;           /**< Samples per window (power of two, IMU_CLASS_MIN_WINDOW..IMU_CLASS_MAX_WINDOW) */
+    uint32_t hop;              /**< Samples between windows (window / 2 = 50% overlap) */
+    float push_var_g2;         /**< |accel| variance above this is rolling */
+    float push_gyro_dps;       /**< or gyro RMS above this */
+    float bump_jerk_gps;       /**< Jerk peak above this is an impact */
+    float lift_g;              /**< Sustained vertical accel above this is a lift */
+    float tilt_deg;            /**< Gravity this far off the level reference is a tilt */
+} imu_class_config_t;
+
+/**
+ * @brief Sliding-window motion classifier on the FIFO blocks (esp-dsp kernels)
+ *
+ * Tilt and vertical acceleration come from the shared ImuLevel reference.
+ */
+typedef struct ImuClassifier {
+    imu_class_config_t cfg;
+    imu_class_cb_t cb;
+    void *ctx;
+    ImuLevel *level;
+
+    // Window (FIFO task only), oldest sample first
+    float cos_tilt[IMU_CLASS_MAX_WINDOW];       // from the level tracker
+    float up_g[IMU_CLASS_MAX_WINDOW];
+    float amag[IMU_CLASS_MAX_WINDOW];
+    float gmag[IMU_CLASS_MAX_WINDOW];
+    uint32_t filled;
+    float odr_hz;
+
+    // Scratch and precomputed tables
+    float work[IMU_CLASS_MAX_WINDOW];
+    float fft[2 * IMU_CLASS_MAX_WINDOW];        // interleaved re, im
+    float hann[IMU_CLASS_MAX_WINDOW];
+    float ones[IMU_CLASS_MAX_WINDOW];
+    uint32_t hann_len;
+
+    // Published result
+    imu_class_features_t last;
+    imu_class_t cls;
+    uint32_t cpu_us_max;
+    float cpu_us_avg;
+
+    // New window/thresholds, picked up by the FIFO task at the next block
+    imu_class_config_t pending;
+    volatile bool reconfigure;
+} ImuClassifier;
+
+/**
+ * @brief Create the classifier and subscribe it to the FIFO (after the level tracker, before the FIFO starts)
+ */
+ImuClassifier *imu_classifier_create(ImuFifo *fifo, ImuLevel *level, const imu_class_config_t *config,
+                                     imu_class_cb_t cb, void *ctx);
+
+/**
+ * @brief Destroy the classifier (only with the FIFO, which has no unsubscribe)
+ */
+void imu_classifier_destroy(ImuClassifier *clf);
+
+/**
+ * @brief Whether a window/hop pair fits the buffers and the FFT
+ */
+bool imu_classifier_config_valid(const imu_class_config_t *config);
+
+/**
+ * @brief Change the window/hop and thresholds (restarts the window)
+ */
+esp_err_t imu_classifier_configure(ImuClassifier *clf, const imu_class_config_t *config);
+
+/**
+ * @brief Copy the latest window's features
+ *
+ * @return false if no window has been classified yet
+ */
+bool imu_classifier_get(const ImuClassifier *clf, imu_class_features_t *out);
+
+/**
+ * @brief Class name for logs and BLE
+ */
+const char *imu_class_str(imu_class_t cls);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_CLASSIFIER_H
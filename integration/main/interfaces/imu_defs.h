@@ -15,6 +15,7 @@
 #define ICM20948_BANK_1   0x10
 #define ICM20948_BANK_2   0x20
 #define ICM20948_BANK_3   0x30
+#define ICM20948_BANK_UNKNOWN 0xFF   // Driver cache only: force the next select
 
 #define ICM20948_REG_BANK_SEL 0x7F
 
@@ -23,14 +24,30 @@
  *   BANK 0 REGISTERS
  * ============================================ */
 
-// Power management
+// Power management (LP_CONFIG, PWR_MGMT_1, PWR_MGMT_2 are consecutive)
+#define ICM20948_LP_CONFIG       0x05
+#define LP_CONFIG_I2C_MST_CYCLE  0x40    // Reset default
+#define LP_CONFIG_ACCEL_CYCLE    0x20
 #define ICM20948_PWR_MGMT_1      0x06
+#define PWR_MGMT_1_LP_EN         0x20
+#define PWR_MGMT_1_CLKSEL_AUTO   0x01
 #define ICM20948_PWR_MGMT_2      0x07
+#define PWR_MGMT_2_GYRO_OFF      0x07
 
 // User control
 #define REG_USER_CTRL            0x03
+#define USER_CTRL_FIFO_ENABLE    0x40    // Bit 6 enables the FIFO
 #define USER_CTRL_I2C_MST_ENABLE 0x20    // Bit 5 enables internal I2C master
 
+// Interrupts
+#define ICM20948_INT_PIN_CFG     0x0F    // 0x00: INT1 active high, push-pull, 50 us pulse
+#define ICM20948_INT_ENABLE      0x10
+#define INT_ENABLE_WOM           0x08    // Wake-on-motion on INT1
+#define ICM20948_INT_ENABLE_1    0x11
+#define INT_ENABLE_1_RAW_DATA_RDY 0x01   // Pulse INT1 each time a sample is written
+#define ICM20948_INT_STATUS      0x19    // Cleared on read
+#define INT_STATUS_WOM           0x08
+
 // Device ID
 #define ICM20948_WHO_AM_I        0x00    // Should return 0xEA
 
@@ -43,14 +60,43 @@
 #define ICM20948_GYRO_YOUT_H     0x35
 #define ICM20948_GYRO_ZOUT_H     0x37
 
+#define ICM20948_TEMP_OUT_H      0x39
+
+// ACCEL_XOUT_H..EXT_SENS_DATA_08 are contiguous: one burst covers a 9-axis sample and both mag status bytes
+#define ICM20948_BURST_LEN       23
+
 // External Sensor Data (magnetometer bytes from AK09916)
 #define EXT_SENS_DATA_00         0x3B
 
+// FIFO
+#define ICM20948_FIFO_EN_1       0x66
+#define ICM20948_FIFO_EN_2       0x67
+#define FIFO_EN_2_ACCEL          0x10
+#define FIFO_EN_2_GYRO_XYZ       0x0E
+#define ICM20948_FIFO_RST        0x68
+#define ICM20948_FIFO_MODE       0x69    // 0 = stream
+#define ICM20948_FIFO_COUNTH     0x70    // COUNTH/COUNTL, 13 bits, read together
+#define ICM20948_FIFO_R_W        0x72
+#define ICM20948_FIFO_SIZE       512
+
 
 /* ============================================
  *   BANK 2 — CONFIG REGISTERS
  * ============================================ */
 
+// Sample rate dividers (only applied with the DLPF on)
+#define ICM20948_GYRO_SMPLRT_DIV    0x00   // ODR = 1100 Hz / (1 + div)
+#define ICM20948_ACCEL_SMPLRT_DIV_1 0x10   // ODR = 1125 Hz / (1 + div), div[11:8]
+#define ICM20948_ACCEL_SMPLRT_DIV_2 0x11   // div[7:0]
+#define ICM20948_ACCEL_INTEL_CTRL   0x12
+#define ACCEL_INTEL_EN_CMP_PREV     0x03   // WoM on, compare each sample with the previous one
+#define ICM20948_ACCEL_WOM_THR      0x13   // 4 mg per LSB
+#define ICM20948_GYRO_BASE_HZ       1100
+#define ICM20948_ACCEL_BASE_HZ      1125
+
+// FCHOICE = 1 and DLPFCFG = 3 (~50 Hz bandwidth) in GYRO_CONFIG_1 / ACCEL_CONFIG
+#define ICM20948_DLPF_ON            ((3 << 3) | 0x01)
+
 // Gyro configuration (Bank 2)
 #define ICM20948_GYRO_CONFIG_1   0x01
 
@@ -85,6 +131,10 @@
 // Status registers
 #define AK09916_REG_ST1          0x10
 #define AK09916_REG_ST2          0x18
+#define AK09916_ST1_DRDY         0x01    // New sample since ST2 was last read
+#define AK09916_ST1_DOR          0x02    // A sample was skipped
+#define AK09916_ST2_HOFL         0x08    // Field outside the measurement range, sample invalid
+#define AK09916_READ_LEN         9       // ST1, HXL..HZH, TMPS, ST2 (reading ST2 releases the next sample)
 
 // Magnetometer output data
 #define AK09916_REG_HXL          0x11
@@ -110,3 +160,4 @@
  *   MISC CONSTANTS
  * ============================================ */
 #define AK09916_SENSITIVITY      0.15f    // µT per LSB
+#define AK09916_STALE_MS         50       // Same reading this long (5 samples at 100 Hz) = magnetometer stalled
@@ -0,0 +1,256 @@
+#include "imu_fifo.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+
+static const char *TAG = "IMU_FIFO";
+
+/**
+ * @brief INT1 pulse (one per sample): wake the task once a watermark's worth has arrived
+ */
+static void IRAM_ATTR imu_fifo_int_isr(void *arg) {
+    ImuFifo *fifo = (ImuFifo *)arg;
+    BaseType_t woken = pdFALSE;
+    if (++fifo->pending >= fifo->cfg.watermark && fifo->task != NULL) {
+        fifo->pending = 0;
+        vTaskNotifyGiveFromISR(fifo->task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Drain everything buffered and hand it to the subscribers as one block
+ */
+static void imu_fifo_drain(ImuFifo *fifo) {
+    size_t n = 0;
+    esp_err_t ret = icm20948_fifo_read(fifo->dev, fifo->samples, ICM20948_FIFO_MAX_SAMPLES, &n);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        fifo->overflows++;
+        fifo->seq += ICM20948_FIFO_MAX_SAMPLES;  // lost at least a FIFO's worth
+        ESP_LOGW(TAG, "FIFO overflow, reset (%lu so far)", fifo->overflows);
+        return;
+    }
+    if (ret != ESP_OK || n == 0) {
+        return;
+    }
+
+    imu_fifo_block_t blk = {
+        .samples = fifo->samples,
+        .count = (uint16_t)n,
+        .odr_hz = fifo->dev->fifo_odr_hz,
+        .t_us = esp_timer_get_time(),
+        .seq = fifo->seq,
+        .accel_lsb_per_g = fifo->dev->accel.sensitivity,
+        .gyro_lsb_per_dps = fifo->dev->gyro.sensitivity,
+    };
+    fifo->seq += n;
+    fifo->batches++;
+
+    for (int i = 0; i < fifo->sub_count; i++) {
+        fifo->subs[i].cb(fifo->subs[i].ctx, &blk);
+    }
+}
+
+/**
+ * @brief FIFO task: sleep until the watermark, drain in one bulk read
+ */
+static void imu_fifo_task(void *arg) {
+    ImuFifo *fifo = (ImuFifo *)arg;
+
+    // Twice the batch period: keeps data flowing if a pulse is missed or INT isn't wired
+    uint32_t timeout_ms = 2000UL * fifo->cfg.watermark / fifo->cfg.odr_hz;
+
+    while (fifo->running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+        if (!fifo->running) {
+            break;
+        }
+        imu_fifo_drain(fifo);
+    }
+
+    task_stop_exit(&fifo->stop);
+}
+
+/**
+ * @brief Create a batcher for an initialized IMU (not started)
+ */
+ImuFifo *imu_fifo_create(ICM20948_t *dev, gpio_num_t int_pin) {
+    if (dev == NULL) {
+        return NULL;
+    }
+    ImuFifo *fifo = (ImuFifo *)calloc(1, sizeof(ImuFifo));
+    if (fifo == NULL) {
+        return NULL;
+    }
+    fifo->lock = xSemaphoreCreateRecursiveMutex();
+    if (fifo->lock == NULL) {
+        free(fifo);
+        return NULL;
+    }
+    task_stop_init(&fifo->stop);
+    fifo->dev = dev;
+    fifo->int_pin = int_pin;
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << int_pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,   // INT1 is active high, push-pull
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    gpio_config(&io_conf);
+    gpio_intr_disable(int_pin);
+    return fifo;
+}
+
+/**
+ * @brief Destroy a batcher
+ */
+void imu_fifo_destroy(ImuFifo *fifo) {
+    if (fifo == NULL) return;
+    imu_fifo_stop(fifo);
+    vSemaphoreDelete(fifo->lock);
+    free(fifo);
+}
+
+/**
+ * @brief Add a block subscriber (before start)
+ */
+esp_err_t imu_fifo_subscribe(ImuFifo *fifo, imu_fifo_cb_t cb, void *ctx) {
+    if (fifo == NULL || cb == NULL) return ESP_ERR_INVALID_ARG;
+    if (fifo->running) return ESP_ERR_INVALID_STATE;
+    if (fifo->sub_count >= IMU_FIFO_MAX_SUBSCRIBERS) return ESP_ERR_NO_MEM;
+    fifo->subs[fifo->sub_count].cb = cb;
+    fifo->subs[fifo->sub_count].ctx = ctx;
+    fifo->sub_count++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Whether the chip can batch at this config (checked by start and set_config)
+ */
+bool imu_fifo_config_valid(const imu_fifo_config_t *config) {
+    return config != NULL && config->odr_hz >= IMU_FIFO_MIN_ODR_HZ &&
+           config->odr_hz <= IMU_FIFO_MAX_ODR_HZ && config->watermark > 0;
+}
+
+/**
+ * @brief Stop, reprogram the chip and start the task (caller holds the lock)
+ */
+static esp_err_t imu_fifo_restart(ImuFifo *fifo, const imu_fifo_config_t *config, UBaseType_t priority) {
+    imu_fifo_stop(fifo);
+
+    fifo->cfg = *config;
+    if (fifo->cfg.watermark > IMU_FIFO_MAX_WATERMARK) {
+        fifo->cfg.watermark = IMU_FIFO_MAX_WATERMARK;
+    }
+
+    esp_err_t ret = icm20948_fifo_enable(fifo->dev, fifo->cfg.odr_hz);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    fifo->pending = 0;
+    fifo->seq = 0;
+    fifo->priority = priority;
+    fifo->running = true;
+    if (xTaskCreate(imu_fifo_task, "imu_fifo", 4096, fifo, priority, &fifo->task) != pdPASS) {
+        fifo->running = false;
+        icm20948_fifo_disable(fifo->dev);
+        ESP_LOGE(TAG, "Failed to create FIFO task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        imu_fifo_stop(fifo);
+        return ret;
+    }
+    gpio_isr_handler_add(fifo->int_pin, imu_fifo_int_isr, fifo);
+    gpio_intr_enable(fifo->int_pin);
+
+    ESP_LOGI(TAG, "Batching at %.1f Hz, %d samples per wake (INT on GPIO %d)",
+             fifo->dev->fifo_odr_hz, fifo->cfg.watermark, fifo->int_pin);
+    return ESP_OK;
+}
+
+/**
+ * @brief Configure the chip FIFO and start batching (restarts with the new config if running)
+ */
+esp_err_t imu_fifo_start(ImuFifo *fifo, const imu_fifo_config_t *config, UBaseType_t priority) {
+    if (fifo == NULL || !imu_fifo_config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    imu_fifo_config_t cfg = *config;   // may point at fifo->cfg
+    xSemaphoreTakeRecursive(fifo->lock, portMAX_DELAY);
+    esp_err_t ret = imu_fifo_restart(fifo, &cfg, priority);
+    xSemaphoreGiveRecursive(fifo->lock);
+    return ret;
+}
+
+/**
+ * @brief Change the batching config: restarts now if running, else kept for the next start
+ */
+esp_err_t imu_fifo_set_config(ImuFifo *fifo, const imu_fifo_config_t *config) {
+    if (fifo == NULL || !imu_fifo_config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTakeRecursive(fifo->lock, portMAX_DELAY);
+    if (fifo->running) {
+        imu_fifo_config_t prev = fifo->cfg;
+        ret = imu_fifo_restart(fifo, config, fifo->priority);
+        if (ret != ESP_OK && imu_fifo_restart(fifo, &prev, fifo->priority) != ESP_OK) {
+            ESP_LOGE(TAG, "Could not restore the previous config, batching is off");
+        }
+    } else {
+        // Parked or stopped: imu_wake and imu_fifo_start(fifo, &fifo->cfg, ...) pick this up
+        fifo->cfg = *config;
+        if (fifo->cfg.watermark > IMU_FIFO_MAX_WATERMARK) {
+            fifo->cfg.watermark = IMU_FIFO_MAX_WATERMARK;
+        }
+    }
+    xSemaphoreGiveRecursive(fifo->lock);
+    return ret;
+}
+
+/**
+ * @brief Stop batching and turn the chip FIFO off
+ */
+void imu_fifo_stop(ImuFifo *fifo) {
+    if (fifo == NULL) return;
+
+    xSemaphoreTakeRecursive(fifo->lock, portMAX_DELAY);
+    if (fifo->running) {
+        gpio_intr_disable(fifo->int_pin);
+        gpio_isr_handler_remove(fifo->int_pin);
+        fifo->running = false;
+        task_stop_join(&fifo->stop, &fifo->task);
+        icm20948_fifo_disable(fifo->dev);
+        ESP_LOGI(TAG, "Batching stopped (%lu batches, %lu overflows)", fifo->batches, fifo->overflows);
+    }
+    xSemaphoreGiveRecursive(fifo->lock);
+}
+
+/**
+ * @brief Hold off other start/stop/set_config calls across a multi-step change (recursive, NULL is a no-op)
+ */
+void imu_fifo_lock(ImuFifo *fifo) {
+    if (fifo == NULL) return;
+    xSemaphoreTakeRecursive(fifo->lock, portMAX_DELAY);
+}
+
+/**
+ * @brief Release imu_fifo_lock
+ */
+void imu_fifo_unlock(ImuFifo *fifo) {
+    if (fifo == NULL) return;
+    xSemaphoreGiveRecursive(fifo->lock);
+}
+
+/**
+ * @brief Whether the batcher is running
+ */
+bool imu_fifo_is_running(const ImuFifo *fifo) {
+    return fifo ? fifo->running : false;
+}
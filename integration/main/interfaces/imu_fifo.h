@@ -0,0 +1,129 @@
+#ifndef IMU_FIFO_H
+#define IMU_FIFO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "driver/gpio.h"
+#include "imu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_FIFO_MAX_SUBSCRIBERS 8
+#define IMU_FIFO_MAX_WATERMARK   32   // Leaves headroom below the 42-sample hardware FIFO
+#define IMU_FIFO_MIN_ODR_HZ      5
+#define IMU_FIFO_MAX_ODR_HZ      ICM20948_GYRO_BASE_HZ   // Sample rate divider 0
+
+/**
+ * @brief Block of consecutive samples handed to subscribers
+ */
+typedef struct {
+    const icm20948_fifo_sample_t *samples;
+    uint16_t count;
+    float odr_hz;              /**< Sample rate (spacing is 1 / odr_hz) */
+    int64_t t_us;              /**< esp_timer time of the last sample (drain time) */
+    uint32_t seq;              /**< Index of the first sample since start, gaps mean dropped data */
+    float accel_lsb_per_g;
+    float gyro_lsb_per_dps;
+} imu_fifo_block_t;
+
+/**
+ * @brief Subscriber callback, runs in the FIFO task (keep it short)
+ */
+typedef void (*imu_fifo_cb_t)(void *ctx, const imu_fifo_block_t *blk);
+
+/**
+ * @brief Batching tuning
+ */
+typedef struct {
+    uint32_t odr_hz;           /**< Accel + gyro sample rate */
+    uint16_t watermark;        /**< Samples per batch (wake the task after this many) */
+} imu_fifo_config_t;
+
+/**
+ * @brief FIFO batcher: INT pulses are counted in the ISR, the task drains once per watermark
+ */
+typedef struct ImuFifo {
+    ICM20948_t *dev;
+    gpio_num_t int_pin;
+    imu_fifo_config_t cfg;
+
+    struct {
+        imu_fifo_cb_t cb;
+        void *ctx;
+    } subs[IMU_FIFO_MAX_SUBSCRIBERS];
+    uint8_t sub_count;
+
+    icm20948_fifo_sample_t samples[ICM20948_FIFO_MAX_SAMPLES];
+    volatile uint32_t pending;      // INT pulses since the last wake (ISR)
+    uint32_t seq;
+    uint32_t overflows;
+    uint32_t batches;
+
+    TaskHandle_t task;
+    TaskStop stop;
+    UBaseType_t priority;
+    volatile bool running;
+    SemaphoreHandle_t lock;         // start/stop/set_config come from the wake task, BLE and imu_rates
+} ImuFifo;
+
+/**
+ * @brief Create a batcher for an initialized IMU (not started)
+ */
+ImuFifo *imu_fifo_create(ICM20948_t *dev, gpio_num_t int_pin);
+
+/**
+ * @brief Destroy a batcher
+ */
+void imu_fifo_destroy(ImuFifo *fifo);
+
+/**
+ * @brief Add a block subscriber (before start)
+ */
+esp_err_t imu_fifo_subscribe(ImuFifo *fifo, imu_fifo_cb_t cb, void *ctx);
+
+/**
+ * @brief Whether the chip can batch at this config (checked by start and set_config)
+ */
+bool imu_fifo_config_valid(const imu_fifo_config_t *config);
+
+/**
+ * @brief Configure the chip FIFO and start batching (restarts with the new config if running)
+ */
+esp_err_t imu_fifo_start(ImuFifo *fifo, const imu_fifo_config_t *config, UBaseType_t priority);
+
+/**
+ * @brief Change the batching config: restarts now if running, else kept for the next start
+ *
+ * If the restart fails, the previous config is restored and restarted.
+ */
+esp_err_t imu_fifo_set_config(ImuFifo *fifo, const imu_fifo_config_t *config);
+
+/**
+ * @brief Stop batching and turn the chip FIFO off
+ */
+void imu_fifo_stop(ImuFifo *fifo);
+
+/**
+ * @brief Hold off other start/stop/set_config calls across a multi-step change (recursive, NULL is a no-op)
+ */
+void imu_fifo_lock(ImuFifo *fifo);
+
+/**
+ * @brief Release imu_fifo_lock
+ */
+void imu_fifo_unlock(ImuFifo *fifo);
+
+/**
+ * @brief Whether the batcher is running
+ */
+bool imu_fifo_is_running(const ImuFifo *fifo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_FIFO_H
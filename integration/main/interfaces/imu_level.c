@@ -0,0 +1,136 @@
+#include "imu_level.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "IMU_LEVEL";
+
+#define IMU_LEVEL_LPF_TAU_S     0.05f    // Gravity estimate for the tilt
+#define IMU_LEVEL_REF_TAU_S     10.0f    // Reference follows slow mounting/floor drift
+#define IMU_LEVEL_QUIET_G       0.05f    // | |accel| - resting | below this is at rest
+#define IMU_LEVEL_FOLLOW_COS    0.9962f  // cos(5 deg): only follow drift this close to level
+
+/**
+ * @brief FIFO subscriber: update the reference and fill the per-sample arrays
+ */
+static void imu_level_on_block(void *ctx, const imu_fifo_block_t *blk) {
+    ImuLevel *level = (ImuLevel *)ctx;
+
+    if (level->reset) {
+        level->reset = false;
+        level->ref_valid = false;
+        level->quiet_n = 0;
+    }
+    level->gap = blk->seq != level->next_seq;
+    if (level->gap) {
+        level->primed = false;     // restart or overflow: don't filter across the gap
+    }
+    level->next_seq = blk->seq + blk->count;
+    level->seq = blk->seq;
+    level->count = blk->count;
+
+    float dt = 1.0f / blk->odr_hz;
+    float inv_lsb = 1.0f / blk->accel_lsb_per_g;
+    float lpf_alpha = fminf(dt / IMU_LEVEL_LPF_TAU_S, 1.0f);
+    float ref_alpha = dt / IMU_LEVEL_REF_TAU_S;
+
+    for (uint16_t i = 0; i < blk->count; i++) {
+        const int16_t *raw = blk->samples[i].accel;
+        float a[3] = { raw[0] * inv_lsb, raw[1] * inv_lsb, raw[2] * inv_lsb };
+        float mag = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        level->mag_g[i] = mag;
+
+        if (!level->primed) {
+            memcpy(level->lpf, a, sizeof(a));
+            level->quiet_n = 0;
+            level->primed = true;
+        }
+        for (int k = 0; k < 3; k++) {
+            level->lpf[k] += (a[k] - level->lpf[k]) * lpf_alpha;
+        }
+        float lpf_mag = sqrtf(level->lpf[0] * level->lpf[0] + level->lpf[1] * level->lpf[1] +
+                              level->lpf[2] * level->lpf[2]);
+        float rest = level->ref_valid ? level->ref_g : lpf_mag;
+        level->quiet_n = fabsf(mag - rest) < IMU_LEVEL_QUIET_G ? level->quiet_n + 1 : 0;
+
+        if (!level->ref_valid) {
+            level->cos_tilt[i] = 1.0f;
+            level->up_g[i] = 0.0f;
+
+            // Reference from the first quiet second
+            if (level->quiet_n >= (uint32_t)blk->odr_hz && lpf_mag > 0.0f) {
+                for (int k = 0; k < 3; k++) level->ref[k] = level->lpf[k] / lpf_mag;
+                level->ref_g = lpf_mag;
+                level->ref_valid = true;
+                ESP_LOGI(TAG, "Level reference set (%.3f g at rest)", level->ref_g);
+            }
+            continue;
+        }
+
+        float cos_a = lpf_mag > 0.0f
+            ? (level->lpf[0] * level->ref[0] + level->lpf[1] * level->ref[1] + level->lpf[2] * level->ref[2]) / lpf_mag
+            : 1.0f;
+        level->cos_tilt[i] = cos_a;
+        level->up_g[i] = a[0] * level->ref[0] + a[1] * level->ref[1] + a[2] * level->ref[2] - level->ref_g;
+
+        // Follow slow drift, never while tilted or moving
+        if (cos_a > IMU_LEVEL_FOLLOW_COS && level->quiet_n > 0 && lpf_mag > 0.0f) {
+            float r[3];
+            for (int k = 0; k < 3; k++) {
+                r[k] = level->ref[k] + (level->lpf[k] / lpf_mag - level->ref[k]) * ref_alpha;
+            }
+            float r_norm = sqrtf(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+            for (int k = 0; k < 3; k++) level->ref[k] = r[k] / r_norm;
+            level->ref_g += (lpf_mag - level->ref_g) * ref_alpha;
+        }
+    }
+}
+
+/**
+ * @brief Create the tracker and subscribe it to the FIFO (before its consumers subscribe)
+ */
+ImuLevel *imu_level_create(ImuFifo *fifo) {
+    if (fifo == NULL) {
+        return NULL;
+    }
+    ImuLevel *level = (ImuLevel *)calloc(1, sizeof(ImuLevel));
+    if (level == NULL) {
+        return NULL;
+    }
+    if (imu_fifo_subscribe(fifo, imu_level_on_block, level) != ESP_OK) {
+        ESP_LOGE(TAG, "Could not subscribe to the IMU FIFO");
+        free(level);
+        return NULL;
+    }
+    return level;
+}
+
+/**
+ * @brief Destroy the tracker (only with the FIFO, which has no unsubscribe)
+ */
+void imu_level_destroy(ImuLevel *level) {
+    free(level);
+}
+
+/**
+ * @brief Whether the arrays describe this block (call from a FIFO callback)
+ */
+bool imu_level_has_block(const ImuLevel *level, const imu_fifo_block_t *blk) {
+    return level != NULL && level->seq == blk->seq && level->count == blk->count;
+}
+
+/**
+ * @brief Resting |accel| once learned, else 1 g
+ */
+float imu_level_rest_g(const ImuLevel *level) {
+    return level != NULL && level->ref_valid ? level->ref_g : 1.0f;
+}
+
+/**
+ * @brief Forget the level reference (the next quiet second sets it)
+ */
+void imu_level_reset(ImuLevel *level) {
+    if (level == NULL) return;
+    level->reset = true;
+}
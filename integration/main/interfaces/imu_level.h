@@ -0,0 +1,71 @@
+#ifndef IMU_LEVEL_H
+#define IMU_LEVEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "imu.h"
+#include "imu_fifo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Level gravity reference shared by the motion classifier and the alert detector
+ *
+ * Subscribed to the FIFO ahead of its consumers, it tracks which way is down
+ * on a level floor and publishes, for every sample of the block being
+ * delivered, the tilt against that reference and the acceleration along it.
+ * Consumers read the arrays from their own FIFO callback for the same block.
+ */
+typedef struct ImuLevel {
+    // Tracker (FIFO task only)
+    float lpf[3];              // accel low-passed over ~50 ms, g
+    float ref[3];              // level gravity direction (unit), follows slowly while quiet and level
+    float ref_g;               // resting |accel| (includes the accel scale error)
+    bool ref_valid;
+    uint32_t quiet_n;          // consecutive samples at rest
+    bool primed;               // lpf holds a sample from the current FIFO run
+    uint32_t next_seq;         // next expected FIFO sample index
+    volatile bool reset;       // imu_level_reset asked for a new reference
+
+    // Current block, one entry per sample
+    float cos_tilt[ICM20948_FIFO_MAX_SAMPLES];  // low-passed gravity vs ref (1 without a reference)
+    float up_g[ICM20948_FIFO_MAX_SAMPLES];      // accel along ref minus ref_g (0 without a reference)
+    float mag_g[ICM20948_FIFO_MAX_SAMPLES];     // |accel|
+    uint32_t seq;              // blk->seq of the current block
+    uint16_t count;
+    bool gap;                  // current block does not continue the previous one
+} ImuLevel;
+
+/**
+ * @brief Create the tracker and subscribe it to the FIFO (before its consumers subscribe)
+ */
+ImuLevel *imu_level_create(ImuFifo *fifo);
+
+/**
+ * @brief Destroy the tracker (only with the FIFO, which has no unsubscribe)
+ */
+void imu_level_destroy(ImuLevel *level);
+
+/**
+ * @brief Whether the arrays describe this block (call from a FIFO callback)
+ */
+bool imu_level_has_block(const ImuLevel *level, const imu_fifo_block_t *blk);
+
+/**
+ * @brief Resting |accel| once learned, else 1 g
+ */
+float imu_level_rest_g(const ImuLevel *level);
+
+/**
+ * @brief Forget the level reference (the next quiet second sets it)
+ */
+void imu_level_reset(ImuLevel *level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_LEVEL_H
@@ -0,0 +1,357 @@
+#include "imu_mag_cal.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "IMU_MAG_CAL";
+
+#define IMU_MAG_CAL_LEVEL_SAMPLES  10       // Accel samples averaged to find the vertical axis
+#define IMU_MAG_CAL_MIN_SPAN_UT    10.0f    // Both horizontal axes must swing this much before binning counts
+#define IMU_MAG_CAL_MAX_ERR        0.1f     // Corrected radius RMS error, relative
+#define IMU_MAG_CAL_MAX_RATIO      3.0f     // Ellipse axis ratio (soft iron this bad is a mounting problem)
+#define IMU_MAG_CAL_MIN_UT         10.0f    // Plausible horizontal field
+#define IMU_MAG_CAL_MAX_UT         100.0f
+#define IMU_MAG_CAL_PI             3.14159265f
+
+/**
+ * @brief Solve the 5x5 normal equations in place (partial pivoting)
+ */
+static bool imu_mag_cal_solve5(float a[5][5], float b[5], float x[5]) {
+    for (int c = 0; c < 5; c++) {
+        int p = c;
+        for (int r = c + 1; r < 5; r++) {
+            if (fabsf(a[r][c]) > fabsf(a[p][c])) p = r;
+        }
+        if (fabsf(a[p][c]) < 1e-9f) {
+            return false;
+        }
+        if (p != c) {
+            for (int k = 0; k < 5; k++) {
+                float t = a[c][k]; a[c][k] = a[p][k]; a[p][k] = t;
+            }
+            float t = b[c]; b[c] = b[p]; b[p] = t;
+        }
+        for (int r = c + 1; r < 5; r++) {
+            float f = a[r][c] / a[c][c];
+            for (int k = c; k < 5; k++) {
+                a[r][k] -= f * a[c][k];
+            }
+            b[r] -= f * b[c];
+        }
+    }
+    for (int r = 4; r >= 0; r--) {
+        float s = b[r];
+        for (int k = r + 1; k < 5; k++) {
+            s -= a[r][k] * x[k];
+        }
+        x[r] = s / a[r][r];
+    }
+    return true;
+}
+
+/**
+ * @brief Fit an ellipse to the binned horizontal samples and build the correction
+ *
+ * Least squares conic A u^2 + B uv + C v^2 + D u + E v + F = 0 with A + C = 1,
+ * on samples centred and scaled to ~1 for conditioning. The ellipse becomes
+ * (p - c)^T M (p - c) = 1; W = sqrt(M) / det(M)^(1/4) maps it onto a circle
+ * with the same area, so the corrected field keeps its strength.
+ */
+static imu_mag_cal_result_t imu_mag_cal_fit(ImuMagCal *cal, icm20948_mag_cal_t *out) {
+    float mu[2] = {0.0f, 0.0f};
+    uint32_t n = 0;
+    for (int s = 0; s < IMU_MAG_CAL_SECTORS; s++) {
+        for (int i = 0; i < cal->count[s]; i++) {
+            mu[0] += cal->samples[s][i][0];
+            mu[1] += cal->samples[s][i][1];
+            n++;
+        }
+    }
+    if (n < 6) {
+        return IMU_MAG_CAL_BAD_FIT;
+    }
+    mu[0] /= n;
+    mu[1] /= n;
+    float span = fmaxf(cal->max_ut[0] - cal->min_ut[0], cal->max_ut[1] - cal->min_ut[1]);
+    float k = 2.0f / span;
+
+    // Normal equations for [B, C, D, E, F] with A = 1 - C
+    float ata[5][5] = {{0}};
+    float atb[5] = {0};
+    for (int s = 0; s < IMU_MAG_CAL_SECTORS; s++) {
+        for (int i = 0; i < cal->count[s]; i++) {
+            float u = (cal->samples[s][i][0] - mu[0]) * k;
+            float v = (cal->samples[s][i][1] - mu[1]) * k;
+            float row[5] = { u * v, v * v - u * u, u, v, 1.0f };
+            for (int r = 0; r < 5; r++) {
+                for (int c = 0; c < 5; c++) {
+                    ata[r][c] += row[r] * row[c];
+                }
+                atb[r] -= row[r] * u * u;
+            }
+        }
+    }
+    float x[5];
+    if (!imu_mag_cal_solve5(ata, atb, x)) {
+        return IMU_MAG_CAL_BAD_FIT;
+    }
+    float B = x[0], C = x[1], D = x[2], E = x[3], F = x[4];
+    float A = 1.0f - C;
+
+    float det2 = 4.0f * A * C - B * B;
+    if (A <= 0.0f || det2 <= 0.0f) {
+        return IMU_MAG_CAL_BAD_FIT;          // not an ellipse
+    }
+    float cu = (B * E - 2.0f * C * D) / det2;
+    float cv = (B * D - 2.0f * A * E) / det2;
+    float r2 = -(A * cu * cu + B * cu * cv + C * cv * cv + D * cu + E * cv + F);
+    if (r2 <= 0.0f) {
+        return IMU_MAG_CAL_BAD_FIT;
+    }
+
+    // Back to uT: p - c = (p' - c') / k
+    float m00 = A * k * k / r2, m01 = 0.5f * B * k * k / r2, m11 = C * k * k / r2;
+    float c0 = mu[0] + cu / k, c1 = mu[1] + cv / k;
+
+    float tr = m00 + m11;
+    float det = m00 * m11 - m01 * m01;
+    float disc = sqrtf(fmaxf(0.25f * tr * tr - det, 0.0f));
+    float l_min = 0.5f * tr - disc, l_max = 0.5f * tr + disc;
+    if (l_min <= 0.0f || sqrtf(l_max / l_min) > IMU_MAG_CAL_MAX_RATIO) {
+        return IMU_MAG_CAL_BAD_FIT;
+    }
+
+    float sd = sqrtf(det);
+    float t = sqrtf(tr + 2.0f * sd);
+    float q = 1.0f / (t * sqrtf(sd));       // 1 / (t * det^(1/4))
+    float w00 = (m00 + sd) * q, w01 = m01 * q, w11 = (m11 + sd) * q;
+    float radius = 1.0f / sqrtf(sd);
+    if (radius < IMU_MAG_CAL_MIN_UT || radius > IMU_MAG_CAL_MAX_UT) {
+        return IMU_MAG_CAL_BAD_FIT;
+    }
+
+    float err2 = 0.0f;
+    for (int s = 0; s < IMU_MAG_CAL_SECTORS; s++) {
+        for (int i = 0; i < cal->count[s]; i++) {
+            float du = cal->samples[s][i][0] - c0, dv = cal->samples[s][i][1] - c1;
+            float e = sqrtf((w00 * du + w01 * dv) * (w00 * du + w01 * dv) +
+                            (w01 * du + w11 * dv) * (w01 * du + w11 * dv)) - radius;
+            err2 += e * e;
+        }
+    }
+    cal->fit_err = sqrtf(err2 / n) / radius;
+    if (cal->fit_err > IMU_MAG_CAL_MAX_ERR) {
+        return IMU_MAG_CAL_BAD_FIT;
+    }
+
+    // Embed in 3D: identity (and no offset) along the vertical axis
+    int u = (cal->up_axis + 1) % 3, v = (cal->up_axis + 2) % 3;
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < 3; i++) {
+        out->soft[i][i] = 1.0f;
+    }
+    out->hard_ut[u] = c0;
+    out->hard_ut[v] = c1;
+    out->soft[u][u] = w00;
+    out->soft[u][v] = w01;
+    out->soft[v][u] = w01;
+    out->soft[v][v] = w11;
+    ESP_LOGI(TAG, "Fit: |B| %.1f uT, offset %.1f %.1f uT, axis ratio %.2f, error %.1f%%",
+             radius, c0, c1, sqrtf(l_max / l_min), cal->fit_err * 100.0f);
+    return IMU_MAG_CAL_DONE;
+}
+
+/**
+ * @brief Bin one uncalibrated sample by its angle around the running min/max centre
+ *
+ * @return Heading span covered so far, in degrees
+ */
+static uint32_t imu_mag_cal_add(ImuMagCal *cal, const float ut[3]) {
+    float h[2] = { ut[(cal->up_axis + 1) % 3], ut[(cal->up_axis + 2) % 3] };
+    for (int i = 0; i < 2; i++) {
+        if (h[i] < cal->min_ut[i]) cal->min_ut[i] = h[i];
+        if (h[i] > cal->max_ut[i]) cal->max_ut[i] = h[i];
+    }
+    if (cal->max_ut[0] - cal->min_ut[0] < IMU_MAG_CAL_MIN_SPAN_UT ||
+        cal->max_ut[1] - cal->min_ut[1] < IMU_MAG_CAL_MIN_SPAN_UT) {
+        return 0;   // centre not known well enough yet
+    }
+
+    float a = atan2f(h[1] - 0.5f * (cal->min_ut[1] + cal->max_ut[1]),
+                     h[0] - 0.5f * (cal->min_ut[0] + cal->max_ut[0]));
+    int s = (int)((a + IMU_MAG_CAL_PI) * (IMU_MAG_CAL_SECTORS / (2.0f * IMU_MAG_CAL_PI)));
+    if (s >= IMU_MAG_CAL_SECTORS) s = IMU_MAG_CAL_SECTORS - 1;
+    if (cal->count[s] < IMU_MAG_CAL_PER_SECTOR) {
+        cal->samples[s][cal->count[s]][0] = h[0];
+        cal->samples[s][cal->count[s]][1] = h[1];
+        cal->count[s]++;
+    }
+
+    uint32_t covered = 0;
+    for (int i = 0; i < IMU_MAG_CAL_SECTORS; i++) {
+        if (cal->count[i] > 0) covered++;
+    }
+    return covered * (360 / IMU_MAG_CAL_SECTORS);
+}
+
+/**
+ * @brief Collect while the cart turns, then fit, apply and save
+ */
+static void imu_mag_cal_task(void *arg) {
+    ImuMagCal *cal = (ImuMagCal *)arg;
+    TickType_t period = pdMS_TO_TICKS(1000 / cal->cfg.sample_hz);
+    if (period == 0) period = 1;
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(cal->cfg.timeout_ms);
+    imu_mag_cal_result_t result = IMU_MAG_CAL_STOPPED;
+    uint32_t covered = 0;
+
+    while (cal->running) {
+        ulTaskNotifyTake(pdTRUE, period);
+        if (!cal->running) {
+            break;
+        }
+        if (xTaskGetTickCount() - start >= timeout) {
+            result = IMU_MAG_CAL_TIMEOUT;
+            break;
+        }
+
+        icm20948_raw_sample_t raw;
+        if (cal->dev->parked || icm20948_read_raw(cal->dev, &raw) != ESP_OK) {
+            continue;
+        }
+
+        if (cal->up_axis < 0) {
+            for (int i = 0; i < 3; i++) {
+                cal->accel_sum[i] += raw.accel[i];
+            }
+            if (++cal->accel_n == IMU_MAG_CAL_LEVEL_SAMPLES) {
+                int up = 0;
+                for (int i = 1; i < 3; i++) {
+                    if (fabsf(cal->accel_sum[i]) > fabsf(cal->accel_sum[up])) up = i;
+                }
+                cal->up_axis = up;
+                ESP_LOGI(TAG, "Vertical axis %c, turn the cart through a full circle", "XYZ"[up]);
+            }
+            continue;
+        }
+
+        float ut[3];
+        if (icm20948_mag_convert(cal->dev, &raw, ut, false) != ESP_OK) {
+            continue;
+        }
+        covered = imu_mag_cal_add(cal, ut);
+        if (covered >= cal->cfg.coverage_deg) {
+            break;
+        }
+    }
+
+    icm20948_mag_cal_t fit;
+    if (covered >= cal->cfg.coverage_deg) {
+        result = imu_mag_cal_fit(cal, &fit);
+        if (result == IMU_MAG_CAL_DONE) {
+            icm20948_mag_cal_save(cal->dev, &fit);
+        }
+    } else if (result == IMU_MAG_CAL_TIMEOUT) {
+        ESP_LOGW(TAG, "Timed out with %lu of %lu degrees covered", covered, cal->cfg.coverage_deg);
+    }
+    cal->result = result;
+    if (result != IMU_MAG_CAL_DONE) {
+        ESP_LOGW(TAG, "Calibration %s, keeping the previous one", imu_mag_cal_result_str(result));
+    }
+    if (cal->cb && result != IMU_MAG_CAL_STOPPED) {
+        cal->cb(cal->ctx, result, result == IMU_MAG_CAL_DONE ? &fit : NULL, cal->fit_err);
+    }
+
+    cal->running = false;
+    task_stop_exit(&cal->stop);
+}
+
+/**
+ * @brief Create the calibrator (not started)
+ */
+ImuMagCal *imu_mag_cal_create(ICM20948_t *dev, const imu_mag_cal_config_t *config,
+                              imu_mag_cal_cb_t cb, void *ctx) {
+    if (dev == NULL || config == NULL || config->sample_hz == 0 ||
+        config->coverage_deg == 0 || config->coverage_deg > 360) {
+        return NULL;
+    }
+    ImuMagCal *cal = (ImuMagCal *)calloc(1, sizeof(ImuMagCal));
+    if (cal == NULL) {
+        return NULL;
+    }
+    cal->dev = dev;
+    cal->cfg = *config;
+    cal->cb = cb;
+    cal->ctx = ctx;
+    task_stop_init(&cal->stop);
+    return cal;
+}
+
+/**
+ * @brief Destroy the calibrator
+ */
+void imu_mag_cal_destroy(ImuMagCal *cal) {
+    if (cal == NULL) return;
+    imu_mag_cal_stop(cal);
+    free(cal);
+}
+
+/**
+ * @brief Start collecting (the cart should be turned through a full circle)
+ */
+esp_err_t imu_mag_cal_start(ImuMagCal *cal, UBaseType_t priority) {
+    if (cal == NULL) return ESP_ERR_INVALID_ARG;
+    if (cal->running) return ESP_ERR_INVALID_STATE;
+
+    cal->up_axis = -1;
+    cal->accel_n = 0;
+    cal->fit_err = 0.0f;
+    memset(cal->accel_sum, 0, sizeof(cal->accel_sum));
+    memset(cal->count, 0, sizeof(cal->count));
+    for (int i = 0; i < 2; i++) {
+        cal->min_ut[i] = INFINITY;
+        cal->max_ut[i] = -INFINITY;
+    }
+
+    task_stop_join(&cal->stop, &cal->task);  // a run that finished on its own
+    cal->running = true;
+    if (xTaskCreate(imu_mag_cal_task, "imu_mag_cal", 4096, cal, priority, &cal->task) != pdPASS) {
+        cal->running = false;
+        ESP_LOGE(TAG, "Failed to create calibration task");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Calibration started (%lu s, %lu degrees)",
+             cal->cfg.timeout_ms / 1000, cal->cfg.coverage_deg);
+    return ESP_OK;
+}
+
+/**
+ * @brief Abandon a run (the current calibration is kept)
+ */
+void imu_mag_cal_stop(ImuMagCal *cal) {
+    if (cal == NULL) return;
+    cal->running = false;
+    task_stop_join(&cal->stop, &cal->task);
+}
+
+/**
+ * @brief Whether a run is in progress
+ */
+bool imu_mag_cal_is_running(const ImuMagCal *cal) {
+    return cal != NULL && cal->running;
+}
+
+/**
+ * @brief Result name for logs and BLE
+ */
+const char *imu_mag_cal_result_str(imu_mag_cal_result_t result) {
+    switch (result) {
+        case IMU_MAG_CAL_DONE:    return "DONE";
+        case IMU_MAG_CAL_TIMEOUT: return "TIMEOUT";
+        case IMU_MAG_CAL_BAD_FIT: return "BAD_FIT";
+        case IMU_MAG_CAL_STOPPED: return "STOPPED";
+        default:                  return "UNKNOWN";
+    }
+}
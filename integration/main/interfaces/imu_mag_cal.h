@@ -0,0 +1,110 @@
+#ifndef IMU_MAG_CAL_H
+#define IMU_MAG_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "imu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_MAG_CAL_SECTORS     36   // 10 degree heading bins around the fitted circle
+#define IMU_MAG_CAL_PER_SECTOR  4    // Samples kept per bin (evens out slow and fast turns)
+
+/**
+ * @brief How a calibration run ended
+ */
+typedef enum {
+    IMU_MAG_CAL_DONE = 0,      /**< Fit accepted, applied and saved */
+    IMU_MAG_CAL_TIMEOUT,       /**< Not enough of a turn before timeout_ms */
+    IMU_MAG_CAL_BAD_FIT,       /**< Enough coverage but the samples aren't a plausible ellipse */
+    IMU_MAG_CAL_STOPPED,       /**< Stopped before the end */
+} imu_mag_cal_result_t;
+
+/**
+ * @brief End of run callback, runs in the calibration task
+ *
+ * @param cal     The new calibration (DONE only, else NULL)
+ * @param fit_err RMS radius error of the corrected samples, relative to the radius (0 if no fit)
+ */
+typedef void (*imu_mag_cal_cb_t)(void *ctx, imu_mag_cal_result_t result,
+                                 const icm20948_mag_cal_t *cal, float fit_err);
+
+/**
+ * @brief Calibration run tuning
+ */
+typedef struct {
+    uint32_t timeout_ms;       /**< Give up after this long */
+    uint32_t sample_hz;        /**< Magnetometer sampling while collecting */
+    uint32_t coverage_deg;     /**< Heading span collected before fitting */
+} imu_mag_cal_config_t;
+
+/**
+ * @brief Online hard/soft-iron fit while the cart is turned on the floor
+ *
+ * The cart only yaws, so the fit is a 2D ellipse in the horizontal plane
+ * (the two axes across gravity). The vertical offset can't be seen from a
+ * flat turn and is left at zero; it doesn't affect a level heading.
+ */
+typedef struct ImuMagCal {
+    ICM20948_t *dev;
+    imu_mag_cal_config_t cfg;
+    imu_mag_cal_cb_t cb;
+    void *ctx;
+
+    // Collection (calibration task only)
+    int up_axis;               // sensor axis along gravity, -1 until levelled
+    float accel_sum[3];
+    uint32_t accel_n;
+    float min_ut[2], max_ut[2];
+    float samples[IMU_MAG_CAL_SECTORS][IMU_MAG_CAL_PER_SECTOR][2];
+    uint8_t count[IMU_MAG_CAL_SECTORS];
+
+    // Last result
+    imu_mag_cal_result_t result;
+    float fit_err;
+
+    TaskHandle_t task;
+    TaskStop stop;
+    volatile bool running;
+} ImuMagCal;
+
+/**
+ * @brief Create the calibrator (not started)
+ */
+ImuMagCal *imu_mag_cal_create(ICM20948_t *dev, const imu_mag_cal_config_t *config,
+                              imu_mag_cal_cb_t cb, void *ctx);
+
+/**
+ * @brief Destroy the calibrator
+ */
+void imu_mag_cal_destroy(ImuMagCal *cal);
+
+/**
+ * @brief Start collecting (the cart should be turned through a full circle)
+ */
+esp_err_t imu_mag_cal_start(ImuMagCal *cal, UBaseType_t priority);
+
+/**
+ * @brief Abandon a run (the current calibration is kept)
+ */
+void imu_mag_cal_stop(ImuMagCal *cal);
+
+/**
+ * @brief Whether a run is in progress
+ */
+bool imu_mag_cal_is_running(const ImuMagCal *cal);
+
+/**
+ * @brief Result name for logs and BLE
+ */
+const char *imu_mag_cal_result_str(imu_mag_cal_result_t result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_MAG_CAL_H
@@ -0,0 +1,171 @@
+#include "imu_rates.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include <stdlib.h>
+
+static const char *TAG = "IMU_RATES";
+
+#define IMU_RATES_MIN_WINDOW_MS  100
+#define IMU_RATES_MAX_WINDOW_MS  10000
+#define IMU_RATES_MIN_EVENT_MS   100       // The monitor task ticks at IMU_MOTION_POLL_MS
+
+/**
+ * @brief Classifier window in samples for a window length at a sample rate
+ */
+uint32_t imu_rates_window_samples(uint32_t window_ms, float odr_hz) {
+    float n = window_ms * odr_hz / 1000.0f;
+    uint32_t p = IMU_CLASS_MIN_WINDOW;
+    while (p < IMU_CLASS_MAX_WINDOW && n > p * 1.5f) {
+        p *= 2;
+    }
+    return p;
+}
+
+/**
+ * @brief Create the rate manager (nothing is applied until imu_rates_apply)
+ */
+ImuRates *imu_rates_create(ICM20948_t *dev, ImuFifo *fifo, ImuClassifier *clf,
+                           const imu_rates_t *defaults, uint32_t batch_ms) {
+    if (dev == NULL || defaults == NULL || batch_ms == 0) {
+        return NULL;
+    }
+    ImuRates *r = (ImuRates *)calloc(1, sizeof(ImuRates));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->dev = dev;
+    r->fifo = fifo;
+    r->clf = clf;
+    r->defaults = *defaults;
+    r->rates = *defaults;
+    r->batch_ms = batch_ms;
+    return r;
+}
+
+/**
+ * @brief Destroy the rate manager
+ */
+void imu_rates_destroy(ImuRates *r) {
+    free(r);
+}
+
+/**
+ * @brief Validate and apply all three layers (the FIFO restarts only if running)
+ */
+esp_err_t imu_rates_apply(ImuRates *r, const imu_rates_t *rates) {
+    if (r == NULL || rates == NULL ||
+        rates->odr_hz < IMU_FIFO_MIN_ODR_HZ || rates->odr_hz > IMU_FIFO_MAX_ODR_HZ ||
+        rates->window_ms < IMU_RATES_MIN_WINDOW_MS || rates->window_ms > IMU_RATES_MAX_WINDOW_MS ||
+        rates->event_ms < IMU_RATES_MIN_EVENT_MS || rates->event_ms > r->dev->idle_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Sample layer: same batch period (wakeups per second, alert latency) at the new rate
+    uint32_t wm = (rates->odr_hz * r->batch_ms + 500) / 1000;
+    imu_fifo_config_t fifo_cfg = {
+        .odr_hz = rates->odr_hz,
+        .watermark = (uint16_t)(wm < 1 ? 1 : wm > IMU_FIFO_MAX_WATERMARK ? IMU_FIFO_MAX_WATERMARK : wm),
+    };
+
+    // Feature layer: window length in time, so it follows the (divider-rounded) ODR
+    imu_class_config_t clf_cfg = {0};
+    if (r->clf != NULL) {
+        clf_cfg = r->clf->cfg;
+        clf_cfg.window = imu_rates_window_samples(rates->window_ms, icm20948_fifo_rate_hz(rates->odr_hz));
+        clf_cfg.hop = clf_cfg.window / 2;
+    }
+
+    // Nothing is touched until every layer accepts its part
+    if ((r->fifo != NULL && !imu_fifo_config_valid(&fifo_cfg)) ||
+        (r->clf != NULL && !imu_classifier_config_valid(&clf_cfg))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (r->fifo != NULL) {
+        esp_err_t ret = imu_fifo_set_config(r->fifo, &fifo_cfg);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "FIFO rejected %lu Hz: %s", rates->odr_hz, esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    if (r->clf != NULL) {
+        imu_classifier_configure(r->clf, &clf_cfg);   // validated above, only queues the change
+    }
+
+    // Event layer
+    icm20948_set_event_rate(r->dev, rates->event_ms, r->dev->idle_ms);
+
+    r->rates = *rates;
+    ESP_LOGI(TAG, "Rates: %lu Hz samples, %lu ms windows, %lu ms events",
+             rates->odr_hz, rates->window_ms, rates->event_ms);
+    return ESP_OK;
+}
+
+/**
+ * @brief Apply the rates saved in NVS, or the defaults if there are none
+ */
+esp_err_t imu_rates_load(ImuRates *r) {
+    if (r == NULL) return ESP_ERR_INVALID_ARG;
+
+    imu_rates_t saved;
+    size_t len = sizeof(saved);
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(IMU_RATES_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_get_blob(nvs, "rates", &saved, &len);
+        nvs_close(nvs);
+    }
+    if (ret == ESP_OK && len == sizeof(saved) && imu_rates_apply(r, &saved) == ESP_OK) {
+        return ESP_OK;
+    }
+    if (ret == ESP_OK) {
+        ESP_LOGW(TAG, "Ignoring invalid rates in NVS");
+    }
+    return imu_rates_apply(r, &r->defaults);
+}
+
+/**
+ * @brief Save the applied rates to NVS
+ */
+esp_err_t imu_rates_save(const ImuRates *r) {
+    if (r == NULL) return ESP_ERR_INVALID_ARG;
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(IMU_RATES_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs, "rates", &r->rates, sizeof(r->rates));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Rates applied but not saved: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief Apply the defaults and erase the saved rates
+ */
+esp_err_t imu_rates_reset(ImuRates *r) {
+    if (r == NULL) return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = imu_rates_apply(r, &r->defaults);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    nvs_handle_t nvs;
+    ret = nvs_open(IMU_RATES_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_erase_key(nvs, "rates");
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    }
+    nvs_close(nvs);
+    return ret;
+}
@@ -0,0 +1,82 @@
+#ifndef IMU_RATES_H
+#define IMU_RATES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "imu.h"
+#include "imu_fifo.h"
+#include "imu_classifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_RATES_NVS_NAMESPACE "imu_rates"
+
+/**
+ * @brief One rate per layer of the IMU pipeline
+ */
+typedef struct {
+    uint32_t odr_hz;           /**< Sample layer: accel + gyro rate in the chip FIFO */
+    uint32_t window_ms;        /**< Feature layer: motion classifier window (hop is half of it) */
+    uint32_t event_ms;         /**< Event layer: idle/resume bookkeeping period */
+} imu_rates_t;
+
+/**
+ * @brief Owns the three rates and pushes changes to the layers that use them
+ *
+ * Sample: FIFO ODR, with the watermark rescaled to keep batch_ms per wakeup.
+ * Feature: classifier window in samples at the actual ODR (nearest power of two).
+ * Event: activity check period on the IMU, idle time is real time.
+ */
+typedef struct ImuRates {
+    ICM20948_t *dev;
+    ImuFifo *fifo;             // may be NULL (sample layer is then the polled monitor)
+    ImuClassifier *clf;        // may be NULL
+    imu_rates_t rates;         // last applied
+    imu_rates_t defaults;
+    uint32_t batch_ms;         // FIFO batch period kept across ODR changes (bounds alert latency)
+} ImuRates;
+
+/**
+ * @brief Create the rate manager (nothing is applied until imu_rates_apply)
+ */
+ImuRates *imu_rates_create(ICM20948_t *dev, ImuFifo *fifo, ImuClassifier *clf,
+                           const imu_rates_t *defaults, uint32_t batch_ms);
+
+/**
+ * @brief Destroy the rate manager
+ */
+void imu_rates_destroy(ImuRates *r);
+
+/**
+ * @brief Validate and apply all three layers (the FIFO restarts only if running)
+ */
+esp_err_t imu_rates_apply(ImuRates *r, const imu_rates_t *rates);
+
+/**
+ * @brief Apply the rates saved in NVS, or the defaults if there are none
+ */
+esp_err_t imu_rates_load(ImuRates *r);
+
+/**
+ * @brief Save the applied rates to NVS
+ */
+esp_err_t imu_rates_save(const ImuRates *r);
+
+/**
+ * @brief Apply the defaults and erase the saved rates
+ */
+esp_err_t imu_rates_reset(ImuRates *r);
+
+/**
+ * @brief Classifier window in samples for a window length at a sample rate
+ */
+uint32_t imu_rates_window_samples(uint32_t window_ms, float odr_hz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_RATES_H
@@ -0,0 +1,200 @@
+#include "imu_wake.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+
+static const char *TAG = "IMU_WAKE";
+
+#define IMU_WAKE_MIN_CHECK_MS 100   // Shortest sleep while counting down to idle
+
+/**
+ * @brief Get current time in milliseconds (same clock as last_motion_ms)
+ */
+static inline uint32_t imu_wake_millis(void) {
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+/**
+ * @brief Wake-on-motion pulse: resume from the task
+ */
+static void IRAM_ATTR imu_wake_isr(void *arg) {
+    ImuWake *wake = (ImuWake *)arg;
+    BaseType_t woken = pdFALSE;
+    wake->wom_fired = true;
+    if (wake->task != NULL) {
+        vTaskNotifyGiveFromISR(wake->task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Hand INT1 to wake-on-motion and drop to low power
+ */
+static void imu_wake_park(ImuWake *wake) {
+    // No FIFO (re)start from BLE or imu_rates between the stop and wake-on-motion
+    imu_fifo_lock(wake->fifo);
+    wake->fifo_was_running = imu_fifo_is_running(wake->fifo);
+    imu_fifo_stop(wake->fifo);
+
+    if (icm20948_wom_enable(wake->dev, wake->cfg.wom_thr_mg, wake->cfg.cycle_hz) != ESP_OK) {
+        // Stay awake rather than park without a way back
+        wake->dev->last_motion_ms = imu_wake_millis();
+        if (wake->fifo_was_running) {
+            imu_fifo_start(wake->fifo, &wake->fifo->cfg, wake->fifo->priority);
+        }
+        imu_fifo_unlock(wake->fifo);
+        return;
+    }
+
+    wake->wom_fired = false;
+    gpio_isr_handler_add(wake->int_pin, imu_wake_isr, wake);
+    gpio_intr_enable(wake->int_pin);
+    imu_fifo_unlock(wake->fifo);
+
+    wake->dev->in_motion = false;
+    wake->parks++;
+    wake->parked_us = esp_timer_get_time();
+    if (wake->cb) {
+        wake->cb(wake->ctx, IMU_WAKE_PARKED);
+    }
+}
+
+/**
+ * @brief Release INT1, back to full power (and FIFO batching if it was on)
+ */
+static void imu_wake_unpark(ImuWake *wake) {
+    imu_fifo_lock(wake->fifo);
+    gpio_intr_disable(wake->int_pin);
+    gpio_isr_handler_remove(wake->int_pin);
+
+    uint8_t status = 0;
+    icm20948_read_int_status(wake->dev, &status);
+    icm20948_wom_disable(wake->dev);
+    wake->dev->last_motion_ms = imu_wake_millis();
+
+    if (wake->fifo_was_running) {
+        imu_fifo_start(wake->fifo, &wake->fifo->cfg, wake->fifo->priority);
+    }
+    imu_fifo_unlock(wake->fifo);
+}
+
+/**
+ * @brief Wake task: count down to idle from the last motion, then sleep until the interrupt
+ */
+static void imu_wake_task(void *arg) {
+    ImuWake *wake = (ImuWake *)arg;
+
+    while (wake->running) {
+        if (!wake->dev->parked) {
+            uint32_t idle = wake->dev->in_motion ? 0 : imu_wake_millis() - wake->dev->last_motion_ms;
+            if (idle >= wake->cfg.idle_ms) {
+                ESP_LOGI(TAG, "No motion for %lu s, parking IMU", idle / 1000);
+                imu_wake_park(wake);
+                continue;
+            }
+            uint32_t wait = wake->cfg.idle_ms - idle;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait < IMU_WAKE_MIN_CHECK_MS ? IMU_WAKE_MIN_CHECK_MS : wait));
+            continue;
+        }
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!wake->running || !wake->wom_fired) {
+            continue;
+        }
+        wake->wom_fired = false;
+        imu_wake_unpark(wake);
+        ESP_LOGI(TAG, "Wake-on-motion after %lld s parked",
+                 (esp_timer_get_time() - wake->parked_us) / 1000000LL);
+        if (wake->cb) {
+            wake->cb(wake->ctx, IMU_WAKE_RESUMED);
+        }
+    }
+
+    task_stop_exit(&wake->stop);
+}
+
+/**
+ * @brief Create the idle/resume handler (not started)
+ */
+ImuWake *imu_wake_create(ICM20948_t *dev, ImuFifo *fifo, gpio_num_t int_pin,
+                         const imu_wake_config_t *config, imu_wake_cb_t cb, void *ctx) {
+    if (dev == NULL || config == NULL || config->idle_ms == 0) {
+        return NULL;
+    }
+    ImuWake *wake = (ImuWake *)calloc(1, sizeof(ImuWake));
+    if (wake == NULL) {
+        return NULL;
+    }
+    task_stop_init(&wake->stop);
+    wake->dev = dev;
+    wake->fifo = fifo;
+    wake->int_pin = int_pin;
+    wake->cfg = *config;
+    wake->cb = cb;
+    wake->ctx = ctx;
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << int_pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,   // INT1 is active high, push-pull
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    gpio_config(&io_conf);
+    return wake;
+}
+
+/**
+ * @brief Destroy the handler
+ */
+void imu_wake_destroy(ImuWake *wake) {
+    if (wake == NULL) return;
+    imu_wake_stop(wake);
+    free(wake);
+}
+
+/**
+ * @brief Start watching for idle (the idle time counts from now)
+ */
+esp_err_t imu_wake_start(ImuWake *wake, UBaseType_t priority) {
+    if (wake == NULL) return ESP_ERR_INVALID_ARG;
+    if (wake->running) return ESP_OK;
+
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+
+    wake->dev->last_motion_ms = imu_wake_millis();
+    wake->running = true;
+    if (xTaskCreate(imu_wake_task, "imu_wake", 3072, wake, priority, &wake->task) != pdPASS) {
+        wake->running = false;
+        ESP_LOGE(TAG, "Failed to create wake task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Parking after %lu s still (wake above %lu mg, INT on GPIO %d)",
+             wake->cfg.idle_ms / 1000, wake->cfg.wom_thr_mg, wake->int_pin);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop, returning the IMU to full power if parked (the FIFO is left stopped)
+ */
+void imu_wake_stop(ImuWake *wake) {
+    if (wake == NULL || !wake->running) return;
+    wake->running = false;
+    task_stop_join(&wake->stop, &wake->task);
+    if (wake->dev->parked) {
+        gpio_intr_disable(wake->int_pin);
+        gpio_isr_handler_remove(wake->int_pin);
+        icm20948_wom_disable(wake->dev);
+    }
+}
+
+/**
+ * @brief Whether the handler is running
+ */
+bool imu_wake_is_running(const ImuWake *wake) {
+    return wake ? wake->running : false;
+}
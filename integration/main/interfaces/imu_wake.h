@@ -0,0 +1,92 @@
+#ifndef IMU_WAKE_H
+#define IMU_WAKE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "driver/gpio.h"
+#include "imu.h"
+#include "imu_fifo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Park state changes
+ */
+typedef enum {
+    IMU_WAKE_PARKED = 0,       /**< No motion for idle_ms, IMU in low-power wake-on-motion */
+    IMU_WAKE_RESUMED,          /**< Wake-on-motion fired, IMU back at full rate */
+} imu_wake_event_t;
+
+/**
+ * @brief Park/resume callback, runs in the wake task
+ */
+typedef void (*imu_wake_cb_t)(void *ctx, imu_wake_event_t evt);
+
+/**
+ * @brief Park tuning
+ */
+typedef struct {
+    uint32_t idle_ms;          /**< No motion for this long parks the IMU */
+    uint32_t wom_thr_mg;       /**< Sample-to-sample accel change that wakes it (4 mg steps) */
+    uint32_t cycle_hz;         /**< Accel rate while parked */
+} imu_wake_config_t;
+
+/**
+ * @brief Idle/resume state machine on the IMU wake-on-motion interrupt
+ *
+ * Shares INT1 with the FIFO batcher: the FIFO is stopped while parked and
+ * restarted with its last config on wake.
+ */
+typedef struct ImuWake {
+    ICM20948_t *dev;
+    ImuFifo *fifo;             // may be NULL (motion then comes from polling)
+    gpio_num_t int_pin;
+    imu_wake_config_t cfg;
+    imu_wake_cb_t cb;
+    void *ctx;
+
+    volatile bool wom_fired;   // set by the ISR
+    bool fifo_was_running;
+    uint32_t parks;
+    int64_t parked_us;         // esp_timer time of the last park
+
+    TaskHandle_t task;
+    TaskStop stop;
+    volatile bool running;
+} ImuWake;
+
+/**
+ * @brief Create the idle/resume handler (not started)
+ */
+ImuWake *imu_wake_create(ICM20948_t *dev, ImuFifo *fifo, gpio_num_t int_pin,
+                         const imu_wake_config_t *config, imu_wake_cb_t cb, void *ctx);
+
+/**
+ * @brief Destroy the handler
+ */
+void imu_wake_destroy(ImuWake *wake);
+
+/**
+ * @brief Start watching for idle (the idle time counts from now)
+ */
+esp_err_t imu_wake_start(ImuWake *wake, UBaseType_t priority);
+
+/**
+ * @brief Stop, returning the IMU to full power if parked (the FIFO is left stopped)
+ */
+void imu_wake_stop(ImuWake *wake);
+
+/**
+ * @brief Whether the handler is running
+ */
+bool imu_wake_is_running(const ImuWake *wake);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_WAKE_H
@@ -28,6 +28,8 @@ struct item_rfid_reader {
     int burst_tag_count;
     
     item_rfid_tag_t unique_tags[ITEM_RFID_MAX_TAGS];
+    int unique_rssi_sum[ITEM_RFID_MAX_TAGS];
+    int unique_rssi_reads[ITEM_RFID_MAX_TAGS];
     int unique_tag_count;
     
     uint8_t rx_buffer[64];
@@ -55,15 +57,38 @@ static inline int item_rfid_read_byte(item_rfid_reader_t *reader, uint8_t *byte_
 }
 
 /**
- * @brief Check if a tag already exists in the unique tags list
+ * @brief Find a tag in the unique tags list
+ *
+ * @return Index of the tag, or -1 if not present
  */
-static bool item_rfid_tag_exists(item_rfid_reader_t *reader, const char *tag) {
+static int item_rfid_find_tag(item_rfid_reader_t *reader, const char *tag) {
     for (int i = 0; i < reader->unique_tag_count; i++) {
         if (strcmp(reader->unique_tags[i].tag, tag) == 0) {
-            return true;
+            return i;
         }
     }
-    return false;
+    return -1;
+}
+
+/**
+ * @brief Fold one read into the per-tag statistics of the unique list
+ */
+static void item_rfid_accumulate_read(item_rfid_reader_t *reader, int idx, int rssi) {
+    item_rfid_tag_t *entry = &reader->unique_tags[idx];
+    entry->read_count++;
+
+    if (rssi == -999) return; // reader did not report RSSI for this frame
+
+    if (reader->unique_rssi_reads[idx] == 0) {
+        entry->rssi = rssi;
+        entry->rssi_min = rssi;
+    } else {
+        if (rssi > entry->rssi) entry->rssi = rssi;
+        if (rssi < entry->rssi_min) entry->rssi_min = rssi;
+    }
+    reader->unique_rssi_sum[idx] += rssi;
+    reader->unique_rssi_reads[idx]++;
+    entry->rssi_mean = reader->unique_rssi_sum[idx] / reader->unique_rssi_reads[idx];
 }
 
 /**
@@ -73,10 +98,17 @@ static void item_rfid_process_burst(item_rfid_reader_t *reader) {
     if (reader->burst_tag_count == 0) return;
     
     for (int i = 0; i < reader->burst_tag_count; i++) {
-        if (!item_rfid_tag_exists(reader, reader->burst_tags[i].tag) &&
-            reader->unique_tag_count < ITEM_RFID_MAX_TAGS) {
-            reader->unique_tags[reader->unique_tag_count++] = reader->burst_tags[i];
+        int idx = item_rfid_find_tag(reader, reader->burst_tags[i].tag);
+        if (idx < 0) {
+            if (reader->unique_tag_count >= ITEM_RFID_MAX_TAGS) continue;
+            idx = reader->unique_tag_count++;
+            strncpy(reader->unique_tags[idx].tag, reader->burst_tags[i].tag,
+                    sizeof(reader->unique_tags[idx].tag) - 1);
+            reader->unique_tags[idx].rssi = -999;
+            reader->unique_tags[idx].rssi_min = -999;
+            reader->unique_tags[idx].rssi_mean = -999;
         }
+        item_rfid_accumulate_read(reader, idx, reader->burst_tags[i].rssi);
     }
     
     reader->burst_tag_count = 0;
@@ -126,6 +158,8 @@ static void item_rfid_scan_internal(item_rfid_reader_t *reader) {
     reader->collecting = false;
     reader->buffer_index = 0;
     memset(reader->unique_tags, 0, sizeof(reader->unique_tags));
+    memset(reader->unique_rssi_sum, 0, sizeof(reader->unique_rssi_sum));
+    memset(reader->unique_rssi_reads, 0, sizeof(reader->unique_rssi_reads));
     memset(reader->burst_tags, 0, sizeof(reader->burst_tags));
     
     // Send start command
@@ -195,7 +229,9 @@ static void item_rfid_scan_internal(item_rfid_reader_t *reader) {
 
     // Log each unique tag
     for (int i = 0; i < reader->unique_tag_count; i++) {
-        ESP_LOGI(TAG, "Tag[%d]: %s (RSSI: %d)", i, reader->unique_tags[i].tag, reader->unique_tags[i].rssi);
+        ESP_LOGI(TAG, "Tag[%d]: %s (RSSI: %d/%d/%d, reads: %d)", i, reader->unique_tags[i].tag,
+                 reader->unique_tags[i].rssi_min, reader->unique_tags[i].rssi_mean,
+                 reader->unique_tags[i].rssi, reader->unique_tags[i].read_count);
     }
 }
 
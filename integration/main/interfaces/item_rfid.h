@@ -20,7 +20,10 @@ extern "C" {
  */
 typedef struct {
     char tag[64];              /**< Tag ID in hex string format */
-    int rssi;                  /**< Signal strength in dBm */
+    int rssi;                  /**< Signal strength in dBm (strongest read in the scan) */
+    int rssi_min;              /**< Weakest read in the scan */
+    int rssi_mean;             /**< Mean over all reads in the scan */
+    int read_count;            /**< Number of times the tag was read during the scan */
 } item_rfid_tag_t;
 
 /**
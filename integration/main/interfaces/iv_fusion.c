@@ -0,0 +1,488 @@
+#include "iv_fusion.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "IV_FUSION";
+
+#define UPC_LEN 15
+
+// Severity per finding, summed and capped at 100
+#define SEVERITY_UNSCANNED_TAG       60
+#define SEVERITY_UNSCANNED_TAG_WEAK  25
+#define SEVERITY_UNSCANNED_WEIGHT    50
+#define SEVERITY_NOT_PLACED          20   // Once, however many: light items never register a weight
+#define SEVERITY_WEIGHT_MISMATCH     40
+#define SEVERITY_WEIGHT_MISMATCH_BIG 60
+#define MISMATCH_BIG_FACTOR 3.0f    // Deviation beyond this many tolerances is a failure on its own
+#define SEVERITY_FAIL                60
+#define SEVERITY_SUSPECT             20
+
+// A removal cancels a pending addition if it is within this fraction of it
+#define TAKE_BACK_TOLERANCE 0.2f
+
+/**
+ * @brief Weight addition not yet explained by a barcode
+ */
+typedef struct {
+    float delta_g;
+    uint32_t t_ms;
+} pending_weight_t;
+
+/**
+ * @brief Barcode not yet explained by a weight addition
+ */
+typedef struct {
+    char upc[UPC_LEN + 1];
+    uint32_t t_ms;
+} pending_barcode_t;
+
+static iv_fusion_config_t fusion_cfg = {
+    .window_ms = 10000,
+    .min_item_g = 20.0f,
+};
+static SemaphoreHandle_t fusion_mutex = NULL;
+
+static pending_weight_t weights[IV_FUSION_MAX_PENDING];
+static int weight_count = 0;
+static pending_barcode_t barcodes[IV_FUSION_MAX_PENDING];
+static int barcode_count = 0;
+
+/**
+ * @brief Expected weight of one UPC in the basket
+ */
+typedef struct {
+    char upc[UPC_LEN + 1];
+    float total_g;             // Sum over units: produce units under one key weigh differently
+    float var_g2;              // Sum of squared per-unit tolerances
+    uint16_t qty;              // 0 = empty slot
+} expected_item_t;
+
+static expected_item_t expected[IV_FUSION_MAX_EXPECTED];
+static bool expect_active = false;   // Pi has pushed expected weights this session
+
+static int tags_in_basket = 0;
+static int tags_uncertain = 0;
+static float measured_g = 0.0f;
+static float cleared_offset_g = 0.0f;  // Measured minus expected accepted by the last staff clear
+static bool delta_mismatch = false;    // A settled change fit no expected item, until the basket total is checked
+static int scanned_items = 0;
+static int placed_items = 0;
+
+static bool frozen = false;
+static iv_verdict_level_t last_level = IV_VERDICT_OK;
+static uint32_t last_reasons = IV_REASON_NONE;
+
+/**
+ * @brief Get current time in milliseconds
+ */
+static inline uint32_t iv_fusion_millis(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+/**
+ * @brief Remove entry i from a pending array, keeping arrival order
+ */
+#define PENDING_REMOVE(arr, count, i) do { \
+    memmove(&(arr)[i], &(arr)[(i) + 1], ((count) - (i) - 1) * sizeof((arr)[0])); \
+    (count)--; \
+} while (0)
+
+/**
+ * @brief Find a UPC in the expected table, optionally allocating a slot
+ */
+static expected_item_t *iv_fusion_find_expected(const char *upc, bool create) {
+    expected_item_t *free_slot = NULL;
+    for (int i = 0; i < IV_FUSION_MAX_EXPECTED; i++) {
+        if (expected[i].qty > 0) {
+            if (strcmp(expected[i].upc, upc) == 0) {
+                return &expected[i];
+            }
+        } else if (free_slot == NULL) {
+            free_slot = &expected[i];
+        }
+    }
+    if (!create || free_slot == NULL) {
+        return NULL;
+    }
+    strncpy(free_slot->upc, upc, UPC_LEN);
+    free_slot->upc[UPC_LEN] = '\0';
+    return free_slot;
+}
+
+/**
+ * @brief Expected basket weight and its tolerance (caller holds the mutex)
+ *
+ * Per-item tolerances are independent, so they add as root-sum-square.
+ */
+static float iv_fusion_expected_total(float *tol_out) {
+    float total = 0.0f, var = 0.0f;
+    for (int i = 0; i < IV_FUSION_MAX_EXPECTED; i++) {
+        if (expected[i].qty > 0) {
+            total += expected[i].total_g;
+            var += expected[i].var_g2;
+        }
+    }
+    if (tol_out) {
+        *tol_out = sqrtf(var) + fusion_cfg.min_item_g;
+    }
+    return total;
+}
+
+/**
+ * @brief Whether a settled change fits one unit of an expected or scanned item (caller holds the mutex)
+ */
+static bool iv_fusion_delta_fits(float delta_g) {
+    float unit_g = fabsf(delta_g);
+    for (int i = 0; i < IV_FUSION_MAX_EXPECTED; i++) {
+        if (expected[i].qty > 0) {
+            float tol_g = sqrtf(expected[i].var_g2 / expected[i].qty) + fusion_cfg.min_item_g;
+            if (fabsf(unit_g - expected[i].total_g / expected[i].qty) <= tol_g) {
+                return true;
+            }
+        }
+    }
+    // A scanned item the Pi has not priced in yet can't be judged
+    for (int i = 0; delta_g > 0.0f && i < barcode_count; i++) {
+        if (iv_fusion_find_expected(barcodes[i].upc, false) == NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Initialize the fusion engine
+ */
+esp_err_t iv_fusion_init(const iv_fusion_config_t *config) {
+    if (fusion_mutex == NULL) {
+        fusion_mutex = xSemaphoreCreateMutex();
+        if (fusion_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (config) {
+        fusion_cfg = *config;
+    }
+    iv_fusion_reset();
+
+    ESP_LOGI(TAG, "Fusion engine ready (window=%lu ms, min item=%.0f g)",
+             fusion_cfg.window_ms, fusion_cfg.min_item_g);
+    return ESP_OK;
+}
+
+/**
+ * @brief Drop all events and findings and unfreeze checkout (new session)
+ */
+void iv_fusion_reset(void) {
+    if (fusion_mutex == NULL) return;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+    weight_count = 0;
+    barcode_count = 0;
+    tags_in_basket = 0;
+    tags_uncertain = 0;
+    measured_g = 0.0f;
+    cleared_offset_g = 0.0f;
+    delta_mismatch = false;
+    scanned_items = 0;
+    placed_items = 0;
+    memset(expected, 0, sizeof(expected));
+    expect_active = false;
+    frozen = false;
+    last_level = IV_VERDICT_OK;
+    last_reasons = IV_REASON_NONE;
+    xSemaphoreGive(fusion_mutex);
+}
+
+/**
+ * @brief Report a settled basket weight
+ */
+void iv_fusion_on_weight(float total_g, float delta_g) {
+    if (fusion_mutex == NULL) return;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+    measured_g = total_g;
+
+    // Check each change as it arrives, the basket total only once nothing is in flight
+    if (expect_active && fabsf(delta_g) >= fusion_cfg.min_item_g && !iv_fusion_delta_fits(delta_g)) {
+        bool taken_back = false;
+        for (int i = 0; delta_g < 0.0f && i < weight_count; i++) {
+            taken_back = taken_back || fabsf(weights[i].delta_g + delta_g) <= fmaxf(fusion_cfg.min_item_g, weights[i].delta_g * TAKE_BACK_TOLERANCE);
+        }
+        if (!taken_back) {
+            ESP_LOGW(TAG, "%+.0f g fits no expected item", delta_g);
+            delta_mismatch = true;
+        }
+    }
+
+    if (delta_g >= fusion_cfg.min_item_g) {
+        placed_items++;
+        if (barcode_count > 0) {
+            // Prefer the scanned item whose expected weight fits, else the oldest
+            int match = 0;
+            for (int i = 0; i < barcode_count; i++) {
+                expected_item_t *e = iv_fusion_find_expected(barcodes[i].upc, false);
+                if (e != NULL && fabsf(delta_g - e->total_g / e->qty) <= sqrtf(e->var_g2 / e->qty)) {
+                    match = i;
+                    break;
+                }
+            }
+            ESP_LOGI(TAG, "+%.0f g matched barcode %s", delta_g, barcodes[match].upc);
+            PENDING_REMOVE(barcodes, barcode_count, match);
+        } else {
+            if (weight_count == IV_FUSION_MAX_PENDING) {
+                ESP_LOGW(TAG, "Pending weight list full, dropping oldest");
+                PENDING_REMOVE(weights, weight_count, 0);
+            }
+            weights[weight_count].delta_g = delta_g;
+            weights[weight_count].t_ms = iv_fusion_millis();
+            weight_count++;
+            ESP_LOGI(TAG, "+%.0f g waiting for a barcode", delta_g);
+        }
+    } else if (delta_g <= -fusion_cfg.min_item_g) {
+        // An unscanned item taken straight back out resolves itself
+        for (int i = weight_count - 1; i >= 0; i--) {
+            if (fabsf(weights[i].delta_g + delta_g) <= fmaxf(fusion_cfg.min_item_g, weights[i].delta_g * TAKE_BACK_TOLERANCE)) {
+                ESP_LOGI(TAG, "%.0f g cancels pending +%.0f g", delta_g, weights[i].delta_g);
+                PENDING_REMOVE(weights, weight_count, i);
+                placed_items--;
+                break;
+            }
+        }
+    }
+
+    xSemaphoreGive(fusion_mutex);
+}
+
+/**
+ * @brief Report a barcode read
+ */
+void iv_fusion_on_barcode(const char *upc) {
+    if (fusion_mutex == NULL || !upc) return;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+    scanned_items++;
+
+    if (weight_count > 0) {
+        // Item was placed before it was scanned
+        ESP_LOGI(TAG, "Barcode %s matched pending +%.0f g", upc, weights[0].delta_g);
+        PENDING_REMOVE(weights, weight_count, 0);
+    } else {
+        if (barcode_count == IV_FUSION_MAX_PENDING) {
+            ESP_LOGW(TAG, "Pending barcode list full, dropping oldest");
+            PENDING_REMOVE(barcodes, barcode_count, 0);
+        }
+        strncpy(barcodes[barcode_count].upc, upc, UPC_LEN);
+        barcodes[barcode_count].upc[UPC_LEN] = '\0';
+        barcodes[barcode_count].t_ms = iv_fusion_millis();
+        barcode_count++;
+    }
+
+    xSemaphoreGive(fusion_mutex);
+}
+
+/**
+ * @brief Report the unscanned product tags found by one completed RFID scan
+ */
+void iv_fusion_on_tags(int in_basket, int uncertain) {
+    if (fusion_mutex == NULL) return;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+    tags_in_basket = in_basket;
+    tags_uncertain = uncertain;
+    xSemaphoreGive(fusion_mutex);
+}
+
+/**
+ * @brief Add one item with its expected weight to the expected basket
+ */
+esp_err_t iv_fusion_expect_add(const char *upc, float weight_g, float tol_g) {
+    if (fusion_mutex == NULL || !upc || upc[0] == '\0' || weight_g < 0.0f || tol_g < 0.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+    expect_active = true;
+    expected_item_t *e = iv_fusion_find_expected(upc, true);
+    if (e != NULL) {
+        e->total_g += weight_g;
+        e->var_g2 += tol_g * tol_g;
+        e->qty++;
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(fusion_mutex);
+    return ret;
+}
+
+/**
+ * @brief Remove one unit of a UPC from the expected basket
+ */
+void iv_fusion_expect_remove(const char *upc, float weight_g) {
+    if (fusion_mutex == NULL || !upc) return;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+    expected_item_t *e = iv_fusion_find_expected(upc, false);
+    if (e != NULL) {
+        if (e->qty <= 1) {
+            memset(e, 0, sizeof(*e));
+        } else {
+            e->total_g -= (weight_g >= 0.0f) ? weight_g : e->total_g / e->qty;
+            e->var_g2 -= e->var_g2 / e->qty;
+            e->qty--;
+            if (e->total_g < 0.0f) e->total_g = 0.0f;
+        }
+    }
+    xSemaphoreGive(fusion_mutex);
+}
+
+/**
+ * @brief Empty the expected basket (also enables the weight check)
+ */
+void iv_fusion_expect_clear(void) {
+    if (fusion_mutex == NULL) return;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+    memset(expected, 0, sizeof(expected));
+    expect_active = true;
+    xSemaphoreGive(fusion_mutex);
+}
+
+/**
+ * @brief Age pending events and compute the current verdict
+ */
+bool iv_fusion_evaluate(iv_verdict_t *out) {
+    if (fusion_mutex == NULL) return false;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+
+    uint32_t now = iv_fusion_millis();
+    uint32_t reasons = IV_REASON_NONE;
+    int severity = 0;
+    bool in_window = false;
+
+    // Events still inside the window may yet be matched, only expired ones count
+    for (int i = 0; i < weight_count; i++) {
+        if (now - weights[i].t_ms >= fusion_cfg.window_ms) {
+            reasons |= IV_REASON_UNSCANNED_WEIGHT;
+            severity += SEVERITY_UNSCANNED_WEIGHT;
+        } else {
+            in_window = true;
+        }
+    }
+    for (int i = 0; i < barcode_count; i++) {
+        if (now - barcodes[i].t_ms >= fusion_cfg.window_ms) {
+            reasons |= IV_REASON_NOT_PLACED;
+        } else {
+            in_window = true;
+        }
+    }
+    if (reasons & IV_REASON_NOT_PLACED) {
+        severity += SEVERITY_NOT_PLACED;
+    }
+
+    // Settled basket vs. expected basket once nothing is still in flight, until then
+    // a change that fit no expected item stands in for it
+    float tol_g = 0.0f;
+    float expected_g = iv_fusion_expected_total(&tol_g);
+    if (expect_active && !in_window) {
+        delta_mismatch = false;
+        float diff = measured_g - cleared_offset_g - expected_g;
+        if (fabsf(diff) > tol_g) {
+            reasons |= IV_REASON_WEIGHT_MISMATCH;
+            severity += (fabsf(diff) > MISMATCH_BIG_FACTOR * tol_g) ? SEVERITY_WEIGHT_MISMATCH_BIG : SEVERITY_WEIGHT_MISMATCH;
+        }
+    } else if (delta_mismatch) {
+        reasons |= IV_REASON_WEIGHT_MISMATCH;
+        severity += SEVERITY_WEIGHT_MISMATCH;
+    }
+    if (tags_in_basket > 0) {
+        reasons |= IV_REASON_UNSCANNED_TAG;
+        severity += tags_in_basket * SEVERITY_UNSCANNED_TAG;
+    }
+    if (tags_uncertain > 0) {
+        reasons |= IV_REASON_UNSCANNED_TAG_WEAK;
+        severity += tags_uncertain * SEVERITY_UNSCANNED_TAG_WEAK;
+    }
+    if (severity > 100) {
+        severity = 100;
+    }
+
+    iv_verdict_level_t level = IV_VERDICT_OK;
+    if (severity >= SEVERITY_FAIL) {
+        level = IV_VERDICT_FAIL;
+    } else if (severity >= SEVERITY_SUSPECT) {
+        level = IV_VERDICT_SUSPECT;
+    }
+
+    // Freeze on the first failure, thaw once the evidence agrees again
+    if (level == IV_VERDICT_FAIL) {
+        frozen = true;
+    } else if (level == IV_VERDICT_OK) {
+        frozen = false;
+    }
+
+    bool changed = (level != last_level || reasons != last_reasons);
+    last_level = level;
+    last_reasons = reasons;
+
+    if (out) {
+        out->level = level;
+        out->confidence = (level == IV_VERDICT_OK) ? (uint8_t)(100 - severity) : (uint8_t)severity;
+        out->reasons = reasons;
+        out->measured_g = measured_g;
+        out->expected_g = expected_g;
+        out->scanned_items = scanned_items;
+        out->placed_items = placed_items;
+    }
+
+    xSemaphoreGive(fusion_mutex);
+    return changed;
+}
+
+/**
+ * @brief Whether checkout is frozen by a failed verdict
+ */
+bool iv_fusion_checkout_frozen(void) {
+    return frozen;
+}
+
+/**
+ * @brief Staff override: drop current findings and unfreeze checkout
+ */
+void iv_fusion_clear(void) {
+    if (fusion_mutex == NULL) return;
+    xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+
+    uint32_t now = iv_fusion_millis();
+    for (int i = weight_count - 1; i >= 0; i--) {
+        if (now - weights[i].t_ms >= fusion_cfg.window_ms) {
+            PENDING_REMOVE(weights, weight_count, i);
+        }
+    }
+    for (int i = barcode_count - 1; i >= 0; i--) {
+        if (now - barcodes[i].t_ms >= fusion_cfg.window_ms) {
+            PENDING_REMOVE(barcodes, barcode_count, i);
+        }
+    }
+    tags_in_basket = 0;
+    tags_uncertain = 0;
+    // Accept the basket as it is now, later items are checked against it
+    cleared_offset_g = measured_g - iv_fusion_expected_total(NULL);
+    delta_mismatch = false;
+    frozen = false;
+
+    xSemaphoreGive(fusion_mutex);
+    ESP_LOGI(TAG, "Findings cleared, checkout unfrozen");
+}
+
+/**
+ * @brief Get a short name for a verdict level
+ */
+const char *iv_verdict_str(iv_verdict_level_t level) {
+    switch (level) {
+        case IV_VERDICT_OK:      return "OK";
+        case IV_VERDICT_SUSPECT: return "SUSPECT";
+        case IV_VERDICT_FAIL:    return "FAIL";
+        default:                 return "UNKNOWN";
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef IV_FUSION_H
+#define IV_FUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IV_GRAMS_PER_LB 453.59237f
+
+/**
+ * @brief Number of unmatched weight or barcode events kept per stream
+ */
+#define IV_FUSION_MAX_PENDING 16
+
+/**
+ * @brief Number of distinct UPCs with an expected weight
+ */
+#define IV_FUSION_MAX_EXPECTED 64
+
+/**
+ * @brief Overall verification verdict
+ */
+typedef enum {
+    IV_VERDICT_OK = 0,         /**< Weight, barcodes and tags agree */
+    IV_VERDICT_SUSPECT,        /**< Some evidence does not line up - report only */
+    IV_VERDICT_FAIL,           /**< Strong evidence of an unscanned item - checkout frozen */
+} iv_verdict_level_t;
+
+/**
+ * @brief Reason codes (bitmask) explaining a verdict
+ */
+#define IV_REASON_NONE              0x00
+#define IV_REASON_UNSCANNED_WEIGHT  0x01   /**< Weight added with no barcode scanned in the window */
+#define IV_REASON_NOT_PLACED        0x02   /**< Barcode scanned with no weight added in the window */
+#define IV_REASON_UNSCANNED_TAG     0x04   /**< In-basket RFID tag whose UPC was never scanned */
+#define IV_REASON_UNSCANNED_TAG_WEAK 0x08  /**< Uncertain RFID tag whose UPC was never scanned */
+#define IV_REASON_WEIGHT_MISMATCH   0x10   /**< Settled change or basket weight outside the expected weight tolerance */
+
+/**
+ * @brief Fusion configuration
+ */
+typedef struct {
+    uint32_t window_ms;        /**< Time a weight change and a barcode may be apart and still match */
+    float min_item_g;          /**< Settled weight changes smaller than this are ignored */
+} iv_fusion_config_t;
+
+/**
+ * @brief Verification verdict with supporting state
+ */
+typedef struct {
+    iv_verdict_level_t level;
+    uint8_t confidence;        /**< 0-100, confidence in the reported level */
+    uint32_t reasons;          /**< IV_REASON_* bitmask */
+    float measured_g;          /**< Last settled basket weight */
+    float expected_g;          /**< Sum of expected weights pushed by the Pi */
+    int scanned_items;         /**< Barcodes seen this session */
+    int placed_items;          /**< Weight additions seen this session */
+} iv_verdict_t;
+
+/**
+ * @brief Initialize the fusion engine
+ */
+esp_err_t iv_fusion_init(const iv_fusion_config_t *config);
+
+/**
+ * @brief Drop all events and findings and unfreeze checkout (new session)
+ */
+void iv_fusion_reset(void);
+
+/**
+ * @brief Report a settled basket weight
+ *
+ * @param total_g New settled weight
+ * @param delta_g Change from the previous settled weight
+ */
+void iv_fusion_on_weight(float total_g, float delta_g);
+
+/**
+ * @brief Report a barcode read
+ */
+void iv_fusion_on_barcode(const char *upc);
+
+/**
+ * @brief Report the unscanned product tags found by one completed RFID scan
+ *
+ * Replaces the tag findings of the previous scan.
+ *
+ * @param in_basket Unscanned tags classified as in-basket
+ * @param uncertain Unscanned tags classified as uncertain
+ */
+void iv_fusion_on_tags(int in_basket, int uncertain);
+
+/**
+ * @brief Add one item with its expected weight to the expected basket
+ *
+ * Units under one UPC add up, so produce weighings can share a key.
+ *
+ * @param upc      Product UPC
+ * @param weight_g Expected weight of one unit
+ * @param tol_g    Allowed deviation for one unit
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM when the table is full
+ */
+esp_err_t iv_fusion_expect_add(const char *upc, float weight_g, float tol_g);
+
+/**
+ * @brief Remove one unit of a UPC from the expected basket
+ *
+ * @param weight_g Weight that unit was added with (produce), or < 0 for the UPC's average unit
+ */
+void iv_fusion_expect_remove(const char *upc, float weight_g);
+
+/**
+ * @brief Empty the expected basket (also enables the weight check)
+ */
+void iv_fusion_expect_clear(void);
+
+/**
+ * @brief Age pending events and compute the current verdict
+ *
+ * @param out Current verdict
+ * @return true if the level or reasons changed since the last call
+ */
+bool iv_fusion_evaluate(iv_verdict_t *out);
+
+/**
+ * @brief Whether checkout is frozen by a failed verdict
+ */
+bool iv_fusion_checkout_frozen(void);
+
+/**
+ * @brief Staff override: drop current findings and unfreeze checkout
+ *
+ * The basket weight as it stands becomes the reference for the weight check,
+ * so a mismatch the staff accepted does not freeze checkout again.
+ */
+void iv_fusion_clear(void);
+
+/**
+ * @brief Get a short name for a verdict level
+ */
+const char *iv_verdict_str(iv_verdict_level_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IV_FUSION_H
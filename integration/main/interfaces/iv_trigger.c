@@ -0,0 +1,141 @@
+#include "iv_trigger.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+#include <string.h>
+
+static const char *TAG = "IV_TRIGGER";
+
+static EventGroupHandle_t trigger_group = NULL;
+static iv_trigger_config_t trigger_cfg;
+static iv_trigger_stats_t trigger_stats;
+static uint32_t last_scan_ms = 0;
+
+/**
+ * @brief Get current time in milliseconds
+ */
+static inline uint32_t iv_trigger_millis(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+/**
+ * @brief Initialize the trigger policy engine
+ */
+esp_err_t iv_trigger_init(const iv_trigger_config_t *config) {
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (trigger_group == NULL) {
+        trigger_group = xEventGroupCreate();
+        if (trigger_group == NULL) {
+            ESP_LOGE(TAG, "Failed to create event group");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    trigger_cfg = *config;
+    iv_trigger_reset();
+
+    ESP_LOGI(TAG, "Trigger engine ready (debounce=%lu ms, min interval=%lu ms, fallback=%lu ms)",
+             trigger_cfg.debounce_ms, trigger_cfg.min_interval_ms, trigger_cfg.fallback_interval_ms);
+    return ESP_OK;
+}
+
+/**
+ * @brief Request a scan from one or more sources (task context, non-blocking)
+ */
+void iv_trigger_post(uint32_t sources) {
+    if (trigger_group == NULL || (sources & IV_TRIGGER_ALL) == 0) {
+        return;
+    }
+
+    trigger_stats.triggers++;
+    xEventGroupSetBits(trigger_group, sources & IV_TRIGGER_ALL);
+}
+
+/**
+ * @brief Block until a debounced scan is due or the timeout expires
+ */
+uint32_t iv_trigger_wait(TickType_t timeout) {
+    if (trigger_group == NULL) {
+        vTaskDelay(timeout);
+        return IV_TRIGGER_NONE;
+    }
+
+    // Never sleep past the fallback deadline
+    uint32_t since_scan = iv_trigger_millis() - last_scan_ms;
+    uint32_t until_fallback = (since_scan < trigger_cfg.fallback_interval_ms)
+                            ? trigger_cfg.fallback_interval_ms - since_scan : 0;
+    TickType_t wait = pdMS_TO_TICKS(until_fallback);
+    if (timeout < wait) {
+        wait = timeout;
+    }
+
+    uint32_t bits = xEventGroupWaitBits(trigger_group, IV_TRIGGER_ALL | IV_TRIGGER_CANCEL, pdTRUE, pdFALSE, wait);
+    if (bits & IV_TRIGGER_CANCEL) {
+        // Sources set alongside the cancel stay pending for the next wait
+        xEventGroupSetBits(trigger_group, bits & IV_TRIGGER_ALL);
+        return IV_TRIGGER_NONE;
+    }
+    uint32_t sources = bits & IV_TRIGGER_ALL;
+
+    if (sources == IV_TRIGGER_NONE) {
+        if ((iv_trigger_millis() - last_scan_ms) < trigger_cfg.fallback_interval_ms) {
+            return IV_TRIGGER_NONE;
+        }
+        sources = IV_TRIGGER_PERIODIC;
+    }
+
+    // Debounce: a barcode scan, the item settling on the scale and the cart
+    // being pushed off usually arrive together, so collapse them into one scan
+    if (sources != IV_TRIGGER_PERIODIC && trigger_cfg.debounce_ms > 0) {
+        vTaskDelay(pdMS_TO_TICKS(trigger_cfg.debounce_ms));
+        sources |= xEventGroupClearBits(trigger_group, IV_TRIGGER_ALL) & IV_TRIGGER_ALL;
+    }
+
+    // Rate limit back-to-back scans, keep collecting triggers meanwhile
+    uint32_t elapsed = iv_trigger_millis() - last_scan_ms;
+    if (elapsed < trigger_cfg.min_interval_ms) {
+        vTaskDelay(pdMS_TO_TICKS(trigger_cfg.min_interval_ms - elapsed));
+        sources |= xEventGroupClearBits(trigger_group, IV_TRIGGER_ALL) & IV_TRIGGER_ALL;
+    }
+
+    last_scan_ms = iv_trigger_millis();
+    trigger_stats.scans++;
+    if (sources == IV_TRIGGER_PERIODIC) {
+        trigger_stats.periodic_scans++;
+    }
+
+    ESP_LOGD(TAG, "Scan released (sources=0x%02lx)", sources);
+    return sources;
+}
+
+/**
+ * @brief Wake a task blocked in iv_trigger_wait with IV_TRIGGER_NONE (to let it stop)
+ */
+void iv_trigger_cancel(void) {
+    if (trigger_group != NULL) {
+        xEventGroupSetBits(trigger_group, IV_TRIGGER_CANCEL);
+    }
+}
+
+/**
+ * @brief Drop pending triggers and restart the fallback timer
+ */
+void iv_trigger_reset(void) {
+    if (trigger_group != NULL) {
+        xEventGroupClearBits(trigger_group, IV_TRIGGER_ALL | IV_TRIGGER_CANCEL);
+    }
+    last_scan_ms = iv_trigger_millis();
+    memset(&trigger_stats, 0, sizeof(trigger_stats));
+}
+
+/**
+ * @brief Get trigger statistics
+ */
+void iv_trigger_get_stats(iv_trigger_stats_t *stats) {
+    if (stats) {
+        *stats = trigger_stats;
+    }
+}
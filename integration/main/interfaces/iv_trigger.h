@@ -0,0 +1,82 @@
+#ifndef IV_TRIGGER_H
+#define IV_TRIGGER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sources that can request an item verification RFID scan (bitmask)
+ */
+typedef enum {
+    IV_TRIGGER_NONE     = 0,
+    IV_TRIGGER_WEIGHT   = (1 << 0),  /**< Settled cart weight changed */
+    IV_TRIGGER_BARCODE  = (1 << 1),  /**< Barcode was scanned */
+    IV_TRIGGER_MOTION   = (1 << 2),  /**< IMU motion state changed */
+    IV_TRIGGER_MANUAL   = (1 << 3),  /**< Requested over BLE */
+    IV_TRIGGER_PERIODIC = (1 << 4),  /**< Slow fallback timer expired */
+} iv_trigger_source_t;
+
+#define IV_TRIGGER_ALL (IV_TRIGGER_WEIGHT | IV_TRIGGER_BARCODE | IV_TRIGGER_MOTION | \
+                        IV_TRIGGER_MANUAL | IV_TRIGGER_PERIODIC)
+#define IV_TRIGGER_CANCEL (1 << 7)   // Internal: iv_trigger_cancel, never returned as a source
+
+/**
+ * @brief Trigger policy configuration
+ */
+typedef struct {
+    uint32_t debounce_ms;           /**< Window in which further triggers are coalesced into one scan */
+    uint32_t min_interval_ms;       /**< Minimum time between two scans */
+    uint32_t fallback_interval_ms;  /**< Periodic scan when no trigger arrives */
+} iv_trigger_config_t;
+
+/**
+ * @brief Trigger statistics (used to report RF duty cycle)
+ */
+typedef struct {
+    uint32_t scans;                 /**< Scans released by the engine */
+    uint32_t triggers;              /**< Individual trigger posts received */
+    uint32_t periodic_scans;        /**< Scans released only by the fallback timer */
+} iv_trigger_stats_t;
+
+/**
+ * @brief Initialize the trigger policy engine
+ */
+esp_err_t iv_trigger_init(const iv_trigger_config_t *config);
+
+/**
+ * @brief Request a scan from one or more sources (task context, non-blocking)
+ */
+void iv_trigger_post(uint32_t sources);
+
+/**
+ * @brief Block until a debounced scan is due or the timeout expires
+ *
+ * @return Bitmask of iv_trigger_source_t that caused the scan, 0 on timeout
+ */
+uint32_t iv_trigger_wait(TickType_t timeout);
+
+/**
+ * @brief Wake a task blocked in iv_trigger_wait with IV_TRIGGER_NONE (to let it stop)
+ */
+void iv_trigger_cancel(void);
+
+/**
+ * @brief Drop pending triggers and restart the fallback timer
+ */
+void iv_trigger_reset(void);
+
+/**
+ * @brief Get trigger statistics
+ */
+void iv_trigger_get_stats(iv_trigger_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IV_TRIGGER_H
@@ -0,0 +1,288 @@
+#include "loadcell_group.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "soc/gpio_reg.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "LOADCELL_GROUP";
+
+#define LOAD_CELL_GROUP_WAIT_MS 200   // HX711 at 10 SPS: every cell is ready at least this often
+
+static portMUX_TYPE group_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Cells whose DOUT is low (conversion ready), bit i for cell i
+ */
+static uint8_t load_cell_group_ready(const LoadCellGroup* grp) {
+    uint32_t in0 = REG_READ(GPIO_IN_REG);
+    uint32_t in1 = REG_READ(GPIO_IN1_REG);
+    uint8_t ready = 0;
+    for (int i = 0; i < grp->count; i++) {
+        gpio_num_t pin = grp->cells[i]->data_pin;
+        uint32_t level = (pin < 32) ? (in0 >> pin) & 1 : (in1 >> (pin - 32)) & 1;
+        if (level == 0) {
+            ready |= 1 << i;
+        }
+    }
+    return ready;
+}
+
+/**
+ * @brief Which cells to clock now: all awaited ones, or the ready ones once a late cell timed out
+ *
+ * @return 0 to keep waiting
+ */
+static uint8_t load_cell_group_select(LoadCellGroup* grp, uint8_t ready) {
+    uint8_t all = (1 << grp->count) - 1;
+    grp->absent &= ~ready;      // a dead cell that converts again rejoins
+    uint8_t awaited = all & ~grp->absent;
+
+    if (ready == 0) {
+        grp->partial_since_us = 0;
+        return 0;
+    }
+    if ((ready & awaited) != awaited) {
+        int64_t now = esp_timer_get_time();
+        if (grp->partial_since_us == 0) {
+            grp->partial_since_us = now;
+        }
+        if (now - grp->partial_since_us < LOAD_CELL_GROUP_PARTIAL_MS * 1000LL) {
+            return 0;
+        }
+        for (int i = 0; i < grp->count; i++) {
+            if ((awaited & ~ready & (1 << i)) && ++grp->missed[i] >= LOAD_CELL_GROUP_DEAD_FRAMES) {
+                grp->absent |= 1 << i;
+                ESP_LOGW(TAG, "Cell %d (DOUT GPIO %d) stopped converting, clocking the others without it",
+                         i, grp->cells[i]->data_pin);
+            }
+        }
+    }
+    for (int i = 0; i < grp->count; i++) {
+        if (ready & (1 << i)) {
+            grp->missed[i] = 0;
+        }
+    }
+    grp->partial_since_us = 0;
+    return ready;
+}
+
+/**
+ * @brief Clock 24 data bits + 1 gain pulse out of the selected cells at once
+ *
+ * Runs with interrupts masked on this core so PD_SCK can never be stretched
+ * into the HX711's power-down time (25 pulses take about 60 us).
+ */
+static void load_cell_group_clock_out(const LoadCellGroup* grp, uint8_t cells, int32_t* raw) {
+    uint32_t val[LOAD_CELL_GROUP_MAX] = {0};
+    uint32_t clk_mask[2] = {0};
+    for (int i = 0; i < grp->count; i++) {
+        if (cells & (1 << i)) {
+            gpio_num_t clk = grp->cells[i]->clk_pin;
+            clk_mask[clk / 32] |= 1UL << (clk % 32);
+        }
+    }
+
+    portENTER_CRITICAL(&group_spinlock);
+    for (int bit = 0; bit < 24; bit++) {
+        REG_WRITE(GPIO_OUT_W1TS_REG, clk_mask[0]);
+        REG_WRITE(GPIO_OUT1_W1TS_REG, clk_mask[1]);
+        esp_rom_delay_us(1);
+        uint32_t in0 = REG_READ(GPIO_IN_REG);
+        uint32_t in1 = REG_READ(GPIO_IN1_REG);
+        REG_WRITE(GPIO_OUT_W1TC_REG, clk_mask[0]);
+        REG_WRITE(GPIO_OUT1_W1TC_REG, clk_mask[1]);
+
+        for (int i = 0; i < grp->count; i++) {
+            gpio_num_t pin = grp->cells[i]->data_pin;
+            uint32_t level = (pin < 32) ? (in0 >> pin) & 1 : (in1 >> (pin - 32)) & 1;
+            val[i] = (val[i] << 1) | level;
+        }
+        esp_rom_delay_us(1);
+    }
+
+    // gain pulse for the next conversion
+    REG_WRITE(GPIO_OUT_W1TS_REG, clk_mask[0]);
+    REG_WRITE(GPIO_OUT1_W1TS_REG, clk_mask[1]);
+    esp_rom_delay_us(1);
+    REG_WRITE(GPIO_OUT_W1TC_REG, clk_mask[0]);
+    REG_WRITE(GPIO_OUT1_W1TC_REG, clk_mask[1]);
+    portEXIT_CRITICAL(&group_spinlock);
+
+    for (int i = 0; i < grp->count; i++) {
+        if (val[i] & 0x800000) {
+            val[i] |= 0xFF000000;
+        }
+        raw[i] = (int32_t)val[i];
+    }
+}
+
+/**
+ * @brief Any DOUT falling edge: wake the group task to check if all are ready
+ */
+static void IRAM_ATTR load_cell_group_dout_isr(void* arg) {
+    LoadCellGroup* grp = (LoadCellGroup*)arg;
+    BaseType_t woken = pdFALSE;
+    if (grp->task != NULL) {
+        vTaskNotifyGiveFromISR(grp->task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Group task: clock all cells as soon as all are ready, publish the frame
+ */
+static void load_cell_group_task(void* arg) {
+    LoadCellGroup* grp = (LoadCellGroup*)arg;
+
+    while (grp->running) {
+        // A ready cell makes no further edge, so re-check soon while one is late
+        uint32_t wait_ms = grp->partial_since_us ? LOAD_CELL_GROUP_PARTIAL_MS / 4 : LOAD_CELL_GROUP_WAIT_MS;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+        if (!grp->running) {
+            continue;
+        }
+        uint8_t cells = load_cell_group_select(grp, load_cell_group_ready(grp));
+        if (cells == 0) {
+            continue;
+        }
+
+        load_cell_frame_t frame = { .t_us = esp_timer_get_time(), .count = grp->count, .valid = cells };
+        load_cell_group_clock_out(grp, cells, frame.raw);
+        ulTaskNotifyTake(pdTRUE, 0); // drop edges caused by our own clocking
+
+        // Per-cell pipeline (tare, filters, weight reads); a skipped cell publishes nothing
+        for (int i = 0; i < grp->count; i++) {
+            if (cells & (1 << i)) {
+                load_cell_publish_sample(grp->cells[i], frame.raw[i]);
+            }
+        }
+
+        // Unified stream of timestamped frames
+        uint32_t head = grp->ring_head;
+        if (head - __atomic_load_n(&grp->ring_tail, __ATOMIC_ACQUIRE) < LOAD_CELL_GROUP_RING_SIZE) {
+            grp->ring[head & (LOAD_CELL_GROUP_RING_SIZE - 1)] = frame;
+            __atomic_store_n(&grp->ring_head, head + 1, __ATOMIC_RELEASE);
+            if (grp->consumer_task != NULL) {
+                xTaskNotifyGive(grp->consumer_task);
+            }
+        } else {
+            grp->frames_dropped++;
+        }
+    }
+
+    task_stop_exit(&grp->stop);
+}
+
+/**
+ * @brief Create a group; all cells must use the GPIO backend
+ */
+LoadCellGroup* load_cell_group_create(LoadCell** cells, uint8_t count) {
+    if (cells == NULL || count == 0 || count > LOAD_CELL_GROUP_MAX) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        if (cells[i] == NULL || cells[i]->backend != LOAD_CELL_BACKEND_GPIO) {
+            ESP_LOGE(TAG, "Cell %d cannot be grouped (missing or not on the GPIO backend)", i);
+            return NULL;
+        }
+    }
+
+    LoadCellGroup* grp = (LoadCellGroup*)calloc(1, sizeof(LoadCellGroup));
+    if (grp == NULL) {
+        return NULL;
+    }
+    task_stop_init(&grp->stop);
+    grp->count = count;
+    for (int i = 0; i < count; i++) {
+        grp->cells[i] = cells[i];
+    }
+    return grp;
+}
+
+/**
+ * @brief Destroy a group
+ */
+void load_cell_group_destroy(LoadCellGroup* grp) {
+    if (grp == NULL) return;
+    load_cell_group_stop(grp);
+    free(grp);
+}
+
+/**
+ * @brief Start synchronized acquisition
+ */
+esp_err_t load_cell_group_start(LoadCellGroup* grp, UBaseType_t priority) {
+    if (grp == NULL) return ESP_ERR_INVALID_ARG;
+    if (grp->running) return ESP_OK;
+
+    // The group owns the clock lines from here on
+    for (int i = 0; i < grp->count; i++) {
+        load_cell_stop_sampling(grp->cells[i]);
+        grp->cells[i]->ring_head = 0;
+        grp->cells[i]->ring_tail = 0;
+        grp->cells[i]->sampling = true;
+    }
+    grp->ring_head = 0;
+    grp->ring_tail = 0;
+    grp->frames_dropped = 0;
+    grp->absent = 0;
+    grp->partial_since_us = 0;
+    memset(grp->missed, 0, sizeof(grp->missed));
+
+    grp->running = true;
+    if (xTaskCreate(load_cell_group_task, "hx711_group", 4096, grp, priority, &grp->task) != pdPASS) {
+        grp->running = false;
+        for (int i = 0; i < grp->count; i++) {
+            grp->cells[i]->sampling = false;
+        }
+        ESP_LOGE(TAG, "Failed to create group task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        load_cell_group_stop(grp);
+        return ret;
+    }
+    for (int i = 0; i < grp->count; i++) {
+        gpio_set_intr_type(grp->cells[i]->data_pin, GPIO_INTR_NEGEDGE);
+        gpio_isr_handler_add(grp->cells[i]->data_pin, load_cell_group_dout_isr, grp);
+        gpio_intr_enable(grp->cells[i]->data_pin);
+    }
+
+    ESP_LOGI(TAG, "Synchronized acquisition started for %d load cells", grp->count);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop synchronized acquisition
+ */
+void load_cell_group_stop(LoadCellGroup* grp) {
+    if (grp == NULL || !grp->running) return;
+
+    for (int i = 0; i < grp->count; i++) {
+        gpio_intr_disable(grp->cells[i]->data_pin);
+        gpio_isr_handler_remove(grp->cells[i]->data_pin);
+    }
+    grp->running = false;
+    task_stop_join(&grp->stop, &grp->task);
+    for (int i = 0; i < grp->count; i++) {
+        grp->cells[i]->sampling = false;
+    }
+    ESP_LOGI(TAG, "Synchronized acquisition stopped");
+}
+
+/**
+ * @brief Pop the oldest frame from the group stream
+ */
+bool load_cell_group_pop(LoadCellGroup* grp, load_cell_frame_t* frame) {
+    uint32_t tail = grp->ring_tail;
+    if (tail == __atomic_load_n(&grp->ring_head, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *frame = grp->ring[tail & (LOAD_CELL_GROUP_RING_SIZE - 1)];
+    __atomic_store_n(&grp->ring_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
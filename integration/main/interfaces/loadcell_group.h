@@ -0,0 +1,89 @@
+#ifndef LOADCELL_GROUP_H
+#define LOADCELL_GROUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "loadcells.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOAD_CELL_GROUP_MAX 4          // Produce + cart today, four basket corners on the PCB
+#define LOAD_CELL_GROUP_RING_SIZE 16   // Frames buffered for the group consumer (power of two)
+#define LOAD_CELL_GROUP_PARTIAL_MS 150 // Wait this long for a late cell (> one 10 SPS conversion), then clock the ready ones
+#define LOAD_CELL_GROUP_DEAD_FRAMES 3  // Partial frames a cell misses before the group stops waiting for it
+
+/**
+ * @brief One synchronized conversion from every cell in the group
+ */
+typedef struct {
+    int64_t t_us;                      // esp_timer time the frame was clocked out
+    uint8_t count;
+    uint8_t valid;                     // bit i set if raw[i] is a new conversion (a dead cell is skipped)
+    int32_t raw[LOAD_CELL_GROUP_MAX];  // in the order the cells were given to load_cell_group_create
+} load_cell_frame_t;
+
+/**
+ * @brief HX711s clocked together from one timed routine
+ */
+typedef struct LoadCellGroup {
+    LoadCell* cells[LOAD_CELL_GROUP_MAX];
+    uint8_t count;
+
+    TaskHandle_t task;
+    TaskStop stop;
+    TaskHandle_t consumer_task;        // notified after each frame, may be NULL
+    volatile bool running;
+
+    // Group task only
+    uint8_t absent;                    // cells not waited for until their DOUT goes low again
+    uint8_t missed[LOAD_CELL_GROUP_MAX];// consecutive partial frames without each cell
+    int64_t partial_since_us;          // first time some but not all awaited cells were ready, 0 if none
+
+    load_cell_frame_t ring[LOAD_CELL_GROUP_RING_SIZE];
+    volatile uint32_t ring_head;       // written by the group task only
+    volatile uint32_t ring_tail;       // written by the consumer only
+    volatile uint32_t frames_dropped;
+} LoadCellGroup;
+
+/**
+ * @brief Create a group; all cells must use the GPIO backend
+ */
+LoadCellGroup* load_cell_group_create(LoadCell** cells, uint8_t count);
+
+/**
+ * @brief Destroy a group
+ */
+void load_cell_group_destroy(LoadCellGroup* grp);
+
+/**
+ * @brief Start synchronized acquisition
+ *
+ * Replaces the cells' own samplers. Each conversion is still published to
+ * its cell, so per-cell tare, filters and weight reads keep working. A cell
+ * that stops converting is clocked without after LOAD_CELL_GROUP_PARTIAL_MS,
+ * and no longer waited for after LOAD_CELL_GROUP_DEAD_FRAMES such frames, so
+ * the others keep their rate; it rejoins on its next conversion.
+ */
+esp_err_t load_cell_group_start(LoadCellGroup* grp, UBaseType_t priority);
+
+/**
+ * @brief Stop synchronized acquisition
+ */
+void load_cell_group_stop(LoadCellGroup* grp);
+
+/**
+ * @brief Pop the oldest frame from the group stream
+ *
+ * @return false if no frame is available
+ */
+bool load_cell_group_pop(LoadCellGroup* grp, load_cell_frame_t* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOADCELL_GROUP_H
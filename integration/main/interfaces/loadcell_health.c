@@ -0,0 +1,230 @@
+#include "loadcell_health.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <math.h>
+
+static const char *TAG = "LOADCELL_HEALTH";
+
+#define LOAD_CELL_SATURATED_SAMPLES 3   // Full-scale codes in a row before reporting
+
+/**
+ * @brief Get current time in milliseconds
+ */
+static inline uint32_t load_cell_health_millis(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+/**
+ * @brief Track the zero while the scale is empty, settled and still
+ *
+ * @return true if the zero has drifted past az_max_total_g
+ */
+static bool load_cell_health_auto_zero(LoadCellHealth *mon, load_cell_health_entry_t *e) {
+    LoadCell *lc = e->lc;
+    if (e->wf == NULL || lc->taring ||
+        !weight_filter_is_settled(e->wf) || !weight_filter_is_confident(e->wf)) {
+        return e->state == LOAD_CELL_HEALTH_DRIFT;
+    }
+
+    int32_t residual = lc->latest_filtered - lc->tare_offset;
+    float residual_g = load_cell_raw_to_grams(lc, lc->latest_filtered);
+    if (residual == 0 || residual_g == 0.0f || fabsf(residual_g) > mon->cfg.az_band_g) {
+        return e->state == LOAD_CELL_HEALTH_DRIFT;  // something on the scale, or already zero
+    }
+
+    float g_per_count = residual_g / residual;
+    float step_g = residual_g * mon->cfg.az_gain;
+    step_g = fmaxf(fminf(step_g, mon->cfg.az_max_step_g), -mon->cfg.az_max_step_g);
+    int32_t step = (int32_t)lroundf(step_g / g_per_count);
+    if (step == 0) {
+        step = residual > 0 ? 1 : -1;
+    }
+
+    if (fabsf((lc->zero_adjust + step) * g_per_count) > mon->cfg.az_max_total_g) {
+        return true;
+    }
+    load_cell_adjust_zero(lc, step);
+    ESP_LOGD(TAG, "%s auto-zero %ld counts (total %.2f g)", e->name, step, load_cell_health_zero_g(e));
+    return false;
+}
+
+/**
+ * @brief Classify one load cell
+ */
+static load_cell_health_t load_cell_health_check(LoadCellHealth *mon, load_cell_health_entry_t *e, uint32_t now) {
+    LoadCell *lc = e->lc;
+
+    // A new tare clears a drift report
+    if (lc->tare_generation != e->tare_generation) {
+        e->tare_generation = lc->tare_generation;
+        if (e->state == LOAD_CELL_HEALTH_DRIFT) {
+            e->state = LOAD_CELL_HEALTH_OK;
+        }
+    }
+
+    // Progress: conversions from the sampler, or blocking reads that didn't time out
+    uint32_t count = lc->sample_count;
+    uint32_t timeouts = lc->read_timeouts;
+    if (count != e->last_count) {
+        e->last_count = count;
+        e->last_progress_ms = now;
+    }
+    bool timed_out = timeouts != e->last_timeouts;
+    e->last_timeouts = timeouts;
+
+    if (timed_out || (lc->sampling && now - e->last_progress_ms >= mon->cfg.stall_ms)) {
+        return LOAD_CELL_HEALTH_STALLED;
+    }
+    if (!lc->sampling) {
+        e->last_progress_ms = now;  // stopped on purpose (outdoor mode)
+        return e->state == LOAD_CELL_HEALTH_STALLED ? LOAD_CELL_HEALTH_OK : e->state;
+    }
+    if (lc->saturated_run >= LOAD_CELL_SATURATED_SAMPLES) {
+        return LOAD_CELL_HEALTH_SATURATED;
+    }
+    if (lc->repeat_run >= mon->cfg.stuck_samples) {
+        return LOAD_CELL_HEALTH_STUCK;
+    }
+    return load_cell_health_auto_zero(mon, e) ? LOAD_CELL_HEALTH_DRIFT : LOAD_CELL_HEALTH_OK;
+}
+
+/**
+ * @brief Monitor task: check every cell, report state changes
+ */
+static void load_cell_health_task(void *arg) {
+    LoadCellHealth *mon = (LoadCellHealth *)arg;
+
+    while (mon->running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(mon->cfg.interval_ms));
+        if (!mon->running) {
+            break;
+        }
+
+        uint32_t now = load_cell_health_millis();
+        for (int i = 0; i < mon->count; i++) {
+            load_cell_health_entry_t *e = &mon->entries[i];
+            load_cell_health_t state = load_cell_health_check(mon, e, now);
+
+            // A tare would wait forever for conversions that aren't coming
+            if (state == LOAD_CELL_HEALTH_STALLED && e->lc->taring) {
+                load_cell_tare_abort(e->lc);
+            }
+
+            if (state != e->state) {
+                if (state == LOAD_CELL_HEALTH_OK) {
+                    ESP_LOGI(TAG, "%s load cell recovered", e->name);
+                } else {
+                    ESP_LOGW(TAG, "%s load cell %s", e->name, load_cell_health_str(state));
+                }
+                e->state = state;
+                if (mon->cb) {
+                    mon->cb(e->name, e->lc, state);
+                }
+            }
+        }
+    }
+
+    task_stop_exit(&mon->stop);
+}
+
+/**
+ * @brief Create a monitor
+ */
+LoadCellHealth *load_cell_health_create(const load_cell_health_config_t *config, load_cell_health_cb_t cb) {
+    if (config == NULL || config->interval_ms == 0) {
+        return NULL;
+    }
+    LoadCellHealth *mon = (LoadCellHealth *)calloc(1, sizeof(LoadCellHealth));
+    if (mon == NULL) {
+        return NULL;
+    }
+    task_stop_init(&mon->stop);
+    mon->cfg = *config;
+    mon->cb = cb;
+    return mon;
+}
+
+/**
+ * @brief Destroy a monitor
+ */
+void load_cell_health_destroy(LoadCellHealth *mon) {
+    if (mon == NULL) return;
+    load_cell_health_stop(mon);
+    free(mon);
+}
+
+/**
+ * @brief Watch a load cell; wf enables auto-zero while it is settled near zero
+ */
+esp_err_t load_cell_health_add(LoadCellHealth *mon, LoadCell *lc, WeightFilter *wf, const char *name) {
+    if (mon == NULL || lc == NULL) return ESP_ERR_INVALID_ARG;
+    if (mon->count >= LOAD_CELL_HEALTH_MAX) return ESP_ERR_NO_MEM;
+
+    load_cell_health_entry_t *e = &mon->entries[mon->count];
+    e->lc = lc;
+    e->wf = wf;
+    e->name = name;
+    e->state = LOAD_CELL_HEALTH_OK;
+    e->last_count = lc->sample_count;
+    e->last_timeouts = lc->read_timeouts;
+    e->last_progress_ms = load_cell_health_millis();
+    e->tare_generation = lc->tare_generation;
+    mon->count++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Start the monitor task
+ */
+esp_err_t load_cell_health_start(LoadCellHealth *mon, UBaseType_t priority) {
+    if (mon == NULL) return ESP_ERR_INVALID_ARG;
+    if (mon->running) return ESP_OK;
+
+    uint32_t now = load_cell_health_millis();
+    for (int i = 0; i < mon->count; i++) {
+        mon->entries[i].last_progress_ms = now;
+    }
+
+    mon->running = true;
+    if (xTaskCreate(load_cell_health_task, "loadcell_health", 3072, mon, priority, &mon->task) != pdPASS) {
+        mon->running = false;
+        ESP_LOGE(TAG, "Failed to create monitor task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Monitoring %d load cells (stall %lu ms, stuck x%lu, auto-zero +/-%.1f g, max %.1f g)",
+             mon->count, mon->cfg.stall_ms, mon->cfg.stuck_samples, mon->cfg.az_band_g, mon->cfg.az_max_total_g);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop the monitor task
+ */
+void load_cell_health_stop(LoadCellHealth *mon) {
+    if (mon == NULL || !mon->running) return;
+    mon->running = false;
+    task_stop_join(&mon->stop, &mon->task);
+}
+
+/**
+ * @brief Auto-zero applied since the last tare, in grams
+ */
+float load_cell_health_zero_g(const load_cell_health_entry_t *entry) {
+    LoadCell *lc = entry->lc;
+    return load_cell_raw_to_grams(lc, lc->tare_offset + lc->zero_adjust);
+}
+
+/**
+ * @brief Get a short name for a health state
+ */
+const char *load_cell_health_str(load_cell_health_t state) {
+    switch (state) {
+        case LOAD_CELL_HEALTH_OK:        return "OK";
+        case LOAD_CELL_HEALTH_DRIFT:     return "DRIFT";
+        case LOAD_CELL_HEALTH_STUCK:     return "STUCK";
+        case LOAD_CELL_HEALTH_SATURATED: return "SATURATED";
+        case LOAD_CELL_HEALTH_STALLED:   return "STALLED";
+        default:                         return "UNKNOWN";
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef LOADCELL_HEALTH_H
+#define LOADCELL_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "loadcells.h"
+#include "weight_filter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOAD_CELL_HEALTH_MAX 4
+
+/**
+ * @brief Load cell condition, worst first
+ */
+typedef enum {
+    LOAD_CELL_HEALTH_OK = 0,
+    LOAD_CELL_HEALTH_DRIFT,        /**< Zero moved past the auto-zero limit, needs a tare */
+    LOAD_CELL_HEALTH_STUCK,        /**< Same code over and over (DOUT or CLK line stuck) */
+    LOAD_CELL_HEALTH_SATURATED,    /**< Full-scale codes (overload, broken bridge wire) */
+    LOAD_CELL_HEALTH_STALLED,      /**< No conversions (HX711 unpowered or disconnected) */
+} load_cell_health_t;
+
+/**
+ * @brief State change callback, runs in the monitor task
+ */
+typedef void (*load_cell_health_cb_t)(const char *name, LoadCell *lc, load_cell_health_t state);
+
+/**
+ * @brief Monitor tuning
+ */
+typedef struct {
+    uint32_t interval_ms;      /**< Check period */
+    uint32_t stall_ms;         /**< No new conversion for this long is a stall */
+    uint32_t stuck_samples;    /**< Identical conversions in a row counted as stuck */
+    float az_band_g;           /**< Auto-zero only tracks weights inside +/- this band... */
+    float az_gain;             /**< ...removing this fraction of the residual per check... */
+    float az_max_step_g;       /**< ...but never more than this per check... */
+    float az_max_total_g;      /**< ...or this much in total between tares */
+} load_cell_health_config_t;
+
+/**
+ * @brief One monitored load cell
+ */
+typedef struct {
+    LoadCell *lc;
+    WeightFilter *wf;          // settled/still gate for auto-zero, may be NULL (no auto-zero)
+    const char *name;
+    load_cell_health_t state;
+    uint32_t last_count;
+    uint32_t last_timeouts;
+    uint32_t last_progress_ms;
+    uint32_t tare_generation;
+} load_cell_health_entry_t;
+
+/**
+ * @brief Health and drift monitor
+ */
+typedef struct LoadCellHealth {
+    load_cell_health_config_t cfg;
+    load_cell_health_cb_t cb;
+    load_cell_health_entry_t entries[LOAD_CELL_HEALTH_MAX];
+    uint8_t count;
+    TaskHandle_t task;
+    TaskStop stop;
+    volatile bool running;
+} LoadCellHealth;
+
+/**
+ * @brief Create a monitor
+ */
+LoadCellHealth *load_cell_health_create(const load_cell_health_config_t *config, load_cell_health_cb_t cb);
+
+/**
+ * @brief Destroy a monitor
+ */
+void load_cell_health_destroy(LoadCellHealth *mon);
+
+/**
+ * @brief Watch a load cell; wf enables auto-zero while it is settled near zero
+ */
+esp_err_t load_cell_health_add(LoadCellHealth *mon, LoadCell *lc, WeightFilter *wf, const char *name);
+
+/**
+ * @brief Start the monitor task
+ */
+esp_err_t load_cell_health_start(LoadCellHealth *mon, UBaseType_t priority);
+
+/**
+ * @brief Stop the monitor task
+ */
+void load_cell_health_stop(LoadCellHealth *mon);
+
+/**
+ * @brief Auto-zero applied since the last tare, in grams
+ */
+float load_cell_health_zero_g(const load_cell_health_entry_t *entry);
+
+/**
+ * @brief Get a short name for a health state
+ */
+const char *load_cell_health_str(load_cell_health_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOADCELL_HEALTH_H
@@ -1,14 +1,32 @@
 #include "loadcells.h"
 #include <math.h>
 #include <time.h>
+#include <string.h>
 #include "esp_rom_sys.h"
+#include "esp_log.h"
+#include "nvs.h"
 
-void tare_task(void* arg) {
+static const char *TAG = "LOADCELL";
+
+#define LOAD_CELL_SAMPLE_TIMEOUT_MS 200  // HX711 converts at 10 SPS, so an edge is never further apart than this
+
+static esp_err_t load_cell_clock_out(LoadCell* lc, int32_t* raw);
+static int32_t load_cell_trimmed_mean(const int32_t* samples);
+
+/**
+ * @brief One-shot blocking tare for cells without a running sampler
+ */
+static void tare_task(void* arg) {
     LoadCell* lc = (LoadCell*)arg;
-    printf("Taring...\n");
+    ESP_LOGI(TAG, "Taring...");
     load_cell_tare(lc);
-    printf("Tare done. Offset = %.2f\n", lc->tare_offset);
+    ESP_LOGI(TAG, "Tare done. Offset = %ld", lc->tare_offset);
 
+    lc->tare_generation++;
+    lc->taring = false;
+    if (lc->tare_cb) {
+        lc->tare_cb(lc, lc->tare_ctx);
+    }
     vTaskDelete(NULL); // Done
 }
 
@@ -16,14 +34,16 @@ void tare_task(void* arg) {
  * @brief Create and initialize a load cell handle
  */
 LoadCell* load_cell_create(gpio_num_t clk_pin, gpio_num_t data_pin, uint8_t gain, bool type) {
-	LoadCell* cell = (LoadCell*) malloc(sizeof(LoadCell));
+	LoadCell* cell = (LoadCell*) calloc(1, sizeof(LoadCell));
 	if (cell == NULL) {
 		return NULL;
 	}
+	task_stop_init(&cell->sampler_stop);
 	cell->clk_pin = clk_pin;
 	cell->data_pin = data_pin;
 	cell->gain = gain;
 	cell->type = type;
+	load_cell_cal_default(cell);
 
 	return cell;
 }
@@ -33,6 +53,11 @@ LoadCell* load_cell_create(gpio_num_t clk_pin, gpio_num_t data_pin, uint8_t gain
  */
 void load_cell_destroy(LoadCell* lc) {
 	if (lc == NULL) return;
+	load_cell_stop_sampling(lc);
+	if (lc->backend == LOAD_CELL_BACKEND_SPI) {
+		spi_bus_remove_device(lc->spi);
+		spi_bus_free(lc->spi_host);
+	}
 	free(lc);
 }
 
@@ -88,17 +113,90 @@ void load_cell_reset(LoadCell* lc) {
  * @brief Calibrate load cell to zero (tare)
  */
 void load_cell_tare(LoadCell* lc) {
+	if (lc->sampling) {
+		// Let the sampler average the offset and wait for it
+		load_cell_tare_async(lc, NULL, NULL);
+		for (int waited = 0; lc->taring && waited < LOAD_CELL_TARE_TIMEOUT_MS; waited += 20) {
+			vTaskDelay(pdMS_TO_TICKS(20));
+		}
+		if (lc->taring) {
+			load_cell_tare_abort(lc);
+		}
+		return;
+	}
+
+	uint32_t failures = lc->read_timeouts + lc->read_errors;
 	long acc = 0;
 	for (int i = 0; i < 3; i++) {
 		acc += load_cell_average_channel(lc);
 	}
-	lc->tare_offset = (float)acc/3.0;
+	if (lc->read_timeouts + lc->read_errors != failures) {
+		ESP_LOGW(TAG, "Tare on DOUT GPIO %d failed, keeping offset %ld", lc->data_pin, lc->tare_offset);
+		return;
+	}
+	lc->tare_offset = (int32_t)(acc / 3);
+	lc->zero_adjust = 0;
+}
+
+/**
+ * @brief Start a tare and return immediately
+ */
+esp_err_t load_cell_tare_async(LoadCell* lc, load_cell_tare_cb_t cb, void* ctx) {
+	if (lc == NULL) return ESP_ERR_INVALID_ARG;
+	if (lc->taring) return ESP_ERR_INVALID_STATE;
+
+	lc->tare_cb = cb;
+	lc->tare_ctx = ctx;
+	lc->tare_acc = 0;
+	lc->tare_remaining = LOAD_CELL_TARE_SAMPLES;
+	lc->taring = true;
+
+	if (!lc->sampling) {
+		if (xTaskCreate(tare_task, "tare", 3072, lc, 5, NULL) != pdPASS) {
+			lc->taring = false;
+			return ESP_ERR_NO_MEM;
+		}
+	}
+	return ESP_OK;
+}
+
+/**
+ * @brief Whether a tare is in progress (weight reads are invalid)
+ */
+bool load_cell_is_taring(LoadCell* lc) {
+	return lc->taring;
+}
+
+/**
+ * @brief Give up on a tare that gets no conversions (keeps the old offset)
+ */
+void load_cell_tare_abort(LoadCell* lc) {
+	if (lc == NULL || !lc->taring) return;
+	lc->taring = false;
+	ESP_LOGW(TAG, "Tare on DOUT GPIO %d aborted, keeping offset %ld", lc->data_pin, lc->tare_offset);
+}
+
+/**
+ * @brief Nudge the zero by a few counts without re-seeding consumers (auto-zero)
+ */
+void load_cell_adjust_zero(LoadCell* lc, int32_t counts) {
+	if (lc == NULL || lc->taring) return;
+	lc->tare_offset += counts;
+	lc->zero_adjust += counts;
 }
 
 /**
  * @brief Read raw 24-bit value from load cell
  */
 int32_t load_cell_read_channel(LoadCell* lc) {
+	if (lc->sampling) {
+		// Sampler owns the clock line, wait for its next conversion
+		uint32_t count = __atomic_load_n(&lc->sample_count, __ATOMIC_ACQUIRE);
+		for (int waited = 0; waited < LOAD_CELL_SAMPLE_TIMEOUT_MS && __atomic_load_n(&lc->sample_count, __ATOMIC_ACQUIRE) == count; waited += 5) {
+			vTaskDelay(pdMS_TO_TICKS(5));
+		}
+		return lc->latest_raw;
+	}
 	load_cell_read_channel_raw(lc); // discard to set up gain
 	return (load_cell_read_channel_raw(lc));
 }
@@ -107,7 +205,49 @@ int32_t load_cell_read_channel(LoadCell* lc) {
  * @brief Read raw 24-bit value without discarding first read
  */
 int32_t load_cell_read_channel_raw(LoadCell* lc) {
-	while (gpio_get_level(lc->data_pin) == 1) vTaskDelay(pdMS_TO_TICKS(1));
+	TickType_t start = xTaskGetTickCount();
+	while (gpio_get_level(lc->data_pin) == 1) {
+		if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(LOAD_CELL_READY_TIMEOUT_MS)) {
+			// DOUT stuck high: HX711 unpowered, unplugged or held in power-down
+			lc->read_timeouts++;
+			return lc->latest_raw;
+		}
+		vTaskDelay(pdMS_TO_TICKS(1));
+	}
+	int32_t raw;
+	if (load_cell_clock_out(lc, &raw) != ESP_OK) {
+		return lc->latest_raw;
+	}
+	return raw;
+}
+
+/**
+ * @brief Clock out one conversion once DOUT is low, then the gain pulse
+ *
+ * @return ESP_OK, or the SPI error (counted in read_errors, raw untouched)
+ */
+static esp_err_t load_cell_clock_out(LoadCell* lc, int32_t* raw) {
+	if (lc->backend == LOAD_CELL_BACKEND_SPI) {
+		// 24 data bits + 1 gain pulse in one hardware transaction; timing cannot be stretched by preemption
+		spi_transaction_t t = {
+			.flags = SPI_TRANS_USE_RXDATA,
+			.length = 0,
+			.rxlength = 25,
+		};
+		esp_err_t ret = spi_device_polling_transmit(lc->spi, &t);
+		if (ret != ESP_OK) {
+			lc->read_errors++;
+			ESP_LOGW(TAG, "SPI read failed on DOUT %d: %s", lc->data_pin, esp_err_to_name(ret));
+			return ret;
+		}
+		uint32_t spi_val = ((uint32_t)t.rx_data[0] << 16) | ((uint32_t)t.rx_data[1] << 8) | t.rx_data[2];
+		if (spi_val & 0x800000) {
+			spi_val |= 0xFF000000;
+		}
+		*raw = (int32_t)spi_val;
+		return ESP_OK;
+	}
+
 	load_cell_clk_low(lc);
     uint32_t val = 0;
     for (int i = 0; i < 24; i++) { // read 24 bits
@@ -126,21 +266,87 @@ int32_t load_cell_read_channel_raw(LoadCell* lc) {
     	val |= 0xFF000000;
     }
 
-    return (int32_t)val;
+    *raw = (int32_t)val;
+    return ESP_OK;
+}
+
+/**
+ * @brief Clock this load cell from an SPI master instead of bit-banging
+ */
+esp_err_t load_cell_use_spi(LoadCell* lc, spi_host_device_t host) {
+	if (lc == NULL) return ESP_ERR_INVALID_ARG;
+
+	spi_bus_config_t buscfg = {
+		.miso_io_num = lc->data_pin,
+		.mosi_io_num = -1,
+		.sclk_io_num = lc->clk_pin,
+		.quadwp_io_num = -1,
+		.quadhd_io_num = -1,
+		.max_transfer_sz = 4,
+	};
+	esp_err_t ret = spi_bus_initialize(host, &buscfg, SPI_DMA_DISABLED);
+	if (ret != ESP_OK) {
+		ESP_LOGW(TAG, "SPI bus init failed (%d), keeping GPIO backend", ret);
+		return ret;
+	}
+
+	// Mode 1: SCLK idles low (keeps the HX711 awake), DOUT sampled on the falling edge
+	spi_device_interface_config_t devcfg = {
+		.clock_speed_hz = LOAD_CELL_SPI_CLOCK_HZ,
+		.mode = 1,
+		.spics_io_num = -1,
+		.flags = SPI_DEVICE_HALFDUPLEX,
+		.queue_size = 1,
+	};
+	ret = spi_bus_add_device(host, &devcfg, &lc->spi);
+	if (ret != ESP_OK) {
+		ESP_LOGW(TAG, "SPI device add failed (%d), keeping GPIO backend", ret);
+		spi_bus_free(host);
+		return ret;
+	}
+
+	// DOUT is still read as a GPIO for the ready check and interrupt
+	gpio_set_direction(lc->data_pin, GPIO_MODE_INPUT);
+	gpio_set_pull_mode(lc->data_pin, GPIO_PULLUP_ONLY);
+
+	lc->spi_host = host;
+	lc->backend = LOAD_CELL_BACKEND_SPI;
+	ESP_LOGI(TAG, "HX711 on CLK %d / DOUT %d clocked by SPI host %d", lc->clk_pin, lc->data_pin, host);
+	return ESP_OK;
 }
 
 /**
  * @brief Average multiple load cell readings
  */
 int32_t load_cell_average_channel(LoadCell* lc){
-	int32_t buf[5];
-	for (uint8_t i = 0; i < 5; i++) {
+	if (lc->sampling) {
+		// Wait for a full window of fresh conversions from the sampler
+		uint32_t start_count = __atomic_load_n(&lc->sample_count, __ATOMIC_ACQUIRE);
+		for (int waited = 0; waited < LOAD_CELL_FILTER_SIZE * LOAD_CELL_SAMPLE_TIMEOUT_MS; waited += 5) {
+			if (__atomic_load_n(&lc->sample_count, __ATOMIC_ACQUIRE) - start_count >= LOAD_CELL_FILTER_SIZE) break;
+			vTaskDelay(pdMS_TO_TICKS(5));
+		}
+		return lc->latest_filtered;
+	}
+
+	int32_t buf[LOAD_CELL_FILTER_SIZE];
+	for (uint8_t i = 0; i < LOAD_CELL_FILTER_SIZE; i++) {
 		buf [i] = load_cell_read_channel(lc);
     	vTaskDelay(pdMS_TO_TICKS(5));
 	}
 
+	return load_cell_trimmed_mean(buf);
+}
+
+/**
+ * @brief Mean of LOAD_CELL_FILTER_SIZE samples without the smallest and largest
+ */
+static int32_t load_cell_trimmed_mean(const int32_t* samples) {
+	int32_t buf[LOAD_CELL_FILTER_SIZE];
+	memcpy(buf, samples, sizeof(buf));
+
 	// insertion sort to isolate outliers
-	for (uint8_t i = 1; i < 5; i++) {
+	for (uint8_t i = 1; i < LOAD_CELL_FILTER_SIZE; i++) {
 		int32_t key = buf[i];
 		int8_t j = i-1;
 		while (j >= 0 && buf[j] > key) {
@@ -150,10 +356,10 @@ int32_t load_cell_average_channel(LoadCell* lc){
 		buf[j+1] = key;
 	}
 
-	// ignore two smallest and two largest values (potential outliers)
+	// ignore smallest and largest values (potential outliers)
 	int32_t sum = 0;
 	uint8_t start = 1;
-	uint8_t end = 4;
+	uint8_t end = LOAD_CELL_FILTER_SIZE - 1;
 
 	for (uint8_t i = start; i < end; i++) {
 		sum += buf[i];
@@ -163,48 +369,388 @@ int32_t load_cell_average_channel(LoadCell* lc){
 }
 
 /**
- * @brief Get weight reading in pounds
+ * @brief DOUT falling edge: a conversion is ready, wake the sampler
  */
-float load_cell_display_pounds(LoadCell* lc) {
-	int32_t raw = load_cell_average_channel(lc);
-	float net = raw - lc->tare_offset;
+static void IRAM_ATTR load_cell_dout_isr(void* arg) {
+	LoadCell* lc = (LoadCell*)arg;
+	BaseType_t woken = pdFALSE;
+	if (lc->sampler_task != NULL) {
+		vTaskNotifyGiveFromISR(lc->sampler_task, &woken);
+	}
+	portYIELD_FROM_ISR(woken);
+}
 
-	float scale = lc->type ? WEIGHT_VERIFICATION_SCALE_VALUE : PRODUCE_SCALE_VALUE; 
-	float grams = net/scale;
+/**
+ * @brief Sampler task: clock out each conversion and publish it
+ */
+static void load_cell_sampler_task(void* arg) {
+	LoadCell* lc = (LoadCell*)arg;
+
+	while (lc->sampling) {
+		// Timeout covers an edge that fell while we were clocking
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOAD_CELL_SAMPLE_TIMEOUT_MS));
+		if (!lc->sampling || gpio_get_level(lc->data_pin) == 1) {
+			continue;
+		}
 
-	if (fabs(grams) < 3.0f) {
-		grams = 0;
+		int32_t raw;
+		esp_err_t ret = load_cell_clock_out(lc, &raw);
+		ulTaskNotifyTake(pdTRUE, 0); // drop edges caused by our own clocking
+
+		// A failed read is skipped rather than published as a repeat of the last code
+		if (ret == ESP_OK) {
+			load_cell_publish_sample(lc, raw);
+		}
 	}
-	else {
-		grams = fabs(grams);
-		grams = roundf(grams*10) / 10.0f;
+
+	task_stop_exit(&lc->sampler_stop);
+}
+
+/**
+ * @brief Publish one conversion (tare, ring, filtered value)
+ */
+void load_cell_publish_sample(LoadCell* lc, int32_t raw) {
+	bool publish = !lc->taring;
+	if (!publish) {
+		// Tare in progress: accumulate the offset instead of publishing
+		lc->tare_acc += raw;
+		if (--lc->tare_remaining == 0) {
+			lc->tare_offset = (int32_t)(lc->tare_acc / LOAD_CELL_TARE_SAMPLES);
+			lc->zero_adjust = 0;
+			lc->tare_generation++;
+			lc->taring = false;
+			ESP_LOGI(TAG, "Tare done on DOUT GPIO %d. Offset = %ld", lc->data_pin, lc->tare_offset);
+			if (lc->tare_cb) {
+				lc->tare_cb(lc, lc->tare_ctx);
+			}
+		}
 	}
 
-	float pounds = grams * 0.00220462;
+	// Publish to the ring; if the consumer fell behind, drop the new sample
+	uint32_t head = lc->ring_head;
+	if (!publish) {
+		// samples taken during a tare are invalid
+	} else if (head - __atomic_load_n(&lc->ring_tail, __ATOMIC_ACQUIRE) < LOAD_CELL_RING_SIZE) {
+		lc->ring[head & (LOAD_CELL_RING_SIZE - 1)] = raw;
+		__atomic_store_n(&lc->ring_head, head + 1, __ATOMIC_RELEASE);
+		if (lc->consumer_task != NULL) {
+			xTaskNotifyGive(lc->consumer_task);
+		}
+	} else {
+		lc->ring_dropped++;
+	}
 
-	return pounds;
+	lc->window[lc->window_filled % LOAD_CELL_FILTER_SIZE] = raw;
+	lc->window_filled++;
+	if (lc->window_filled >= LOAD_CELL_FILTER_SIZE) {
+		lc->latest_filtered = load_cell_trimmed_mean(lc->window);
+	} else {
+		lc->latest_filtered = raw;
+	}
+	// A live HX711 never repeats a 24-bit code for long or sits at full scale
+	lc->repeat_run = (raw == lc->latest_raw) ? lc->repeat_run + 1 : 0;
+	lc->saturated_run = (raw == 0x7FFFFF || raw == -0x800000) ? lc->saturated_run + 1 : 0;
+
+	lc->latest_raw = raw;
+	__atomic_store_n(&lc->sample_count, lc->sample_count + 1, __ATOMIC_RELEASE);
 }
 
 /**
- * @brief Get weight reading in ounces
+ * @brief Start the interrupt-driven background sampler
  */
-float load_cell_display_ounces(LoadCell* lc) {
-	int32_t raw = load_cell_average_channel(lc);
-	float net = raw - lc->tare_offset;
+esp_err_t load_cell_start_sampling(LoadCell* lc, UBaseType_t priority) {
+	if (lc == NULL) return ESP_ERR_INVALID_ARG;
+	if (lc->sampling) return ESP_OK;
+
+	lc->ring_head = 0;
+	lc->ring_tail = 0;
+	lc->ring_dropped = 0;
+	lc->sampling = true;
+	if (xTaskCreate(load_cell_sampler_task, "hx711_sampler", 3072, lc, priority, &lc->sampler_task) != pdPASS) {
+		lc->sampling = false;
+		ESP_LOGE(TAG, "Failed to create sampler task");
+		return ESP_ERR_NO_MEM;
+	}
 
-	float scale = lc->type ? WEIGHT_VERIFICATION_SCALE_VALUE : PRODUCE_SCALE_VALUE;
-	float grams = net/scale;
+	gpio_set_intr_type(lc->data_pin, GPIO_INTR_NEGEDGE);
+	esp_err_t ret = gpio_install_isr_service(0);
+	if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+		load_cell_stop_sampling(lc);
+		return ret;
+	}
+	gpio_isr_handler_add(lc->data_pin, load_cell_dout_isr, lc);
+	gpio_intr_enable(lc->data_pin);
 
-	if (fabs(grams) < 3.0f) {
-		grams = 0;
+	ESP_LOGI(TAG, "Sampler started on DOUT GPIO %d", lc->data_pin);
+	return ESP_OK;
+}
+
+/**
+ * @brief Stop the background sampler
+ */
+void load_cell_stop_sampling(LoadCell* lc) {
+	if (lc == NULL || !lc->sampling) return;
+
+	gpio_intr_disable(lc->data_pin);
+	gpio_isr_handler_remove(lc->data_pin);
+	lc->sampling = false;
+
+	// Sampler exits within one timeout
+	task_stop_join(&lc->sampler_stop, &lc->sampler_task);
+	ESP_LOGI(TAG, "Sampler stopped on DOUT GPIO %d", lc->data_pin);
+}
+
+/**
+ * @brief Pop the oldest raw sample from the sampler ring
+ */
+bool load_cell_pop_sample(LoadCell* lc, int32_t* raw) {
+	uint32_t tail = lc->ring_tail;
+	if (tail == __atomic_load_n(&lc->ring_head, __ATOMIC_ACQUIRE)) {
+		return false;
+	}
+	*raw = lc->ring[tail & (LOAD_CELL_RING_SIZE - 1)];
+	__atomic_store_n(&lc->ring_tail, tail + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief NVS key holding this cell's calibration
+ */
+static const char* load_cell_cal_key(const LoadCell* lc) {
+	return lc->type ? "cal_cart" : "cal_prod";
+}
+
+/**
+ * @brief Whether a calibration map is usable
+ */
+static bool load_cell_cal_valid(const load_cell_cal_t* cal) {
+	if (cal->count == 0 || cal->count > LOAD_CELL_CAL_MAX_POINTS) return false;
+	if (cal->polarity != 1 && cal->polarity != -1) return false;
+	for (int i = 0; i < cal->count; i++) {
+		if (cal->slope_q16[i] <= 0) return false;
+		if (i > 0 && cal->net[i] <= cal->net[i - 1]) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Make a map the active one (the previous buffer becomes the spare)
+ */
+static void load_cell_cal_apply(LoadCell* lc, const load_cell_cal_t* cal) {
+	uint8_t spare = lc->cal_active ^ 1;
+	lc->cal[spare] = *cal;
+	__atomic_store_n(&lc->cal_active, spare, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Convert a raw sample to signed net milligrams (one multiply-shift)
+ */
+int32_t load_cell_raw_to_mg(const LoadCell* lc, int32_t raw) {
+	const load_cell_cal_t* cal = &lc->cal[__atomic_load_n(&lc->cal_active, __ATOMIC_ACQUIRE)];
+	int32_t net = (raw - lc->tare_offset) * cal->polarity;
+	int32_t mag = net < 0 ? -net : net;
+
+	int i = cal->count - 1;
+	while (i > 0 && mag < cal->net[i]) {
+		i--;
 	}
-	else {
-		grams = fabs(grams);
-		grams = roundf(grams*10) / 10.0f;
+	int32_t mg = cal->mg[i] + (int32_t)(((int64_t)(mag - cal->net[i]) * cal->slope_q16[i]) >> LOAD_CELL_CAL_SHIFT);
+	return net < 0 ? -mg : mg;
+}
+
+/**
+ * @brief Convert a raw sample to signed net grams using the current tare
+ */
+float load_cell_raw_to_grams(LoadCell* lc, int32_t raw) {
+	return load_cell_raw_to_mg(lc, raw) / 1000.0f;
+}
+
+/**
+ * @brief Current displayed weight in milligrams
+ */
+esp_err_t load_cell_read_mg(LoadCell* lc, int32_t* mg) {
+	if (lc->taring) return ESP_ERR_INVALID_STATE;
+
+	// Sampler keeps a filtered value ready, no need to wait for conversions
+	int32_t raw = lc->sampling ? lc->latest_filtered : load_cell_average_channel(lc);
+	int32_t w = load_cell_raw_to_mg(lc, raw);
+	if (w < 0) {
+		w = -w;
 	}
-	float ounces = grams * 0.035274;
+	*mg = (w < LOAD_CELL_DEADBAND_MG) ? 0 : (w + 50) / 100 * 100;
+	return ESP_OK;
+}
+
+/**
+ * @brief Restore the built-in single-point calibration
+ */
+void load_cell_cal_default(LoadCell* lc) {
+	float counts_per_g = lc->type ? WEIGHT_VERIFICATION_SCALE_VALUE : PRODUCE_SCALE_VALUE;
+	load_cell_cal_t cal = {
+		.count = 1,
+		.polarity = 1,
+		.slope_q16 = { (int32_t)lroundf(1000.0f * (1 << LOAD_CELL_CAL_SHIFT) / counts_per_g) },
+	};
+	load_cell_cal_apply(lc, &cal);
+}
 
-	return ounces;
+/**
+ * @brief Load the calibration saved in NVS (keeps the current one if none)
+ */
+esp_err_t load_cell_cal_load(LoadCell* lc) {
+	nvs_handle_t nvs;
+	esp_err_t ret = nvs_open(LOAD_CELL_NVS_NAMESPACE, NVS_READONLY, &nvs);
+	if (ret != ESP_OK) {
+		return ret;
+	}
+	load_cell_cal_t cal;
+	size_t len = sizeof(cal);
+	ret = nvs_get_blob(nvs, load_cell_cal_key(lc), &cal, &len);
+	nvs_close(nvs);
+	if (ret != ESP_OK) {
+		return ret;
+	}
+	if (len != sizeof(cal) || !load_cell_cal_valid(&cal)) {
+		ESP_LOGW(TAG, "Ignoring invalid %s calibration in NVS", load_cell_cal_key(lc));
+		return ESP_ERR_INVALID_SIZE;
+	}
+	load_cell_cal_apply(lc, &cal);
+	ESP_LOGI(TAG, "Loaded %s calibration (%d segments)", load_cell_cal_key(lc), cal.count);
+	return ESP_OK;
+}
+
+/**
+ * @brief Start a calibration: drop captured points and tare the empty scale
+ */
+esp_err_t load_cell_cal_begin(LoadCell* lc, load_cell_tare_cb_t cb, void* ctx) {
+	if (lc == NULL) return ESP_ERR_INVALID_ARG;
+	lc->cal_pending = 0;
+	return load_cell_tare_async(lc, cb, ctx);
+}
+
+/**
+ * @brief Capture the current reading as a reference mass
+ */
+esp_err_t load_cell_cal_add_point(LoadCell* lc, int32_t mg) {
+	if (lc == NULL || mg <= 0) return ESP_ERR_INVALID_ARG;
+	if (lc->taring) return ESP_ERR_INVALID_STATE;
+	if (lc->cal_pending >= LOAD_CELL_CAL_MAX_POINTS) return ESP_ERR_NO_MEM;
+
+	int32_t raw = lc->sampling ? lc->latest_filtered : load_cell_average_channel(lc);
+	int32_t net = raw - lc->tare_offset;
+	if (net == 0) return ESP_ERR_INVALID_STATE;
+
+	lc->cal_pending_net[lc->cal_pending] = net;
+	lc->cal_pending_mg[lc->cal_pending] = mg;
+	lc->cal_pending++;
+	ESP_LOGI(TAG, "Calibration point %d: %ld mg = %ld counts", lc->cal_pending, mg, net);
+	return ESP_OK;
+}
+
+/**
+ * @brief Build the map from the captured points, apply it and save it to NVS
+ */
+esp_err_t load_cell_cal_commit(LoadCell* lc) {
+	if (lc == NULL) return ESP_ERR_INVALID_ARG;
+	uint8_t n = lc->cal_pending;
+	if (n == 0) return ESP_ERR_INVALID_STATE;
+
+	// Every reference mass must move the reading the same way
+	int8_t polarity = lc->cal_pending_net[0] < 0 ? -1 : 1;
+	int32_t mag[LOAD_CELL_CAL_MAX_POINTS];
+	int32_t mg[LOAD_CELL_CAL_MAX_POINTS];
+	for (int i = 0; i < n; i++) {
+		mag[i] = lc->cal_pending_net[i] * polarity;
+		mg[i] = lc->cal_pending_mg[i];
+		if (mag[i] <= 0) return ESP_ERR_INVALID_ARG;
+	}
+
+	// Sort by reading
+	for (int i = 1; i < n; i++) {
+		int32_t km = mag[i], kg = mg[i];
+		int j = i - 1;
+		while (j >= 0 && mag[j] > km) {
+			mag[j + 1] = mag[j];
+			mg[j + 1] = mg[j];
+			j--;
+		}
+		mag[j + 1] = km;
+		mg[j + 1] = kg;
+	}
+
+	// Segment i runs from the previous point (tare zero for the first) to point i;
+	// the last one extends past the heaviest reference mass
+	load_cell_cal_t cal = { .count = n, .polarity = polarity };
+	int32_t prev_mag = 0, prev_mg = 0;
+	for (int i = 0; i < n; i++) {
+		if (mag[i] <= prev_mag || mg[i] <= prev_mg) return ESP_ERR_INVALID_ARG;
+		cal.net[i] = prev_mag;
+		cal.mg[i] = prev_mg;
+		cal.slope_q16[i] = (int32_t)(((int64_t)(mg[i] - prev_mg) << LOAD_CELL_CAL_SHIFT) / (mag[i] - prev_mag));
+		prev_mag = mag[i];
+		prev_mg = mg[i];
+	}
+	if (!load_cell_cal_valid(&cal)) return ESP_ERR_INVALID_ARG;
+
+	load_cell_cal_apply(lc, &cal);
+	lc->cal_pending = 0;
+
+	nvs_handle_t nvs;
+	esp_err_t ret = nvs_open(LOAD_CELL_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+	if (ret == ESP_OK) {
+		ret = nvs_set_blob(nvs, load_cell_cal_key(lc), &cal, sizeof(cal));
+		if (ret == ESP_OK) {
+			ret = nvs_commit(nvs);
+		}
+		nvs_close(nvs);
+	}
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "Calibration applied but not saved: %s", esp_err_to_name(ret));
+		return ret;
+	}
+	ESP_LOGI(TAG, "Saved %s calibration (%d segments)", load_cell_cal_key(lc), n);
+	return ESP_OK;
+}
+
+/**
+ * @brief Restore the built-in calibration and erase the saved one
+ */
+esp_err_t load_cell_cal_reset(LoadCell* lc) {
+	if (lc == NULL) return ESP_ERR_INVALID_ARG;
+	lc->cal_pending = 0;
+	load_cell_cal_default(lc);
+
+	nvs_handle_t nvs;
+	esp_err_t ret = nvs_open(LOAD_CELL_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+	if (ret != ESP_OK) {
+		return ret;
+	}
+	ret = nvs_erase_key(nvs, load_cell_cal_key(lc));
+	if (ret == ESP_OK) {
+		ret = nvs_commit(nvs);
+	} else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+		ret = ESP_OK;
+	}
+	nvs_close(nvs);
+	return ret;
+}
+
+/**
+ * @brief Get weight reading in pounds (NAN while taring)
+ */
+float load_cell_display_pounds(LoadCell* lc) {
+	int32_t mg;
+	if (load_cell_read_mg(lc, &mg) != ESP_OK) return NAN;
+	return mg * LOAD_CELL_LB_PER_MG;
+}
+
+/**
+ * @brief Get weight reading in ounces (NAN while taring)
+ */
+float load_cell_display_ounces(LoadCell* lc) {
+	int32_t mg;
+	if (load_cell_read_mg(lc, &mg) != ESP_OK) return NAN;
+	return mg * LOAD_CELL_OZ_PER_MG;
 }
 
 /**
@@ -4,25 +4,101 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "driver/gpio.h"
+#include "driver/spi_master.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_err.h"
+#include "task_stop.h"
 
 #define PRODUCE_SCALE_VALUE 222
 #define WEIGHT_VERIFICATION_SCALE_VALUE 26.2
 
+#define LOAD_CELL_RING_SIZE 32      // Raw samples buffered by the sampler (power of two)
+#define LOAD_CELL_FILTER_SIZE 5     // Samples in the sampler's trimmed-mean window
+#define LOAD_CELL_TARE_SAMPLES 10   // Conversions averaged by an async tare (1 s at 10 SPS)
+#define LOAD_CELL_READY_TIMEOUT_MS 500  // Longest wait for DOUT to go low before a read gives up
+#define LOAD_CELL_TARE_TIMEOUT_MS 3000  // Longest wait for a blocking tare
+
+#define LOAD_CELL_SPI_CLOCK_HZ 500000  // PD_SCK high time 1 us, well inside the HX711's 0.2-50 us
+
+#define LOAD_CELL_CAL_MAX_POINTS 4     // Reference masses per calibration (segments of the raw->mg map)
+#define LOAD_CELL_CAL_SHIFT 16         // Slopes are mg per count in Q16
+#define LOAD_CELL_DEADBAND_MG 3000     // Displayed weight below 3 g reads as zero
+#define LOAD_CELL_NVS_NAMESPACE "loadcell"
+#define LOAD_CELL_LB_PER_MG 2.20462e-6f  // Display units, applied only when formatting
+#define LOAD_CELL_OZ_PER_MG 3.5274e-5f
+
+// Piecewise-linear raw->mg map; segment i starts at |net| = net[i] counts above tare
+typedef struct {
+    uint8_t count;                                  // segments in use (>= 1)
+    int8_t polarity;                                // -1 if the bridge reads negative under load
+    int32_t net[LOAD_CELL_CAL_MAX_POINTS];
+    int32_t mg[LOAD_CELL_CAL_MAX_POINTS];           // weight at the start of the segment
+    int32_t slope_q16[LOAD_CELL_CAL_MAX_POINTS];    // mg per count << LOAD_CELL_CAL_SHIFT
+} load_cell_cal_t;
+
+// How conversions are clocked out of the HX711
+typedef enum {
+    LOAD_CELL_BACKEND_GPIO = 0,     // CPU bit-bang (fallback)
+    LOAD_CELL_BACKEND_SPI,          // SPI master generates PD_SCK and shifts DOUT
+} load_cell_backend_t;
+
+struct LoadCell;
+
+// Called once an async tare has a new offset (from the sampler task)
+typedef void (*load_cell_tare_cb_t)(struct LoadCell* lc, void* ctx);
+
 // Opaque handle for load cell instance
 typedef struct LoadCell {
     gpio_num_t clk_pin;
     gpio_num_t data_pin;
     uint8_t gain;
-    float tare_offset;
+    int32_t tare_offset;
     bool type; // false = produce, true = weight verification
+    load_cell_backend_t backend;
+    spi_host_device_t spi_host;
+    spi_device_handle_t spi;
+
+    // Background sampler (load_cell_start_sampling), single producer / single consumer
+    TaskHandle_t sampler_task;
+    TaskStop sampler_stop;
+    TaskHandle_t consumer_task;         // notified after each new sample, may be NULL
+    volatile bool sampling;
+    int32_t ring[LOAD_CELL_RING_SIZE];
+    volatile uint32_t ring_head;        // written by the sampler only
+    volatile uint32_t ring_tail;        // written by the consumer only
+    volatile uint32_t ring_dropped;     // samples lost because the consumer fell behind
+    volatile int32_t latest_raw;
+    volatile int32_t latest_filtered;   // trimmed mean of the last LOAD_CELL_FILTER_SIZE samples
+    volatile uint32_t sample_count;
+    int32_t window[LOAD_CELL_FILTER_SIZE];
+    uint32_t window_filled;
+
+    // Async tare (load_cell_tare_async), samples taken meanwhile are not published
+    volatile bool taring;
+    uint32_t tare_remaining;
+    int64_t tare_acc;
+    load_cell_tare_cb_t tare_cb;
+    void* tare_ctx;
+    volatile uint32_t tare_generation;  // bumped after every completed tare
+
+    // Health (see loadcell_health.h)
+    volatile uint32_t read_timeouts;    // blocking reads that gave up waiting for DOUT
+    volatile uint32_t read_errors;      // conversions lost to a failed SPI transaction (never published)
+    volatile uint32_t repeat_run;       // consecutive identical conversions (a live HX711 always has noise)
+    volatile uint32_t saturated_run;    // consecutive full-scale conversions
+    volatile int32_t zero_adjust;       // auto-zero applied since the last tare (counts)
+
+    // Calibration, double-buffered so a commit never tears a conversion in progress
+    load_cell_cal_t cal[2];
+    volatile uint8_t cal_active;
+    uint8_t cal_pending;                // reference points captured since load_cell_cal_begin
+    int32_t cal_pending_net[LOAD_CELL_CAL_MAX_POINTS];
+    int32_t cal_pending_mg[LOAD_CELL_CAL_MAX_POINTS];
 } LoadCell;
 
 // Function declarations
 
-void tare_task(void* arg);
-
 /**
  * @brief Create and initialize a load cell handle
  */
@@ -58,6 +134,33 @@ void load_cell_reset(LoadCell* lc);
  */
 void load_cell_tare(LoadCell* lc);
 
+/**
+ * @brief Start a tare and return immediately
+ *
+ * With the sampler running the offset is averaged from the next
+ * LOAD_CELL_TARE_SAMPLES conversions; otherwise a one-shot task runs the
+ * blocking tare. Weight reads return NAN until it completes.
+ *
+ * @param cb  Completion callback, may be NULL
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if a tare is already running
+ */
+esp_err_t load_cell_tare_async(LoadCell* lc, load_cell_tare_cb_t cb, void* ctx);
+
+/**
+ * @brief Whether a tare is in progress (weight reads are invalid)
+ */
+bool load_cell_is_taring(LoadCell* lc);
+
+/**
+ * @brief Give up on a tare that gets no conversions (keeps the old offset)
+ */
+void load_cell_tare_abort(LoadCell* lc);
+
+/**
+ * @brief Nudge the zero by a few counts without re-seeding consumers (auto-zero)
+ */
+void load_cell_adjust_zero(LoadCell* lc, int32_t counts);
+
 /**
  * @brief Read raw 24-bit value from load cell
  */
@@ -65,6 +168,10 @@ int32_t load_cell_read_channel(LoadCell* lc);
 
 /**
  * @brief Read raw 24-bit value without discarding first read
+ *
+ * Gives up after LOAD_CELL_READY_TIMEOUT_MS (counted in read_timeouts), or on
+ * a failed SPI read (counted in read_errors), and returns the last good
+ * conversion instead of blocking forever.
  */
 int32_t load_cell_read_channel_raw(LoadCell* lc);
 
@@ -74,12 +181,100 @@ int32_t load_cell_read_channel_raw(LoadCell* lc);
 int32_t load_cell_average_channel(LoadCell* lc);
 
 /**
- * @brief Get weight reading in pounds
+ * @brief Clock this load cell from an SPI master instead of bit-banging
+ *
+ * SCLK drives PD_SCK and MISO reads DOUT; the bus is dedicated to this cell.
+ * Call after load_cell_begin(). On failure the cell stays on the GPIO backend.
+ */
+esp_err_t load_cell_use_spi(LoadCell* lc, spi_host_device_t host);
+
+/**
+ * @brief Start the interrupt-driven background sampler
+ *
+ * A DOUT falling-edge interrupt wakes a task that clocks out each conversion
+ * as soon as it is ready. Blocking reads are served from the sampler afterwards.
+ */
+esp_err_t load_cell_start_sampling(LoadCell* lc, UBaseType_t priority);
+
+/**
+ * @brief Stop the background sampler
+ */
+void load_cell_stop_sampling(LoadCell* lc);
+
+/**
+ * @brief Publish one conversion (tare, ring, filtered value)
+ *
+ * Called by the cell's own sampler, or by an acquisition group that clocks
+ * several cells together.
+ */
+void load_cell_publish_sample(LoadCell* lc, int32_t raw);
+
+/**
+ * @brief Pop the oldest raw sample from the sampler ring
+ *
+ * @return false if no sample is available
+ */
+bool load_cell_pop_sample(LoadCell* lc, int32_t* raw);
+
+/**
+ * @brief Convert a raw sample to signed net milligrams (one multiply-shift)
+ */
+int32_t load_cell_raw_to_mg(const LoadCell* lc, int32_t raw);
+
+/**
+ * @brief Convert a raw sample to signed net grams using the current tare
+ */
+float load_cell_raw_to_grams(LoadCell* lc, int32_t raw);
+
+/**
+ * @brief Current displayed weight in milligrams
+ *
+ * Unsigned, zero inside LOAD_CELL_DEADBAND_MG, rounded to 0.1 g.
+ *
+ * @return ESP_ERR_INVALID_STATE while taring
+ */
+esp_err_t load_cell_read_mg(LoadCell* lc, int32_t* mg);
+
+/**
+ * @brief Restore the built-in single-point calibration
+ */
+void load_cell_cal_default(LoadCell* lc);
+
+/**
+ * @brief Load the calibration saved in NVS (keeps the current one if none)
+ */
+esp_err_t load_cell_cal_load(LoadCell* lc);
+
+/**
+ * @brief Start a calibration: drop captured points and tare the empty scale
+ */
+esp_err_t load_cell_cal_begin(LoadCell* lc, load_cell_tare_cb_t cb, void* ctx);
+
+/**
+ * @brief Capture the current reading as a reference mass
+ *
+ * @return ESP_ERR_NO_MEM if LOAD_CELL_CAL_MAX_POINTS are already captured,
+ *         ESP_ERR_INVALID_STATE while taring or if the reading is at zero
+ */
+esp_err_t load_cell_cal_add_point(LoadCell* lc, int32_t mg);
+
+/**
+ * @brief Build the map from the captured points, apply it and save it to NVS
+ */
+esp_err_t load_cell_cal_commit(LoadCell* lc);
+
+/**
+ * @brief Restore the built-in calibration and erase the saved one
+ */
+esp_err_t load_cell_cal_reset(LoadCell* lc);
+
+/**
+ * @brief Get weight reading in pounds (NAN while taring)
  */
 float load_cell_display_pounds(LoadCell* lc);
 
 /**
- * @brief Get weight reading in ounces
+ * @brief Get weight reading in ounces (NAN while taring)
  */
 float load_cell_display_ounces(LoadCell* lc);
 
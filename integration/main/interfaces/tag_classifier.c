@@ -0,0 +1,169 @@
+#include "tag_classifier.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "TAG_CLASSIFIER";
+
+#define HISTORY_SIZE ITEM_RFID_MAX_TAGS
+#define FORGET_AFTER_MISSED_SCANS 3   // Drop a tag from history after this many scans without it
+#define STREAK_MAX 250
+
+// Score weights, summed per tag
+#define SCORE_IN_BASKET 5
+#define SCORE_UNCERTAIN 3
+
+/**
+ * @brief Cross-scan history for a single tag
+ */
+typedef struct {
+    char tag[64];
+    uint8_t streak;            // consecutive scans the tag was seen in
+    uint8_t missed;            // consecutive scans the tag was missing from
+    bool used;
+    bool seen_this_scan;
+} tag_history_t;
+
+static tag_classifier_config_t cls_cfg = {
+    .min_reads = 3,
+    .rssi_in_basket = 70,
+    .rssi_ambient = 55,
+    .max_rssi_spread = 8,
+    .persist_scans = 3,
+};
+static tag_history_t history[HISTORY_SIZE];
+
+/**
+ * @brief Find a tag in history, optionally allocating a slot for it
+ */
+static tag_history_t *tag_classifier_lookup(const char *tag, bool create) {
+    tag_history_t *free_slot = NULL;
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        if (history[i].used) {
+            if (strcmp(history[i].tag, tag) == 0) {
+                return &history[i];
+            }
+        } else if (free_slot == NULL) {
+            free_slot = &history[i];
+        }
+    }
+
+    if (!create || free_slot == NULL) {
+        return NULL;
+    }
+
+    memset(free_slot, 0, sizeof(*free_slot));
+    strncpy(free_slot->tag, tag, sizeof(free_slot->tag) - 1);
+    free_slot->used = true;
+    return free_slot;
+}
+
+/**
+ * @brief Score one tag from its per-scan statistics and persistence
+ */
+static int tag_classifier_score(const item_rfid_tag_t *tag, const tag_history_t *hist) {
+    int score = 0;
+
+    // Read count: basket tags sit in the antenna field for the whole scan
+    if (tag->read_count >= cls_cfg.min_reads) score++;
+    if (tag->read_count >= 2 * cls_cfg.min_reads) score++;
+
+    // RSSI level and spread (reader may omit RSSI, then only count/persistence decide)
+    if (tag->rssi_mean != -999) {
+        if (tag->rssi_mean >= cls_cfg.rssi_in_basket) score += 2;
+        else if (tag->rssi_mean >= cls_cfg.rssi_ambient) score += 1;
+
+        if (tag->read_count > 1 && (tag->rssi - tag->rssi_min) <= cls_cfg.max_rssi_spread) score++;
+    } else {
+        score += 1;
+    }
+
+    // Persistence: shelf tags drop out as soon as the cart moves on
+    if (hist != NULL) {
+        if (hist->streak >= cls_cfg.persist_scans) score += 2;
+        else if (hist->streak >= 2) score += 1;
+    }
+
+    return score;
+}
+
+/**
+ * @brief Initialize the classifier and clear its history
+ */
+void tag_classifier_init(const tag_classifier_config_t *config) {
+    if (config) {
+        cls_cfg = *config;
+    }
+    tag_classifier_reset();
+
+    ESP_LOGI(TAG, "Tag classifier ready (reads>=%d, RSSI basket>=%d ambient<%d, spread<=%d, persist=%d)",
+             cls_cfg.min_reads, cls_cfg.rssi_in_basket, cls_cfg.rssi_ambient,
+             cls_cfg.max_rssi_spread, cls_cfg.persist_scans);
+}
+
+/**
+ * @brief Forget all tag history (e.g. at the start of a session)
+ */
+void tag_classifier_reset(void) {
+    memset(history, 0, sizeof(history));
+}
+
+/**
+ * @brief Classify the tags of one completed scan
+ */
+int tag_classifier_classify(const item_rfid_tag_t *tags, int count, tag_class_t *classes) {
+    int reported = 0;
+
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        history[i].seen_this_scan = false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        tag_history_t *hist = tag_classifier_lookup(tags[i].tag, true);
+        if (hist != NULL) {
+            if (hist->streak < STREAK_MAX) hist->streak++;
+            hist->missed = 0;
+            hist->seen_this_scan = true;
+        }
+
+        int score = tag_classifier_score(&tags[i], hist);
+        if (score >= SCORE_IN_BASKET) {
+            classes[i] = TAG_CLASS_IN_BASKET;
+        } else if (score >= SCORE_UNCERTAIN) {
+            classes[i] = TAG_CLASS_UNCERTAIN;
+        } else {
+            classes[i] = TAG_CLASS_AMBIENT;
+        }
+
+        if (classes[i] != TAG_CLASS_AMBIENT) {
+            reported++;
+        }
+
+        ESP_LOGD(TAG, "%s: reads=%d rssi=%d/%d/%d streak=%d score=%d -> %s",
+                 tags[i].tag, tags[i].read_count, tags[i].rssi_min, tags[i].rssi_mean, tags[i].rssi,
+                 hist ? hist->streak : 0, score, tag_class_str(classes[i]));
+    }
+
+    // Age out tags that were not heard this time
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        if (history[i].used && !history[i].seen_this_scan) {
+            history[i].streak = 0;
+            if (++history[i].missed >= FORGET_AFTER_MISSED_SCANS) {
+                history[i].used = false;
+            }
+        }
+    }
+
+    return reported;
+}
+
+/**
+ * @brief Get a short name for a tag class
+ */
+const char *tag_class_str(tag_class_t cls) {
+    switch (cls) {
+        case TAG_CLASS_IN_BASKET: return "IN_BASKET";
+        case TAG_CLASS_UNCERTAIN: return "UNCERTAIN";
+        case TAG_CLASS_AMBIENT:   return "AMBIENT";
+        default:                  return "UNKNOWN";
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef TAG_CLASSIFIER_H
+#define TAG_CLASSIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "item_rfid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Where a tag heard by the item reader most likely is
+ */
+typedef enum {
+    TAG_CLASS_AMBIENT = 0,     /**< Shelf or neighbouring cart - not reported */
+    TAG_CLASS_UNCERTAIN,       /**< Not enough evidence either way - reported */
+    TAG_CLASS_IN_BASKET,       /**< Inside the basket - reported */
+} tag_class_t;
+
+/**
+ * @brief Classifier thresholds
+ */
+typedef struct {
+    int min_reads;             /**< Reads per scan expected from a tag inside the basket */
+    int rssi_in_basket;        /**< Mean RSSI at or above this is typical for basket tags */
+    int rssi_ambient;          /**< Mean RSSI below this is typical for shelf tags */
+    int max_rssi_spread;       /**< Max (peak - weakest) RSSI for a tag that is not moving relative to the antenna */
+    int persist_scans;         /**< Consecutive scans a tag must be seen to count as persistent */
+} tag_classifier_config_t;
+
+/**
+ * @brief Initialize the classifier and clear its history
+ */
+void tag_classifier_init(const tag_classifier_config_t *config);
+
+/**
+ * @brief Forget all tag history (e.g. at the start of a session)
+ */
+void tag_classifier_reset(void);
+
+/**
+ * @brief Classify the tags of one completed scan
+ *
+ * Updates the cross-scan persistence history, so call exactly once per scan.
+ *
+ * @param tags    Tags reported by item_rfid for this scan
+ * @param count   Number of tags
+ * @param classes Output array of count entries
+ * @return Number of tags classified as in-basket or uncertain
+ */
+int tag_classifier_classify(const item_rfid_tag_t *tags, int count, tag_class_t *classes);
+
+/**
+ * @brief Get a short name for a tag class
+ */
+const char *tag_class_str(tag_class_t cls);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TAG_CLASSIFIER_H
@@ -0,0 +1,252 @@
+#include "tag_registry.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+static const char *TAG = "TAG_REGISTRY";
+
+#define EPC_MAX_BYTES 32
+
+/**
+ * @brief Registry slot: EPC stored as raw bytes, UPC as string
+ */
+typedef struct {
+    uint8_t epc[EPC_MAX_BYTES];
+    uint8_t epc_len;           // 0 = empty slot
+    char upc[TAG_REGISTRY_UPC_LEN + 1];
+} tag_registry_entry_t;
+
+/**
+ * @brief Scanned-UPC mirror slot
+ */
+typedef struct {
+    char upc[TAG_REGISTRY_UPC_LEN + 1];
+    uint16_t qty;              // 0 = empty slot
+    uint16_t claimed;          // units matched to a tag in the current RFID scan
+} tag_registry_scanned_t;
+
+static tag_registry_entry_t entries[TAG_REGISTRY_CAPACITY];
+static int entry_count = 0;
+static tag_registry_scanned_t scanned[TAG_REGISTRY_SCANNED_CAPACITY];
+static SemaphoreHandle_t registry_mutex = NULL;
+
+/**
+ * @brief Convert an EPC hex string to bytes
+ *
+ * @return Number of bytes, 0 on malformed input
+ */
+static int tag_registry_parse_epc(const char *hex, uint8_t *out) {
+    int len = 0;
+    while (hex[0] != '\0' && hex[1] != '\0' && len < EPC_MAX_BYTES) {
+        if (!isxdigit((unsigned char)hex[0]) || !isxdigit((unsigned char)hex[1])) {
+            return 0;
+        }
+        char byte_str[3] = { hex[0], hex[1], '\0' };
+        out[len++] = (uint8_t)strtoul(byte_str, NULL, 16);
+        hex += 2;
+    }
+    return (hex[0] == '\0') ? len : 0;
+}
+
+/**
+ * @brief FNV-1a hash over the EPC bytes
+ */
+static uint32_t tag_registry_hash(const uint8_t *epc, int len) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        h ^= epc[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Find the slot holding an EPC, or the empty slot where it would go
+ */
+static tag_registry_entry_t *tag_registry_probe(const uint8_t *epc, int len) {
+    uint32_t idx = tag_registry_hash(epc, len) & (TAG_REGISTRY_CAPACITY - 1);
+    for (int n = 0; n < TAG_REGISTRY_CAPACITY; n++) {
+        tag_registry_entry_t *e = &entries[idx];
+        if (e->epc_len == 0 || (e->epc_len == len && memcmp(e->epc, epc, len) == 0)) {
+            return e;
+        }
+        idx = (idx + 1) & (TAG_REGISTRY_CAPACITY - 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Find a UPC in the scanned mirror, optionally allocating a slot
+ */
+static tag_registry_scanned_t *tag_registry_find_scanned(const char *upc, bool create) {
+    tag_registry_scanned_t *free_slot = NULL;
+    for (int i = 0; i < TAG_REGISTRY_SCANNED_CAPACITY; i++) {
+        if (scanned[i].qty > 0) {
+            if (strcmp(scanned[i].upc, upc) == 0) {
+                return &scanned[i];
+            }
+        } else if (free_slot == NULL) {
+            free_slot = &scanned[i];
+        }
+    }
+    if (!create || free_slot == NULL) {
+        return NULL;
+    }
+    strncpy(free_slot->upc, upc, TAG_REGISTRY_UPC_LEN);
+    free_slot->upc[TAG_REGISTRY_UPC_LEN] = '\0';
+    free_slot->claimed = 0;
+    return free_slot;
+}
+
+/**
+ * @brief Initialize the registry (creates its lock, starts empty)
+ */
+esp_err_t tag_registry_init(void) {
+    if (registry_mutex == NULL) {
+        registry_mutex = xSemaphoreCreateMutex();
+        if (registry_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    tag_registry_clear();
+    tag_registry_clear_scanned();
+    ESP_LOGI(TAG, "Tag registry ready (%d tags, %d scanned UPCs)", TAG_REGISTRY_CAPACITY, TAG_REGISTRY_SCANNED_CAPACITY);
+    return ESP_OK;
+}
+
+/**
+ * @brief Remove all RFID -> UPC entries
+ */
+void tag_registry_clear(void) {
+    if (registry_mutex == NULL) return;
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    memset(entries, 0, sizeof(entries));
+    entry_count = 0;
+    xSemaphoreGive(registry_mutex);
+}
+
+/**
+ * @brief Add or replace an RFID -> UPC mapping
+ */
+esp_err_t tag_registry_add(const char *epc_hex, const char *upc) {
+    if (registry_mutex == NULL || !epc_hex || !upc || upc[0] == '\0' || strlen(upc) > TAG_REGISTRY_UPC_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t epc[EPC_MAX_BYTES];
+    int len = tag_registry_parse_epc(epc_hex, epc);
+    if (len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+
+    // Keep the load factor under 3/4 so probes stay short
+    tag_registry_entry_t *e = tag_registry_probe(epc, len);
+    if (e == NULL || (e->epc_len == 0 && entry_count >= (TAG_REGISTRY_CAPACITY * 3) / 4)) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        if (e->epc_len == 0) {
+            memcpy(e->epc, epc, len);
+            e->epc_len = len;
+            entry_count++;
+        }
+        strcpy(e->upc, upc);
+    }
+
+    xSemaphoreGive(registry_mutex);
+    return ret;
+}
+
+/**
+ * @brief Number of RFID -> UPC entries currently stored
+ */
+int tag_registry_count(void) {
+    return entry_count;
+}
+
+/**
+ * @brief Record that a UPC was scanned by the barcode scanner
+ */
+void tag_registry_mark_scanned(const char *upc) {
+    if (registry_mutex == NULL || !upc || upc[0] == '\0') return;
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    tag_registry_scanned_t *s = tag_registry_find_scanned(upc, true);
+    if (s != NULL) {
+        s->qty++;
+    } else {
+        ESP_LOGW(TAG, "Scanned UPC mirror full, %s not recorded", upc);
+    }
+    xSemaphoreGive(registry_mutex);
+}
+
+/**
+ * @brief Record that qty units of a scanned UPC were removed from the cart
+ */
+void tag_registry_unmark_scanned(const char *upc, uint16_t qty) {
+    if (registry_mutex == NULL || !upc) return;
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    tag_registry_scanned_t *s = tag_registry_find_scanned(upc, false);
+    if (s != NULL) {
+        s->qty = qty < s->qty ? s->qty - qty : 0;
+    }
+    xSemaphoreGive(registry_mutex);
+}
+
+/**
+ * @brief Forget all scanned UPCs (new session)
+ */
+void tag_registry_clear_scanned(void) {
+    if (registry_mutex == NULL) return;
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    memset(scanned, 0, sizeof(scanned));
+    xSemaphoreGive(registry_mutex);
+}
+
+/**
+ * @brief Start checking the tags of a new RFID scan (releases all claimed units)
+ */
+void tag_registry_begin_scan(void) {
+    if (registry_mutex == NULL) return;
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    for (int i = 0; i < TAG_REGISTRY_SCANNED_CAPACITY; i++) {
+        scanned[i].claimed = 0;
+    }
+    xSemaphoreGive(registry_mutex);
+}
+
+/**
+ * @brief Check a tag against the registry and the scanned-UPC mirror
+ */
+tag_reg_status_t tag_registry_check(const char *epc_hex, char *upc_out) {
+    if (registry_mutex == NULL || !epc_hex) return TAG_REG_UNKNOWN;
+
+    uint8_t epc[EPC_MAX_BYTES];
+    int len = tag_registry_parse_epc(epc_hex, epc);
+    if (len == 0) return TAG_REG_UNKNOWN;
+
+    tag_reg_status_t status = TAG_REG_UNKNOWN;
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+
+    tag_registry_entry_t *e = tag_registry_probe(epc, len);
+    if (e != NULL && e->epc_len != 0) {
+        tag_registry_scanned_t *s = tag_registry_find_scanned(e->upc, false);
+        if (s != NULL && s->claimed < s->qty) {
+            s->claimed++;
+            status = TAG_REG_SCANNED;
+        } else {
+            status = TAG_REG_UNSCANNED;
+        }
+        if (upc_out) {
+            strcpy(upc_out, e->upc);
+        }
+    }
+
+    xSemaphoreGive(registry_mutex);
+    return status;
+}
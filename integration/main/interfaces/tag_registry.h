@@ -0,0 +1,96 @@
+#ifndef TAG_REGISTRY_H
+#define TAG_REGISTRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of RFID -> UPC entries the registry can hold (power of two)
+ */
+#define TAG_REGISTRY_CAPACITY 512
+
+/**
+ * @brief Number of distinct scanned UPCs mirrored on the device
+ */
+#define TAG_REGISTRY_SCANNED_CAPACITY 128
+
+/**
+ * @brief Maximum UPC length (characters, excluding terminator)
+ */
+#define TAG_REGISTRY_UPC_LEN 15
+
+/**
+ * @brief Result of checking a tag against the registry
+ */
+typedef enum {
+    TAG_REG_UNKNOWN = 0,       /**< Tag is not a registered product tag */
+    TAG_REG_SCANNED,           /**< Product tag covered by a scanned unit of its UPC */
+    TAG_REG_UNSCANNED,         /**< Product tag beyond the scanned count of its UPC */
+} tag_reg_status_t;
+
+/**
+ * @brief Initialize the registry (creates its lock, starts empty)
+ */
+esp_err_t tag_registry_init(void);
+
+/**
+ * @brief Remove all RFID -> UPC entries
+ */
+void tag_registry_clear(void);
+
+/**
+ * @brief Add or replace an RFID -> UPC mapping
+ *
+ * @param epc_hex Tag EPC as hex string (as reported by item_rfid)
+ * @param upc     Product UPC
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on malformed input, ESP_ERR_NO_MEM when full
+ */
+esp_err_t tag_registry_add(const char *epc_hex, const char *upc);
+
+/**
+ * @brief Number of RFID -> UPC entries currently stored
+ */
+int tag_registry_count(void);
+
+/**
+ * @brief Record that a UPC was scanned by the barcode scanner
+ */
+void tag_registry_mark_scanned(const char *upc);
+
+/**
+ * @brief Record that qty units of a scanned UPC were removed from the cart
+ */
+void tag_registry_unmark_scanned(const char *upc, uint16_t qty);
+
+/**
+ * @brief Forget all scanned UPCs (new session)
+ */
+void tag_registry_clear_scanned(void);
+
+/**
+ * @brief Start checking the tags of a new RFID scan (releases all claimed units)
+ */
+void tag_registry_begin_scan(void);
+
+/**
+ * @brief Check a tag against the registry and the scanned-UPC mirror
+ *
+ * A scanned tag claims one scanned unit of its UPC until the next
+ * tag_registry_begin_scan, so with two tags of a UPC scanned once the second
+ * is unscanned. Check each tag of a scan once, most certain tags first.
+ *
+ * @param epc_hex Tag EPC as hex string
+ * @param upc_out Optional buffer of TAG_REGISTRY_UPC_LEN + 1 bytes for the mapped UPC
+ */
+tag_reg_status_t tag_registry_check(const char *epc_hex, char *upc_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TAG_REGISTRY_H
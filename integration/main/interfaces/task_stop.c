@@ -0,0 +1,35 @@
+#include "task_stop.h"
+
+/**
+ * @brief Set up the handshake (once, before the first task is created)
+ */
+void task_stop_init(TaskStop *ts) {
+    ts->exited = xSemaphoreCreateBinaryStatic(&ts->exited_buf);
+}
+
+/**
+ * @brief End the calling task: signal the stopper and park until it is deleted
+ */
+void task_stop_exit(TaskStop *ts) {
+    xSemaphoreGive(ts->exited);
+    for (;;) {
+        vTaskSuspend(NULL);
+    }
+}
+
+/**
+ * @brief Wake the task until it exits, delete it and clear the handle (no-op if NULL)
+ */
+void task_stop_join(TaskStop *ts, TaskHandle_t *task) {
+    if (*task == NULL) {
+        return;
+    }
+    // The task is alive (running or parked) until the vTaskDelete below
+    do {
+        xTaskNotifyGive(*task);
+    } while (xSemaphoreTake(ts->exited, pdMS_TO_TICKS(TASK_STOP_POLL_MS)) != pdTRUE);
+
+    TaskHandle_t t = *task;
+    *task = NULL;
+    vTaskDelete(t);
+}
@@ -0,0 +1,47 @@
+#ifndef TASK_STOP_H
+#define TASK_STOP_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TASK_STOP_POLL_MS 10   // Stopper re-notifies the task this often until it exits
+
+/**
+ * @brief Exit handshake between a module task and whoever stops it
+ *
+ * The task ends with task_stop_exit(), which signals and parks it; the stopper's
+ * task_stop_join() waits for that signal and only then deletes the task, so the
+ * handle it notifies always belongs to a live task.
+ */
+typedef struct {
+    SemaphoreHandle_t exited;
+    StaticSemaphore_t exited_buf;
+} TaskStop;
+
+/**
+ * @brief Set up the handshake (once, before the first task is created)
+ */
+void task_stop_init(TaskStop *ts);
+
+/**
+ * @brief End the calling task: signal the stopper and park until it is deleted
+ */
+void task_stop_exit(TaskStop *ts);
+
+/**
+ * @brief Wake the task until it exits, delete it and clear the handle (no-op if NULL)
+ *
+ * Clear the task's running flag first. Also reaps a task that exited on its own.
+ */
+void task_stop_join(TaskStop *ts, TaskHandle_t *task);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_STOP_H
@@ -0,0 +1,213 @@
+#include "weight_cusum.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <math.h>
+
+static const char *TAG = "WEIGHT_CUSUM";
+
+#define CUSUM_MEAN_ALPHA 0.02f    // In-control level tracking (slow creep, temperature)
+#define CUSUM_NOISE_ALPHA 0.05f   // Noise (mean absolute deviation) tracking
+#define CUSUM_MIN_SIGMA_G 0.5f    // Noise floor so a very quiet scale doesn't report 100% on everything
+#define CUSUM_T_LOW 2.0f          // Step / noise ratio at 0% confidence...
+#define CUSUM_T_HIGH 10.0f        // ...and at 100%
+
+/**
+ * @brief Get current time in milliseconds
+ */
+static inline uint32_t weight_cusum_millis(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+/**
+ * @brief Clear the sums and any pending confirmation
+ */
+static void weight_cusum_clear_sums(WeightCusum *det) {
+    det->s_pos = 0.0f;
+    det->s_neg = 0.0f;
+    det->confirming = false;
+    det->confirm_len = 0;
+}
+
+/**
+ * @brief Measure the step from the post-alarm samples and publish it
+ */
+static void weight_cusum_confirm(WeightCusum *det, uint32_t now) {
+    uint8_t n = det->confirm_len;
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        sum += det->confirm_buf[i];
+    }
+    float post = sum / n;
+    float var = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        float d = det->confirm_buf[i] - post;
+        var += d * d;
+    }
+    var /= n;
+
+    float step = post - det->mean_g;
+
+    // Step against the uncertainty of both levels (noise_g is a mean absolute deviation)
+    float sigma = fmaxf(1.25f * det->noise_g, CUSUM_MIN_SIGMA_G);
+    float t = fabsf(step) / sqrtf(sigma * sigma + var / n);
+    float conf = (t - CUSUM_T_LOW) / (CUSUM_T_HIGH - CUSUM_T_LOW);
+    conf = fminf(fmaxf(conf, 0.0f), 1.0f);
+
+    cusum_event_t evt = {
+        .magnitude_g = step,
+        .confidence = (uint8_t)lroundf(conf * 100.0f),
+        .t_ms = det->change_ms,
+        .latency_ms = now - det->change_ms,
+    };
+    if (fabsf(step) <= det->cfg.drift_g) {
+        evt.type = CUSUM_EVT_TRANSIENT;
+    } else {
+        // Any level that persisted through the confirmation becomes the new mean,
+        // otherwise a small lasting offset keeps re-alarming
+        evt.type = fabsf(step) < det->cfg.min_step_g ? CUSUM_EVT_SHIFT
+                 : step > 0 ? CUSUM_EVT_ADDED : CUSUM_EVT_REMOVED;
+        det->mean_g = post;
+    }
+    weight_cusum_clear_sums(det);
+
+    ESP_LOGD(TAG, "%s %.1f g (confidence %d%%, %lu ms)", cusum_event_str(evt.type),
+             evt.magnitude_g, evt.confidence, evt.latency_ms);
+    if (det->cb) {
+        det->cb(det, &evt);
+    }
+}
+
+/**
+ * @brief Sample tap installed on the weight filter
+ */
+static void weight_cusum_on_sample(void *ctx, float grams, uint32_t t_ms, bool reseeded) {
+    WeightCusum *det = (WeightCusum *)ctx;
+    if (reseeded) {
+        weight_cusum_reset(det);
+    }
+    weight_cusum_process(det, grams, t_ms);
+}
+
+/**
+ * @brief Create a detector
+ */
+WeightCusum *weight_cusum_create(const weight_cusum_config_t *config, cusum_event_cb_t cb) {
+    if (config == NULL || config->confirm_samples == 0) {
+        return NULL;
+    }
+    WeightCusum *det = (WeightCusum *)calloc(1, sizeof(WeightCusum));
+    if (det == NULL) {
+        return NULL;
+    }
+    det->cfg = *config;
+    det->cb = cb;
+    if (det->cfg.confirm_samples > WEIGHT_CUSUM_MAX_CONFIRM) {
+        det->cfg.confirm_samples = WEIGHT_CUSUM_MAX_CONFIRM;
+    }
+    ESP_LOGI(TAG, "Detector created (k %.1f g, h %.1f g, step >= %.1f g, %d confirm samples)",
+             det->cfg.drift_g, det->cfg.threshold_g, det->cfg.min_step_g, det->cfg.confirm_samples);
+    return det;
+}
+
+/**
+ * @brief Destroy a detector (detach it from its filter first)
+ */
+void weight_cusum_destroy(WeightCusum *det) {
+    free(det);
+}
+
+/**
+ * @brief Feed the detector from a weight filter's sample stream
+ */
+void weight_cusum_attach(WeightCusum *det, WeightFilter *wf) {
+    if (det == NULL || wf == NULL) return;
+    weight_cusum_reset(det);
+    weight_filter_set_sample_cb(wf, weight_cusum_on_sample, det);
+}
+
+/**
+ * @brief Gate the detector on cart motion (safe from any task)
+ */
+void weight_cusum_set_motion(WeightCusum *det, bool moving) {
+    if (det == NULL) return;
+    if (det->motion && !moving) {
+        det->motion_end_ms = weight_cusum_millis();
+    }
+    det->motion = moving;
+}
+
+/**
+ * @brief Run one sample through the detector
+ */
+void weight_cusum_process(WeightCusum *det, float grams, uint32_t t_ms) {
+    // Pushing the cart shakes the basket: drop partial evidence and wait for it to stop.
+    // The level is kept, so anything added meanwhile shows up as a step afterwards.
+    if (det->motion || t_ms - det->motion_end_ms < det->cfg.motion_holdoff_ms) {
+        weight_cusum_clear_sums(det);
+        return;
+    }
+
+    if (!det->seeded) {
+        det->mean_g = grams;
+        det->noise_g = det->cfg.drift_g / 2.0f;
+        det->seeded = true;
+        weight_cusum_clear_sums(det);
+        return;
+    }
+
+    if (det->confirming) {
+        det->confirm_buf[det->confirm_len++] = grams;
+        if (det->confirm_len >= det->cfg.confirm_samples) {
+            weight_cusum_confirm(det, t_ms);
+        }
+        return;
+    }
+
+    float d = grams - det->mean_g;
+    float k = det->cfg.drift_g;
+
+    if (det->s_pos == 0.0f) det->s_pos_start_ms = t_ms;
+    if (det->s_neg == 0.0f) det->s_neg_start_ms = t_ms;
+    det->s_pos = fmaxf(0.0f, det->s_pos + d - k);
+    det->s_neg = fmaxf(0.0f, det->s_neg - d - k);
+
+    if (det->s_pos > det->cfg.threshold_g || det->s_neg > det->cfg.threshold_g) {
+        det->confirming = true;
+        det->change_ms = (det->s_pos > det->cfg.threshold_g) ? det->s_pos_start_ms : det->s_neg_start_ms;
+        det->confirm_len = 0;
+        det->confirm_buf[det->confirm_len++] = grams;
+        if (det->confirm_len >= det->cfg.confirm_samples) {
+            weight_cusum_confirm(det, t_ms);
+        }
+        return;
+    }
+
+    // In control: follow slow creep and learn the noise level
+    if (det->s_pos == 0.0f && det->s_neg == 0.0f) {
+        det->mean_g += CUSUM_MEAN_ALPHA * d;
+        det->noise_g += CUSUM_NOISE_ALPHA * (fabsf(d) - det->noise_g);
+    }
+}
+
+/**
+ * @brief Restart from the next sample
+ */
+void weight_cusum_reset(WeightCusum *det) {
+    if (det == NULL) return;
+    det->seeded = false;
+    weight_cusum_clear_sums(det);
+}
+
+/**
+ * @brief Get a short name for an event type
+ */
+const char *cusum_event_str(cusum_event_type_t type) {
+    switch (type) {
+        case CUSUM_EVT_ADDED:     return "ADDED";
+        case CUSUM_EVT_REMOVED:   return "REMOVED";
+        case CUSUM_EVT_TRANSIENT: return "TRANSIENT";
+        case CUSUM_EVT_SHIFT:     return "SHIFT";
+        default:                  return "UNKNOWN";
+    }
+}
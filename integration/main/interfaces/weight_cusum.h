@@ -0,0 +1,117 @@
+#ifndef WEIGHT_CUSUM_H
+#define WEIGHT_CUSUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "weight_filter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WEIGHT_CUSUM_MAX_CONFIRM 16   // Upper bound for confirm_samples
+
+/**
+ * @brief Step types published by the detector
+ */
+typedef enum {
+    CUSUM_EVT_ADDED = 0,       /**< Level rose and stayed up */
+    CUSUM_EVT_REMOVED,         /**< Level fell and stayed down */
+    CUSUM_EVT_TRANSIENT,       /**< Alarm that returned to within drift_g of the old level (bump, hand on the basket) */
+    CUSUM_EVT_SHIFT,           /**< Lasting change below min_step_g (creep, settling); the level moves to it */
+} cusum_event_type_t;
+
+/**
+ * @brief Detected step
+ */
+typedef struct {
+    cusum_event_type_t type;
+    float magnitude_g;         /**< Signed level change */
+    uint8_t confidence;        /**< 0-100, from the step size against the noise */
+    uint32_t t_ms;             /**< Estimated change point */
+    uint32_t latency_ms;       /**< Change point to event */
+} cusum_event_t;
+
+typedef struct WeightCusum WeightCusum;
+
+/**
+ * @brief Event callback, runs in the weight filter task
+ */
+typedef void (*cusum_event_cb_t)(WeightCusum *det, const cusum_event_t *evt);
+
+/**
+ * @brief Detector tuning
+ */
+typedef struct {
+    float drift_g;             /**< Slack k: deviations below this never accumulate */
+    float threshold_g;         /**< Alarm when a cumulative sum exceeds h */
+    float min_step_g;          /**< Confirmed steps smaller than this are transients */
+    uint8_t confirm_samples;   /**< Samples averaged after an alarm to measure the step */
+    uint32_t motion_holdoff_ms;/**< Detector stays frozen this long after the cart stops */
+} weight_cusum_config_t;
+
+/**
+ * @brief Two-sided CUSUM state
+ */
+struct WeightCusum {
+    weight_cusum_config_t cfg;
+    cusum_event_cb_t cb;
+
+    volatile bool motion;              // set from the IMU task
+    volatile uint32_t motion_end_ms;
+
+    bool seeded;
+    float mean_g;                      // in-control level
+    float noise_g;                     // EWMA of |x - mean|
+    float s_pos;
+    float s_neg;
+    uint32_t s_pos_start_ms;           // last time each sum left zero (change point estimate)
+    uint32_t s_neg_start_ms;
+
+    bool confirming;
+    uint8_t confirm_len;
+    float confirm_buf[WEIGHT_CUSUM_MAX_CONFIRM];
+    uint32_t change_ms;
+};
+
+/**
+ * @brief Create a detector
+ */
+WeightCusum *weight_cusum_create(const weight_cusum_config_t *config, cusum_event_cb_t cb);
+
+/**
+ * @brief Destroy a detector (detach it from its filter first)
+ */
+void weight_cusum_destroy(WeightCusum *det);
+
+/**
+ * @brief Feed the detector from a weight filter's sample stream
+ */
+void weight_cusum_attach(WeightCusum *det, WeightFilter *wf);
+
+/**
+ * @brief Gate the detector on cart motion (safe from any task)
+ */
+void weight_cusum_set_motion(WeightCusum *det, bool moving);
+
+/**
+ * @brief Run one sample through the detector
+ */
+void weight_cusum_process(WeightCusum *det, float grams, uint32_t t_ms);
+
+/**
+ * @brief Restart from the next sample
+ */
+void weight_cusum_reset(WeightCusum *det);
+
+/**
+ * @brief Get a short name for an event type
+ */
+const char *cusum_event_str(cusum_event_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEIGHT_CUSUM_H
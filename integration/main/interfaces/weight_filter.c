@@ -0,0 +1,326 @@
+#include "weight_filter.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+static const char *TAG = "WEIGHT_FILTER";
+
+#define WEIGHT_FILTER_WAIT_MS 200   // Longest wait for a sample before checking for stop/reset
+
+/**
+ * @brief Get current time in milliseconds
+ */
+static inline uint32_t weight_filter_millis(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+/**
+ * @brief Median of the moving window
+ */
+static float weight_filter_median(const WeightFilter *wf) {
+    float buf[WEIGHT_FILTER_MEDIAN_SIZE];
+    uint8_t n = wf->median_len;
+    memcpy(buf, wf->median_buf, n * sizeof(float));
+
+    for (uint8_t i = 1; i < n; i++) {
+        float key = buf[i];
+        int8_t j = i - 1;
+        while (j >= 0 && buf[j] > key) {
+            buf[j + 1] = buf[j];
+            j--;
+        }
+        buf[j + 1] = key;
+    }
+    return buf[n / 2];
+}
+
+/**
+ * @brief Drop all filter history so the next sample seeds it
+ */
+static void weight_filter_seed_clear(WeightFilter *wf) {
+    wf->median_len = 0;
+    wf->median_idx = 0;
+    wf->outlier_run = 0;
+    wf->seeded = false;
+    wf->settled = false;
+    wf->have_baseline = false;
+    wf->sample_reseed = true;
+}
+
+/**
+ * @brief Drop the motion-era history but keep the baseline items are measured against
+ */
+static void weight_filter_motion_reseed(WeightFilter *wf) {
+    wf->median_len = 0;
+    wf->median_idx = 0;
+    wf->outlier_run = 0;
+    wf->seeded = false;
+    wf->settled = false;
+}
+
+/**
+ * @brief Publish an event to the callback
+ */
+static void weight_filter_emit(WeightFilter *wf, weight_event_type_t type, float grams, float delta_g, uint32_t t_ms) {
+    ESP_LOGD(TAG, "%s %.1f g (delta %.1f g)", weight_event_str(type), grams, delta_g);
+    if (wf->cb) {
+        weight_event_t evt = { .type = type, .grams = grams, .delta_g = delta_g, .t_ms = t_ms };
+        wf->cb(wf, &evt);
+    }
+}
+
+/**
+ * @brief Run one sample through outlier rejection, median, IIR and the settle detector
+ */
+static void weight_filter_process(WeightFilter *wf, float x, uint32_t now) {
+    bool low_conf = wf->motion || now - wf->motion_end_ms < wf->cfg.still_window_ms;
+    if (low_conf) {
+        wf->motion_reseed = true;
+    } else if (wf->motion_reseed) {
+        weight_filter_motion_reseed(wf);
+        wf->motion_reseed = false;
+    }
+    wf->low_confidence = low_conf;
+
+    // Outlier rejection against the current median; a persistent offset is a real step
+    if (wf->median_len > 0) {
+        float med = weight_filter_median(wf);
+        if (fabsf(x - med) > wf->cfg.outlier_g) {
+            if (++wf->outlier_run < wf->cfg.outlier_persist) {
+                return;
+            }
+            // Step change: restart the median from the new level
+            wf->median_len = 0;
+            wf->median_idx = 0;
+        }
+    }
+    wf->outlier_run = 0;
+
+    // Moving median
+    wf->median_buf[wf->median_idx] = x;
+    wf->median_idx = (wf->median_idx + 1) % WEIGHT_FILTER_MEDIAN_SIZE;
+    if (wf->median_len < WEIGHT_FILTER_MEDIAN_SIZE) {
+        wf->median_len++;
+    }
+    float med = weight_filter_median(wf);
+    if (wf->sample_cb) {
+        wf->sample_cb(wf->sample_ctx, med, now, wf->sample_reseed);
+    }
+    wf->sample_reseed = false;
+
+    // IIR
+    if (!wf->seeded) {
+        wf->iir_g = med;
+        wf->seeded = true;
+        wf->win_min_g = wf->win_max_g = med;
+        wf->win_start_ms = now;
+    } else {
+        wf->iir_g += wf->cfg.iir_alpha * (med - wf->iir_g);
+    }
+    float y = wf->iir_g;
+    wf->current_g = y;
+
+    // Shaken samples still move the displayed value but can't settle or report items
+    if (low_conf) {
+        wf->win_min_g = wf->win_max_g = y;
+        wf->win_start_ms = now;
+        wf->settled = false;
+        return;
+    }
+
+    // Settle detector: y must stay inside the band for the whole window
+    float lo = fminf(wf->win_min_g, y);
+    float hi = fmaxf(wf->win_max_g, y);
+    if (hi - lo > wf->cfg.settle_band_g) {
+        wf->win_min_g = wf->win_max_g = y;
+        wf->win_start_ms = now;
+        wf->settled = false;
+        return;
+    }
+    wf->win_min_g = lo;
+    wf->win_max_g = hi;
+
+    if (wf->settled || now - wf->win_start_ms < wf->cfg.settle_window_ms) {
+        return;
+    }
+    wf->settled = true;
+
+    float settled_g = (lo + hi) / 2.0f;
+    weight_filter_emit(wf, WEIGHT_EVT_SETTLED, settled_g, 0.0f, now);
+
+    if (wf->have_baseline) {
+        float delta = settled_g - wf->baseline_g;
+        if (delta >= wf->cfg.min_change_g) {
+            weight_filter_emit(wf, WEIGHT_EVT_ITEM_ADDED, settled_g, delta, now);
+        } else if (delta <= -wf->cfg.min_change_g) {
+            weight_filter_emit(wf, WEIGHT_EVT_ITEM_REMOVED, settled_g, delta, now);
+        }
+    }
+    wf->baseline_g = settled_g;
+    wf->have_baseline = true;
+}
+
+/**
+ * @brief Filter task: drain the sampler ring as conversions arrive
+ */
+static void weight_filter_task(void *arg) {
+    WeightFilter *wf = (WeightFilter *)arg;
+    int32_t raw;
+
+    while (wf->running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WEIGHT_FILTER_WAIT_MS));
+
+        // A completed tare moves the zero, re-seed instead of reporting the jump
+        if (wf->lc->tare_generation != wf->tare_generation) {
+            wf->tare_generation = wf->lc->tare_generation;
+            wf->reset_pending = true;
+        }
+
+        if (wf->reset_pending) {
+            weight_filter_seed_clear(wf);
+            while (load_cell_pop_sample(wf->lc, &raw)) {
+                // discard samples taken against the old zero
+            }
+            wf->reset_pending = false;
+            continue;
+        }
+
+        while (load_cell_pop_sample(wf->lc, &raw)) {
+            weight_filter_process(wf, load_cell_raw_to_grams(wf->lc, raw), weight_filter_millis());
+        }
+    }
+
+    task_stop_exit(&wf->stop);
+}
+
+/**
+ * @brief Create a filter for a load cell (the load cell must be sampling)
+ */
+WeightFilter *weight_filter_create(LoadCell *lc, const weight_filter_config_t *config, weight_event_cb_t cb) {
+    if (lc == NULL || config == NULL) {
+        return NULL;
+    }
+    WeightFilter *wf = (WeightFilter *)calloc(1, sizeof(WeightFilter));
+    if (wf == NULL) {
+        return NULL;
+    }
+    task_stop_init(&wf->stop);
+    wf->lc = lc;
+    wf->cfg = *config;
+    wf->cb = cb;
+    if (wf->cfg.outlier_persist == 0) {
+        wf->cfg.outlier_persist = 1;
+    }
+    weight_filter_seed_clear(wf);
+    return wf;
+}
+
+/**
+ * @brief Destroy a filter
+ */
+void weight_filter_destroy(WeightFilter *wf) {
+    if (wf == NULL) return;
+    weight_filter_stop(wf);
+    free(wf);
+}
+
+/**
+ * @brief Start the filter task; it consumes the load cell's sample ring
+ */
+esp_err_t weight_filter_start(WeightFilter *wf, UBaseType_t priority) {
+    if (wf == NULL) return ESP_ERR_INVALID_ARG;
+    if (wf->running) return ESP_OK;
+
+    wf->running = true;
+    wf->reset_pending = true;
+    if (xTaskCreate(weight_filter_task, "weight_filter", 4096, wf, priority, &wf->task) != pdPASS) {
+        wf->running = false;
+        ESP_LOGE(TAG, "Failed to create filter task");
+        return ESP_ERR_NO_MEM;
+    }
+    wf->lc->consumer_task = wf->task;
+
+    ESP_LOGI(TAG, "Filter started (outlier %.0f g x%d, IIR %.2f, settle %lu ms / %.1f g, item >= %.0f g, still %lu ms)",
+             wf->cfg.outlier_g, wf->cfg.outlier_persist, wf->cfg.iir_alpha,
+             wf->cfg.settle_window_ms, wf->cfg.settle_band_g, wf->cfg.min_change_g, wf->cfg.still_window_ms);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop the filter task
+ */
+void weight_filter_stop(WeightFilter *wf) {
+    if (wf == NULL || !wf->running) return;
+    wf->lc->consumer_task = NULL;
+    wf->running = false;
+    task_stop_join(&wf->stop, &wf->task);
+}
+
+/**
+ * @brief Re-seed the filter (e.g. after a tare) without reporting the jump as an item
+ */
+void weight_filter_reset(WeightFilter *wf) {
+    if (wf == NULL) return;
+    wf->reset_pending = true;
+    if (wf->task != NULL) {
+        xTaskNotifyGive(wf->task);
+    }
+}
+
+/**
+ * @brief Install a per-sample tap (set before starting the filter)
+ */
+void weight_filter_set_sample_cb(WeightFilter *wf, weight_sample_cb_t cb, void *ctx) {
+    if (wf == NULL) return;
+    wf->sample_ctx = ctx;
+    wf->sample_cb = cb;
+}
+
+/**
+ * @brief Cart motion state (safe from any task)
+ */
+void weight_filter_set_motion(WeightFilter *wf, bool moving) {
+    if (wf == NULL) return;
+    if (wf->motion && !moving) {
+        wf->motion_end_ms = weight_filter_millis();
+    }
+    wf->motion = moving;
+    if (moving) {
+        wf->low_confidence = true;
+    }
+}
+
+/**
+ * @brief Whether the latest samples were taken with the cart still
+ */
+bool weight_filter_is_confident(const WeightFilter *wf) {
+    return wf ? !wf->low_confidence : false;
+}
+
+/**
+ * @brief Latest filtered weight in grams
+ */
+float weight_filter_get_grams(const WeightFilter *wf) {
+    return wf ? wf->current_g : 0.0f;
+}
+
+/**
+ * @brief Whether the weight is currently settled
+ */
+bool weight_filter_is_settled(const WeightFilter *wf) {
+    return wf ? wf->settled : false;
+}
+
+/**
+ * @brief Get a short name for an event type
+ */
+const char *weight_event_str(weight_event_type_t type) {
+    switch (type) {
+        case WEIGHT_EVT_SETTLED:      return "SETTLED";
+        case WEIGHT_EVT_ITEM_ADDED:   return "ADDED";
+        case WEIGHT_EVT_ITEM_REMOVED: return "REMOVED";
+        default:                      return "UNKNOWN";
+    }
+}
@@ -0,0 +1,164 @@
+#ifndef WEIGHT_FILTER_H
+#define WEIGHT_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "loadcells.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WEIGHT_FILTER_MEDIAN_SIZE 5   // Moving median length (samples)
+
+/**
+ * @brief Events published by the filter
+ */
+typedef enum {
+    WEIGHT_EVT_SETTLED = 0,    /**< Weight became stable */
+    WEIGHT_EVT_ITEM_ADDED,     /**< Settled weight rose by at least min_change_g */
+    WEIGHT_EVT_ITEM_REMOVED,   /**< Settled weight fell by at least min_change_g */
+} weight_event_type_t;
+
+/**
+ * @brief Weight event
+ */
+typedef struct {
+    weight_event_type_t type;
+    float grams;               /**< Settled weight */
+    float delta_g;             /**< Change from the previous settled weight (0 for SETTLED) */
+    uint32_t t_ms;             /**< Time the weight settled */
+} weight_event_t;
+
+typedef struct WeightFilter WeightFilter;
+
+/**
+ * @brief Event callback, runs in the filter task
+ */
+typedef void (*weight_event_cb_t)(WeightFilter *wf, const weight_event_t *evt);
+
+/**
+ * @brief Per-sample tap (median output), runs in the filter task
+ *
+ * reseeded is true for the first sample after a start, reset or tare.
+ */
+typedef void (*weight_sample_cb_t)(void *ctx, float grams, uint32_t t_ms, bool reseeded);
+
+/**
+ * @brief Filter chain tuning
+ */
+typedef struct {
+    float outlier_g;           /**< Samples this far from the median are rejected as spikes */
+    uint8_t outlier_persist;   /**< ...unless this many arrive in a row (a real step) */
+    float iir_alpha;           /**< IIR smoothing after the median, 0-1 (1 = no smoothing) */
+    uint32_t settle_window_ms; /**< Time the weight must stay inside settle_band_g */
+    float settle_band_g;       /**< Max peak-to-peak variation of a settled weight */
+    float min_change_g;        /**< Smallest settled change reported as an item */
+    uint32_t still_window_ms;  /**< Samples stay low-confidence this long after motion ends */
+} weight_filter_config_t;
+
+/**
+ * @brief Per-channel filter state
+ */
+struct WeightFilter {
+    LoadCell *lc;
+    weight_filter_config_t cfg;
+    weight_event_cb_t cb;
+    weight_sample_cb_t sample_cb;
+    void *sample_ctx;
+    bool sample_reseed;        // next tapped sample is the first after a start/reset/tare
+    TaskHandle_t task;
+    TaskStop stop;
+    volatile bool running;
+    volatile bool reset_pending;
+    uint32_t tare_generation;  // load cell tare generation the filter is seeded against
+
+    volatile bool motion;      // set from the IMU task (weight_filter_set_motion)
+    volatile uint32_t motion_end_ms;
+    volatile bool low_confidence;
+    bool motion_reseed;        // re-seed once the cart has been still for still_window_ms
+
+    float median_buf[WEIGHT_FILTER_MEDIAN_SIZE];
+    uint8_t median_len;
+    uint8_t median_idx;
+    uint8_t outlier_run;
+    float iir_g;
+    bool seeded;
+
+    float win_min_g;
+    float win_max_g;
+    uint32_t win_start_ms;
+    bool settled;
+    bool have_baseline;
+    float baseline_g;
+
+    volatile float current_g;
+};
+
+/**
+ * @brief Create a filter for a load cell (the load cell must be sampling)
+ */
+WeightFilter *weight_filter_create(LoadCell *lc, const weight_filter_config_t *config, weight_event_cb_t cb);
+
+/**
+ * @brief Destroy a filter
+ */
+void weight_filter_destroy(WeightFilter *wf);
+
+/**
+ * @brief Start the filter task; it consumes the load cell's sample ring
+ */
+esp_err_t weight_filter_start(WeightFilter *wf, UBaseType_t priority);
+
+/**
+ * @brief Stop the filter task
+ */
+void weight_filter_stop(WeightFilter *wf);
+
+/**
+ * @brief Re-seed the filter (e.g. after a tare) without reporting the jump as an item
+ */
+void weight_filter_reset(WeightFilter *wf);
+
+/**
+ * @brief Install a per-sample tap (set before starting the filter)
+ */
+void weight_filter_set_sample_cb(WeightFilter *wf, weight_sample_cb_t cb, void *ctx);
+
+/**
+ * @brief Cart motion state (safe from any task)
+ *
+ * Samples taken while moving, and for still_window_ms afterwards, are
+ * low-confidence: they update the weight but never settle or raise events.
+ * The filter then re-seeds from the post-motion samples and keeps the
+ * pre-motion baseline, so anything added meanwhile is reported once settled.
+ */
+void weight_filter_set_motion(WeightFilter *wf, bool moving);
+
+/**
+ * @brief Whether the latest samples were taken with the cart still
+ */
+bool weight_filter_is_confident(const WeightFilter *wf);
+
+/**
+ * @brief Latest filtered weight in grams
+ */
+float weight_filter_get_grams(const WeightFilter *wf);
+
+/**
+ * @brief Whether the weight is currently settled
+ */
+bool weight_filter_is_settled(const WeightFilter *wf);
+
+/**
+ * @brief Get a short name for an event type
+ */
+const char *weight_event_str(weight_event_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEIGHT_FILTER_H
@@ -0,0 +1,154 @@
+#include "weight_stream.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <math.h>
+
+static const char *TAG = "WEIGHT_STREAM";
+
+#define WEIGHT_STREAM_MIN_PERIOD_MS 50   // Filter output changes at most at the HX711 rate anyway
+
+static portMUX_TYPE stream_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Get current time in milliseconds
+ */
+static inline uint32_t weight_stream_millis(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+/**
+ * @brief Stream task: sample the filter at the configured rate, push on change or settle
+ */
+static void weight_stream_task(void *arg) {
+    WeightStream *ws = (WeightStream *)arg;
+
+    while (ws->running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ws->cfg.period_ms));
+        if (!ws->running) {
+            break;
+        }
+
+        float grams = weight_filter_get_grams(ws->wf);
+
+        if (weight_stream_millis() - ws->start_ms >= ws->cfg.timeout_ms) {
+            // Decide together with weight_stream_start: a start that got in first extended
+            // the timeout, one that comes after sees running false and reaps this task
+            portENTER_CRITICAL(&stream_spinlock);
+            bool timed_out = weight_stream_millis() - ws->start_ms >= ws->cfg.timeout_ms;
+            if (timed_out) {
+                ws->running = false;
+            }
+            portEXIT_CRITICAL(&stream_spinlock);
+            if (timed_out) {
+                ESP_LOGI(TAG, "Stream timed out");
+                if (ws->cb) {
+                    ws->cb(ws, grams, WEIGHT_STREAM_TIMEOUT);
+                }
+                break;
+            }
+        }
+
+        // Values during a tare are meaningless, wait for the filter to re-seed
+        if (load_cell_is_taring(ws->wf->lc)) {
+            ws->have_sent = false;
+            ws->was_settled = false;
+            continue;
+        }
+
+        bool settled = weight_filter_is_settled(ws->wf);
+        weight_stream_reason_t reason;
+        if (settled && !ws->was_settled) {
+            reason = WEIGHT_STREAM_SETTLED;
+        } else if (!ws->have_sent || fabsf(grams - ws->last_sent_g) >= ws->cfg.threshold_g) {
+            reason = WEIGHT_STREAM_CHANGE;
+        } else {
+            ws->was_settled = settled;
+            continue;
+        }
+        ws->was_settled = settled;
+        ws->have_sent = true;
+        ws->last_sent_g = grams;
+        if (ws->cb) {
+            ws->cb(ws, grams, reason);
+        }
+    }
+
+    task_stop_exit(&ws->stop);
+}
+
+/**
+ * @brief Create a stream for a filter (not started)
+ */
+WeightStream *weight_stream_create(WeightFilter *wf, weight_stream_cb_t cb) {
+    if (wf == NULL) {
+        return NULL;
+    }
+    WeightStream *ws = (WeightStream *)calloc(1, sizeof(WeightStream));
+    if (ws == NULL) {
+        return NULL;
+    }
+    ws->wf = wf;
+    ws->cb = cb;
+    task_stop_init(&ws->stop);
+    return ws;
+}
+
+/**
+ * @brief Destroy a stream
+ */
+void weight_stream_destroy(WeightStream *ws) {
+    if (ws == NULL) return;
+    weight_stream_stop(ws);
+    free(ws);
+}
+
+/**
+ * @brief Start streaming, or apply a new config and restart the timeout if running
+ */
+esp_err_t weight_stream_start(WeightStream *ws, const weight_stream_config_t *config, UBaseType_t priority) {
+    if (ws == NULL || config == NULL || config->timeout_ms == 0) return ESP_ERR_INVALID_ARG;
+
+    weight_stream_config_t cfg = *config;
+    if (cfg.period_ms < WEIGHT_STREAM_MIN_PERIOD_MS) {
+        cfg.period_ms = WEIGHT_STREAM_MIN_PERIOD_MS;
+    }
+    portENTER_CRITICAL(&stream_spinlock);
+    ws->cfg = cfg;
+    ws->start_ms = weight_stream_millis();
+    bool running = ws->running;
+    portEXIT_CRITICAL(&stream_spinlock);
+    if (running) {
+        return ESP_OK;
+    }
+
+    task_stop_join(&ws->stop, &ws->task);    // a stream that timed out
+    ws->have_sent = false;
+    ws->was_settled = false;
+    ws->running = true;
+    if (xTaskCreate(weight_stream_task, "weight_stream", 3072, ws, priority, &ws->task) != pdPASS) {
+        ws->running = false;
+        ESP_LOGE(TAG, "Failed to create stream task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Stream started (every %lu ms, change >= %.1f g, timeout %lu ms)",
+             ws->cfg.period_ms, ws->cfg.threshold_g, ws->cfg.timeout_ms);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop streaming (no timeout push)
+ */
+void weight_stream_stop(WeightStream *ws) {
+    if (ws == NULL) return;
+    ws->running = false;
+    task_stop_join(&ws->stop, &ws->task);
+}
+
+/**
+ * @brief Whether the stream is active
+ */
+bool weight_stream_is_running(const WeightStream *ws) {
+    return ws ? ws->running : false;
+}
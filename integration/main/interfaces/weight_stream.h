@@ -0,0 +1,85 @@
+#ifndef WEIGHT_STREAM_H
+#define WEIGHT_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "task_stop.h"
+#include "weight_filter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Why a value was pushed
+ */
+typedef enum {
+    WEIGHT_STREAM_CHANGE = 0,  /**< Moved by at least threshold_g since the last push */
+    WEIGHT_STREAM_SETTLED,     /**< Filter reported the weight as settled */
+    WEIGHT_STREAM_TIMEOUT,     /**< Stream stopped itself; last value repeated */
+} weight_stream_reason_t;
+
+typedef struct WeightStream WeightStream;
+
+/**
+ * @brief Push callback, runs in the stream task
+ */
+typedef void (*weight_stream_cb_t)(WeightStream *ws, float grams, weight_stream_reason_t reason);
+
+/**
+ * @brief Stream tuning
+ */
+typedef struct {
+    uint32_t period_ms;        /**< Check (and max push) rate */
+    float threshold_g;         /**< Smallest change pushed between settles */
+    uint32_t timeout_ms;       /**< Stream stops this long after the last start */
+} weight_stream_config_t;
+
+/**
+ * @brief Rate-limited push stream over a weight filter
+ */
+struct WeightStream {
+    WeightFilter *wf;
+    weight_stream_cb_t cb;
+    weight_stream_config_t cfg;
+    TaskHandle_t task;
+    TaskStop stop;
+    volatile bool running;
+    volatile uint32_t start_ms;
+
+    bool have_sent;
+    float last_sent_g;
+    bool was_settled;
+};
+
+/**
+ * @brief Create a stream for a filter (not started)
+ */
+WeightStream *weight_stream_create(WeightFilter *wf, weight_stream_cb_t cb);
+
+/**
+ * @brief Destroy a stream
+ */
+void weight_stream_destroy(WeightStream *ws);
+
+/**
+ * @brief Start streaming, or apply a new config and restart the timeout if running
+ */
+esp_err_t weight_stream_start(WeightStream *ws, const weight_stream_config_t *config, UBaseType_t priority);
+
+/**
+ * @brief Stop streaming (no timeout push)
+ */
+void weight_stream_stop(WeightStream *ws);
+
+/**
+ * @brief Whether the stream is active
+ */
+bool weight_stream_is_running(const WeightStream *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEIGHT_STREAM_H
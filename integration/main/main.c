@@ -10,10 +10,29 @@ static barcode_t barcanner;
 static ProximitySensor* proximity_sensor = NULL;
 static mfrc522_t paymenter;
 static ICM20948_t imu_sensor;
+static ImuFifo* imu_fifo = NULL;
+static ImuWake* imu_wake = NULL;
+static ImuAhrs* imu_ahrs = NULL;
+static CartOdometry* cart_odometry = NULL;
+static ImuLevel* imu_level = NULL;
+static ImuClassifier* imu_classifier = NULL;
+static ImuMagCal* imu_mag_cal = NULL;
+static ImuAlert* imu_alert = NULL;
+static ImuRates* imu_rates = NULL;
 static item_rfid_reader_t* item_reader = NULL;
 
 static LoadCell* produce_load_cell = NULL;
 static LoadCell* cart_load_cell = NULL;
+static WeightFilter* produce_weight_filter = NULL;
+static WeightFilter* cart_weight_filter = NULL;
+static WeightStream* produce_stream = NULL;
+static WeightCusum* cart_weight_cusum = NULL;
+static LoadCellHealth* load_cell_health = NULL;
+static volatile bool iv_deferred_by_motion = false;  // a scan skipped the weight while the cart moved
+static volatile bool iv_deferred_by_tare = false;    // a scan is due once the cart tare completes
+#if ENABLE_LOAD_CELL_GROUP
+static LoadCellGroup* load_cell_group = NULL;
+#endif
 
 static i2c_master_bus_handle_t i2c_bus_handle = NULL;
 
@@ -23,7 +42,11 @@ static QueueHandle_t imu_idle_evt_queue = NULL;
 static QueueHandle_t imu_motion_after_idle_queue = NULL;
 
 static TaskHandle_t item_verification_task_handle = NULL;
+static TaskStop item_verification_stop;
+static volatile bool item_verification_running = false;
 static TaskHandle_t imu_monitor_task_handle = NULL;
+static TaskStop imu_monitor_stop;
+static volatile bool imu_monitor_running = false;
 static TaskHandle_t cart_tracking_task_handle = NULL;
 
 // ===== Variables =====
@@ -47,6 +70,9 @@ static void button_setup(void);
 static void payment_setup(void);
 static void produce_loadcell_setup(void);
 static void cart_loadcell_setup(void);
+static void loadcell_pipeline_setup(void);
+static void loadcell_acquisition_start(void);
+static void loadcell_acquisition_stop(void);
 static void item_rfid_setup(void);
 static void cart_tracking_setup(void);
 
@@ -57,10 +83,26 @@ static void handle_imu_idle_event(void);
 static void handle_imu_motion_after_idle_event(void);
 void on_item_scan_complete(const item_rfid_tag_t *tags, int count);
 static void safe_ble_send_misc_data(const char *data);
+static int registry_add_batch(const char *args);
+static bool iv_clear_authorized(const char *pin);
+static void report_iv_verdict(bool force);
+static void on_cart_weight_event(WeightFilter *wf, const weight_event_t *evt);
+static void on_tare_complete(LoadCell *lc, void *ctx);
+static void on_produce_stream(WeightStream *ws, float grams, weight_stream_reason_t reason);
+static void on_cart_step(WeightCusum *det, const cusum_event_t *evt);
+static void on_load_cell_health(const char *name, LoadCell *lc, load_cell_health_t state);
+static void handle_cal_command(const char *data);
 
 static void item_verification_task(void *arg);
+static void item_verification_task_stop(void);
 static void cart_tracking_task(void *arg);
 static void icm20948_monitor_task(void *arg);
+static void publish_cart_motion(bool moving);
+static void on_imu_block(void *ctx, const imu_fifo_block_t *blk);
+static void on_imu_wake(void *ctx, imu_wake_event_t evt);
+static void on_imu_class(void *ctx, imu_class_t cls, const imu_class_features_t *f);
+static void on_imu_mag_cal(void *ctx, imu_mag_cal_result_t result, const icm20948_mag_cal_t *cal, float fit_err);
+static void on_imu_alert(void *ctx, const imu_alert_t *alert);
 
 static void outdoor_setting();
 static void indoor_setting();
@@ -89,6 +131,7 @@ static void setup(void)
     payment_setup();
     produce_loadcell_setup();
     cart_loadcell_setup();
+    loadcell_pipeline_setup();
 
     #if ENABLE_ITEM_VERIFICATION
     item_rfid_setup();
@@ -180,6 +223,9 @@ void app_main(void)
         if (barcode_read_line(&barcanner, buf, sizeof(buf)))
         {
             ESP_LOGI(TAG, "Scanned: %s", buf);
+            iv_trigger_post(IV_TRIGGER_BARCODE);
+            tag_registry_mark_scanned(buf);
+            iv_fusion_on_barcode(buf);
 
             // Send barcode data over BLE
             if (ble_is_connected()) {
@@ -243,14 +289,16 @@ static void handle_ble_command(const char *data, uint16_t len)
         case 'T':  // "TARE_" commands
             if(strcmp("TARE_PRODUCE_WEIGHT", data) == 0 || strcmp("TARE_PROD_WEIGHT", data) == 0 || strcmp("T_PROD", data) == 0) {
                 ESP_LOGI(TAG, "BLE Command: Taring produce load cell");
-                load_cell_tare(produce_load_cell);
-                ESP_LOGI(TAG, "produce taring done");
+                if (load_cell_tare_async(produce_load_cell, on_tare_complete, "PROD") != ESP_OK) {
+                    safe_ble_send_misc_data("[TARE] PROD BUSY");
+                }
                 break;
             }
             else if(strcmp("TARE_CART_WEIGHT", data) == 0 || strcmp("T_CART", data) == 0) {
                 ESP_LOGI(TAG, "BLE Command: Taring cart load cell");
-                load_cell_tare(cart_load_cell);
-                ESP_LOGI(TAG, "cart taring done");
+                if (load_cell_tare_async(cart_load_cell, on_tare_complete, "CART") != ESP_OK) {
+                    safe_ble_send_misc_data("[TARE] CART BUSY");
+                }
                 break;
             }
             break;
@@ -259,6 +307,9 @@ static void handle_ble_command(const char *data, uint16_t len)
             if(strcmp("MEASURE_PRODUCE_WEIGHT", data) == 0 || strcmp("MEASURE_PROD_WEIGHT", data) == 0 || strcmp("M_PROD", data) == 0) {
                 ESP_LOGI(TAG, "BLE Command: Measuring produce weight");
                 float weight = load_cell_display_ounces(produce_load_cell);
+                if (isnan(weight)) {
+                    weight = 0.0f; // taring - the Pi asks again on 0
+                }
                 char weight_str[32];
                 snprintf(weight_str, sizeof(weight_str), "%.4f", weight);
                 ble_send_produce_weight(weight_str);
@@ -268,14 +319,66 @@ static void handle_ble_command(const char *data, uint16_t len)
                 ESP_LOGI(TAG, "BLE Command: Measuring cart weight");
                 float weight = load_cell_display_pounds(cart_load_cell);
                 char weight_str[32];
-                snprintf(weight_str, sizeof(weight_str), "[CART_LOAD] %.4f", weight);
+                if (isnan(weight)) {
+                    snprintf(weight_str, sizeof(weight_str), "[CART_LOAD] TARING");
+                } else {
+                    snprintf(weight_str, sizeof(weight_str), "[CART_LOAD] %.4f", weight);
+                }
                 safe_ble_send_misc_data(weight_str);
                 break;
             }
             break;
 
-        case 'P':  // Payment module or Proximity sensor commands
-            if(strcmp("PAY_START", data) == 0) {
+        case 'L': // "LC_" load cell health
+            if(strcmp("LC_HEALTH", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Load cell health");
+                for (int i = 0; i < load_cell_health->count; i++) {
+                    const load_cell_health_entry_t *e = &load_cell_health->entries[i];
+                    char health_msg[96];
+                    snprintf(health_msg, sizeof(health_msg), "[LOAD] HEALTH %s %s zero %.2f timeouts %lu errors %lu",
+                             e->name, load_cell_health_str(e->state), load_cell_health_zero_g(e),
+                             e->lc->read_timeouts, e->lc->read_errors);
+                    safe_ble_send_misc_data(health_msg);
+                }
+                break;
+            }
+            break;
+
+        case 'P':  // Payment module, Proximity sensor or "PS_" produce stream commands
+            if(strncmp("PS_START", data, 8) == 0) {
+                // PS_START[,<period_ms>,<threshold_g>,<timeout_s>]
+                weight_stream_config_t ps_cfg = {
+                    .period_ms = PRODUCE_STREAM_PERIOD_MS,
+                    .threshold_g = PRODUCE_STREAM_THRESHOLD_G,
+                    .timeout_ms = PRODUCE_STREAM_TIMEOUT_MS,
+                };
+                unsigned long period_ms, timeout_s;
+                float threshold_g;
+                if (sscanf(data, "PS_START,%lu,%f,%lu", &period_ms, &threshold_g, &timeout_s) == 3) {
+                    ps_cfg.period_ms = period_ms;
+                    ps_cfg.threshold_g = threshold_g;
+                    ps_cfg.timeout_ms = timeout_s * 1000UL;
+                }
+                ESP_LOGI(TAG, "BLE Command: Streaming produce weight");
+                if (weight_stream_start(produce_stream, &ps_cfg, PRODUCE_STREAM_TASK_PRIORITY) == ESP_OK) {
+                    safe_ble_send_misc_data("[PROD] STREAM ON");
+                } else {
+                    safe_ble_send_misc_data("[PROD] STREAM ERROR");
+                }
+                break;
+            }
+            else if(strcmp("PS_STOP", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Stopping produce weight stream");
+                weight_stream_stop(produce_stream);
+                safe_ble_send_misc_data("[PROD] STREAM OFF");
+                break;
+            }
+            else if(strcmp("PAY_START", data) == 0) {
+                if (iv_fusion_checkout_frozen()) {
+                    ESP_LOGW(TAG, "BLE Command: Checkout frozen by item verification");
+                    safe_ble_send_misc_data("[PAY] FROZEN");
+                    break;
+                }
                 ESP_LOGI(TAG, "BLE Command: Checking payment status - enabling payment module");
                 mode_payment = true;
                 ESP_LOGI(TAG, "Payment task: Waiting for card...");
@@ -347,13 +450,124 @@ static void handle_ble_command(const char *data, uint16_t len)
                          imu_sensor.accel.x, imu_sensor.accel.y, imu_sensor.accel.z);
                 safe_ble_send_misc_data(accel_str);
             }
+            else if(strncmp("IMU_BENCH", data, 9) == 0) {
+                // IMU_BENCH[,<iterations>]
+                unsigned long iterations = 100;
+                sscanf(data, "IMU_BENCH,%lu", &iterations);
+                if (iterations > IMU_BENCH_MAX_ITERATIONS) {
+                    iterations = IMU_BENCH_MAX_ITERATIONS;   // runs on the BLE host task
+                }
+                ESP_LOGI(TAG, "BLE Command: Benchmarking IMU bus reads (%lu iterations)", iterations);
+                icm20948_bench_t bench;
+                char bench_str[80];
+                if (icm20948_benchmark_bus(&imu_sensor, iterations, &bench) == ESP_OK) {
+                    snprintf(bench_str, sizeof(bench_str), "[IMU] BENCH: REG=%luus/%d BURST=%luus/%d N=%lu",
+                             bench.per_register_us, bench.per_register_transactions,
+                             bench.burst_us, bench.burst_transactions, bench.iterations);
+                } else {
+                    snprintf(bench_str, sizeof(bench_str), "[IMU] BENCH: ERROR");
+                }
+                safe_ble_send_misc_data(bench_str);
+            }
             else if(strcmp("IMU_HEADING", data) == 0) {
                 ESP_LOGI(TAG, "BLE Command: Getting IMU heading");
-                float heading = icm20948_compute_heading(&imu_sensor);
+                imu_ahrs_state_t att;
+                float heading = imu_ahrs_get(imu_ahrs, &att) ? att.heading_deg
+                                                             : icm20948_compute_heading(&imu_sensor);
                 char heading_str[32];
                 snprintf(heading_str, sizeof(heading_str), "[IMU] HEADING: %.2f", heading);
                 safe_ble_send_misc_data(heading_str);
             }
+            else if(strcmp("IMU_CLASS", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Getting IMU motion class");
+                imu_class_features_t feat;
+                char class_str[128];
+                if (imu_classifier_get(imu_classifier, &feat)) {
+                    snprintf(class_str, sizeof(class_str),
+                             "[IMU] CLASS: %s VAR=%.5f JERK=%.1f/%.1f BANDS=%.4f/%.4f/%.4f LIFT=%.2f TILT=%.1f CPU=%luus AVG=%.0fus MAX=%luus",
+                             imu_class_str(feat.cls), feat.var_g2, feat.jerk_rms_gps, feat.jerk_peak_gps,
+                             feat.band_low, feat.band_mid, feat.band_high, feat.lift_g, feat.tilt_deg,
+                             feat.cpu_us, feat.cpu_us_avg, feat.cpu_us_max);
+                } else {
+                    snprintf(class_str, sizeof(class_str), "[IMU] CLASS: NONE");
+                }
+                safe_ble_send_misc_data(class_str);
+            }
+            else if(strcmp("IMU_ATTITUDE", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Getting IMU attitude");
+                imu_ahrs_state_t att;
+                char att_str[64];
+                if (imu_ahrs_get(imu_ahrs, &att)) {
+                    snprintf(att_str, sizeof(att_str), "[IMU] ATTITUDE: H=%.1f P=%.1f R=%.1f MAG=%d",
+                             att.heading_deg, att.pitch_deg, att.roll_deg, att.mag_valid);
+                } else {
+                    snprintf(att_str, sizeof(att_str), "[IMU] ATTITUDE: NONE");
+                }
+                safe_ble_send_misc_data(att_str);
+            }
+            else if(strcmp("IMU_ALERTS", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Getting IMU alert stats");
+                char alert_str[96];
+                if (imu_alert != NULL) {
+                    snprintf(alert_str, sizeof(alert_str),
+                             "[IMU] ALERTS: TIP=%lu LIFT=%lu IMPACT=%lu DROPPED=%lu MAXLAT=%luus",
+                             imu_alert->counts[IMU_ALERT_TIP], imu_alert->counts[IMU_ALERT_LIFT],
+                             imu_alert->counts[IMU_ALERT_IMPACT], imu_alert->dropped, imu_alert->latency_us_max);
+                } else {
+                    snprintf(alert_str, sizeof(alert_str), "[IMU] ALERTS: DISABLED");
+                }
+                safe_ble_send_misc_data(alert_str);
+            }
+            else if(strncmp("IMU_RATE", data, 8) == 0) {
+                // IMU_RATE (query), IMU_RATE,<odr_hz>,<window_ms>,<event_ms> (set + save), IMU_RATE_RESET
+                char rate_str[96];
+                unsigned long odr_hz, window_ms, event_ms;
+                esp_err_t ret = ESP_OK;
+                if (imu_rates == NULL) {
+                    ret = ESP_ERR_INVALID_STATE;
+                } else if (strcmp("IMU_RATE_RESET", data) == 0) {
+                    ESP_LOGI(TAG, "BLE Command: Resetting IMU rates");
+                    ret = imu_rates_reset(imu_rates);
+                } else if (sscanf(data, "IMU_RATE,%lu,%lu,%lu", &odr_hz, &window_ms, &event_ms) == 3) {
+                    ESP_LOGI(TAG, "BLE Command: Setting IMU rates");
+                    imu_rates_t rates = { .odr_hz = odr_hz, .window_ms = window_ms, .event_ms = event_ms };
+                    ret = imu_rates_apply(imu_rates, &rates);
+                    if (ret == ESP_OK) {
+                        imu_rates_save(imu_rates);
+                    }
+                } else if (strcmp("IMU_RATE", data) != 0) {
+                    ret = ESP_ERR_INVALID_ARG;
+                }
+
+                if (ret == ESP_OK) {
+                    snprintf(rate_str, sizeof(rate_str), "[IMU] RATE: ODR=%lu WINDOW=%lums EVENT=%lums FIFO=%.1fHz/%u",
+                             imu_rates->rates.odr_hz, imu_rates->rates.window_ms, imu_rates->rates.event_ms,
+                             imu_sensor.fifo_odr_hz, imu_fifo ? imu_fifo->cfg.watermark : 0);
+                } else {
+                    snprintf(rate_str, sizeof(rate_str), "[IMU] RATE ERROR: %s", esp_err_to_name(ret));
+                }
+                safe_ble_send_misc_data(rate_str);
+            }
+            else if(strcmp("IMU_MAGCAL", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Starting magnetometer calibration");
+                esp_err_t ret = imu_mag_cal_start(imu_mag_cal, IMU_MAG_CAL_TASK_PRIORITY);
+                if (ret == ESP_OK) {
+                    safe_ble_send_misc_data("[IMU] MAGCAL STARTED");
+                } else if (ret == ESP_ERR_INVALID_STATE) {
+                    safe_ble_send_misc_data("[IMU] MAGCAL BUSY");
+                } else {
+                    safe_ble_send_misc_data("[IMU] MAGCAL ERROR");
+                }
+            }
+            else if(strcmp("IMU_MAGCAL_RESET", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Resetting magnetometer calibration");
+                imu_mag_cal_stop(imu_mag_cal);
+                if (icm20948_mag_cal_reset(&imu_sensor) == ESP_OK) {
+                    safe_ble_send_misc_data("[IMU] MAGCAL RESET");
+                } else {
+                    safe_ble_send_misc_data("[IMU] MAGCAL RESET NOT SAVED");
+                }
+            }
             else if(strcmp("IV_TRIG", data) == 0 || strcmp("IV_SCAN", data) == 0) {
                 ESP_LOGI(TAG, "BLE Command: Force triggering item scan");
 
@@ -366,28 +580,67 @@ static void handle_ble_command(const char *data, uint16_t len)
 
                 break;
             }
+            else if(strcmp("IV_STATS", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Getting item verification trigger stats");
+                iv_trigger_stats_t iv_stats;
+                iv_trigger_get_stats(&iv_stats);
+                char iv_stats_str[64];
+                snprintf(iv_stats_str, sizeof(iv_stats_str), "[IV] SCANS: %lu TRIGGERS: %lu PERIODIC: %lu",
+                         iv_stats.scans, iv_stats.triggers, iv_stats.periodic_scans);
+                safe_ble_send_misc_data(iv_stats_str);
+                break;
+            }
+            else if(strcmp("IV_VERDICT", data) == 0) {
+                report_iv_verdict(true);
+                break;
+            }
+            else if(strncmp("IV_CLEAR", data, 8) == 0) {
+                // IV_CLEAR,<pin>: staff only, it unfreezes checkout
+                if (data[8] != ',' || !iv_clear_authorized(data + 9)) {
+                    ESP_LOGW(TAG, "BLE Command: IV_CLEAR refused");
+                    safe_ble_send_misc_data("[IV] CLEAR DENIED");
+                    break;
+                }
+                ESP_LOGI(TAG, "BLE Command: Clearing item verification findings");
+                iv_fusion_clear();
+                report_iv_verdict(true);
+                break;
+            }
             break;
         
-        case 'C': // Cart Tracking - txt file commands
+        case 'C': // Cart Tracking - txt file commands, or "CAL_" load cell calibration
+            if (strncmp("CAL_", data, 4) == 0) {
+                handle_cal_command(data);
+                break;
+            }
             safe_ble_send_misc_data("[IMU] Moving");
 
             if(strcmp("CT_START", data) == 0) {
-                load_cell_tare(cart_load_cell);
-                ESP_LOGI(TAG, "Load cell tared for tracking");
+                #if ENABLE_CART_TRACKING && ENABLE_ITEM_VERIFICATION
+                iv_deferred_by_tare = true;  // the initial scan needs the tared weight
+                #endif
+                load_cell_tare_async(cart_load_cell, on_tare_complete, "CART");
+                ESP_LOGI(TAG, "Taring load cell for tracking");
                 
                 #if ENABLE_CART_TRACKING
                 ESP_LOGI(TAG, "Starting cart tracking data logging");
                 startSession();
+                cart_odometry_start(cart_odometry);
 
                 #if ENABLE_ITEM_VERIFICATION
-                item_rfid_scan(item_reader);
-                ESP_LOGI(TAG, "Initial item scan performed for tracking session");
+                ESP_LOGI(TAG, "Initial item scan queued until the cart tare completes");
                 #else
                 ESP_LOGI(TAG, "Item Verification is DISABLED - skipping initial item scan for tracking session");
                 #endif
 
+                item_verification_task_stop();
+                iv_trigger_reset();
+                tag_classifier_reset();
+                tag_registry_clear_scanned();
+                iv_fusion_reset();
+                item_verification_running = true;
                 xTaskCreate(item_verification_task, "item_verification", 8192, NULL, IV_TASK_PRIORITY, &item_verification_task_handle);
-                ESP_LOGI(TAG, "Item verification task created (interval: %d ms)", ITEM_VERIFICATION_INTERVAL_MS);
+                ESP_LOGI(TAG, "Item verification task created (fallback interval: %d ms)", IV_FALLBACK_INTERVAL_MS);
 
                 mode_cart_tracking = true;
                 xTaskCreate(cart_tracking_task, "cart_tracking", 8192, NULL, CT_TASK_PRIORITY, &cart_tracking_task_handle);
@@ -411,12 +664,11 @@ static void handle_ble_command(const char *data, uint16_t len)
                     ESP_LOGI(TAG, "Cart tracking task stopped");
                 }
 
-                if (item_verification_task_handle != NULL) {
-                    vTaskDelete(item_verification_task_handle);
-                    item_verification_task_handle = NULL;
-                    ESP_LOGI(TAG, "Item verification task stopped");
-                }
+                item_verification_task_stop();
 
+                // Last stretch of dead reckoning after the final burst
+                cart_odometry_stop(cart_odometry);
+                cart_odometry_write(cart_odometry, CT_SESSION_LOG);
                 endSession(true);
                 #else
                 ESP_LOGI(TAG, "Cart Tracking is DISABLED - cannot stop tracking session");
@@ -437,20 +689,85 @@ static void handle_ble_command(const char *data, uint16_t len)
                 }
 
                 // Stop item verification
-                if (item_verification_task_handle != NULL) {
-                    vTaskDelete(item_verification_task_handle);
-                    item_verification_task_handle = NULL;
-                    ESP_LOGI(TAG, "Item verification task stopped");
-                }
+                item_verification_task_stop();
 
                 // End session and remove file without sending
+                cart_odometry_stop(cart_odometry);
                 endSession(false);
+                tag_registry_clear_scanned();
+                iv_fusion_reset();
                 #else
                 ESP_LOGI(TAG, "Cart Tracking is DISABLED - cannot clear tracking session");
                 safe_ble_send_misc_data("[ERROR] CT_DISABLED");
                 #endif
             }
             break;
+        case 'R': // "REG_" RFID -> UPC registry commands, pushed by the Pi at session start
+            if(strcmp("REG_CLEAR", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Clearing RFID registry");
+                tag_registry_clear();
+                break;
+            }
+            else if(strncmp("REG_ADD,", data, 8) == 0) {
+                int failed = registry_add_batch(data + 8);
+                ESP_LOGI(TAG, "BLE Command: RFID registry now holds %d tags", tag_registry_count());
+                if (failed > 0) {
+                    char reg_str[32];
+                    snprintf(reg_str, sizeof(reg_str), "[REG] ADD_FAILED: %d", failed);
+                    safe_ble_send_misc_data(reg_str);
+                }
+                break;
+            }
+            else if(strncmp("REG_UNSCAN,", data, 11) == 0) {
+                // REG_UNSCAN,<upc>[,<qty>]
+                char upc[TAG_REGISTRY_UPC_LEN + 1];
+                unsigned qty = 1;
+                if (sscanf(data + 11, "%15[^,],%u", upc, &qty) < 1 || qty == 0 || qty > UINT16_MAX) {
+                    ESP_LOGW(TAG, "BLE Command: invalid REG_UNSCAN '%s'", data);
+                    break;
+                }
+                ESP_LOGI(TAG, "BLE Command: %u x UPC %s removed from cart", qty, upc);
+                tag_registry_unmark_scanned(upc, (uint16_t)qty);
+                break;
+            }
+            else if(strcmp("REG_STATUS", data) == 0) {
+                char reg_str[32];
+                snprintf(reg_str, sizeof(reg_str), "[REG] TAGS: %d", tag_registry_count());
+                safe_ble_send_misc_data(reg_str);
+                break;
+            }
+            break;
+        case 'E': // "EW_" expected item weights, pushed by the Pi as items are added
+            if(strncmp("EW_ADD,", data, 7) == 0) {
+                char upc[TAG_REGISTRY_UPC_LEN + 1];
+                float weight_g = 0.0f, tol_g = 0.0f;
+                if (sscanf(data + 7, "%15[^,],%f,%f", upc, &weight_g, &tol_g) != 3 ||
+                    iv_fusion_expect_add(upc, weight_g, tol_g) != ESP_OK) {
+                    ESP_LOGW(TAG, "BLE Command: Invalid expected weight '%s'", data);
+                    safe_ble_send_misc_data("[EW] ADD_FAILED");
+                    break;
+                }
+                ESP_LOGI(TAG, "BLE Command: Expecting %s at %.0f g (+/- %.0f g)", upc, weight_g, tol_g);
+                break;
+            }
+            else if(strncmp("EW_REMOVE,", data, 10) == 0) {
+                // EW_REMOVE,<upc>[,<weight_g>] (the weight it was added with, for produce)
+                char upc[TAG_REGISTRY_UPC_LEN + 1];
+                float weight_g = -1.0f;
+                if (sscanf(data + 10, "%15[^,],%f", upc, &weight_g) < 1) {
+                    ESP_LOGW(TAG, "BLE Command: Invalid expected weight removal '%s'", data);
+                    break;
+                }
+                ESP_LOGI(TAG, "BLE Command: No longer expecting one %s", upc);
+                iv_fusion_expect_remove(upc, weight_g);
+                break;
+            }
+            else if(strcmp("EW_CLEAR", data) == 0) {
+                ESP_LOGI(TAG, "BLE Command: Clearing expected weights");
+                iv_fusion_expect_clear();
+                break;
+            }
+            break;
         case 'O':
             if(strcmp("OUTDOOR_MODE_ON", data) == 0){
                 ESP_LOGI(TAG, "BLE Command: Switching to OUTDOOR mode");
@@ -504,6 +821,11 @@ static void imu_setup(void){
     icm20948_init(&imu_sensor, i2c_bus_handle);
     ESP_LOGI(TAG, "IMU initialized successfully");
 
+    // Hard/soft-iron correction from the last IMU_MAGCAL (NVS is up from ble_setup)
+    if (icm20948_mag_cal_load(&imu_sensor) != ESP_OK) {
+        ESP_LOGW(TAG, "No magnetometer calibration saved, heading uses raw readings");
+    }
+
     imu_idle_evt_queue = xQueueCreate(4, sizeof(uint32_t));
     if (imu_idle_evt_queue == NULL) {
         ESP_LOGE(TAG, "Failed to create IMU idle event queue");
@@ -527,7 +849,101 @@ static void imu_setup(void){
         ESP_LOGI(TAG, "IMU accelerometer verified working");
     }
 
+    // Full-rate motion from the chip FIFO; the monitor task polls instead if this isn't running
+    #if ENABLE_IMU_FIFO
+    imu_fifo = imu_fifo_create(&imu_sensor, IMU_INT_PIN);
+    imu_fifo_subscribe(imu_fifo, on_imu_block, &imu_sensor);
+    #endif
+
+    // Orientation filter: subscribes to the FIFO, so it has to exist before the FIFO starts
+    imu_ahrs_config_t ahrs_cfg = {
+        .beta = IMU_AHRS_BETA,
+        .poll_hz = IMU_AHRS_POLL_HZ,
+    };
+    imu_ahrs = imu_ahrs_create(&imu_sensor, imu_fifo, &ahrs_cfg);
+    imu_ahrs_start(imu_ahrs, IMU_AHRS_TASK_PRIORITY);
+
+    // Dead reckoning between cart tracking RFID fixes (runs on the FIFO blocks)
+    #if ENABLE_IMU_FIFO && ENABLE_CART_TRACKING
+    cart_odom_config_t odom_cfg = {
+        .stride_m = CT_ODOM_STRIDE_M,
+        .step_g = CT_ODOM_STEP_G,
+        .min_step_ms = CT_ODOM_MIN_STEP_MS,
+        .point_ms = CT_ODOM_POINT_MS,
+    };
+    cart_odometry = cart_odometry_create(&imu_sensor, imu_fifo, imu_ahrs, &odom_cfg);
+    #endif
+
+    // Magnetometer calibration runs on demand (IMU_MAGCAL)
+    imu_mag_cal_config_t mag_cal_cfg = {
+        .timeout_ms = IMU_MAG_CAL_TIMEOUT_MS,
+        .sample_hz = IMU_MAG_CAL_SAMPLE_HZ,
+        .coverage_deg = IMU_MAG_CAL_COVERAGE_DEG,
+    };
+    imu_mag_cal = imu_mag_cal_create(&imu_sensor, &mag_cal_cfg, on_imu_mag_cal, NULL);
+
+    // One level reference for the classifier and the alerts (subscribes ahead of both)
+    #if ENABLE_IMU_FIFO && (ENABLE_IMU_CLASSIFIER || ENABLE_IMU_ALERTS)
+    imu_level = imu_level_create(imu_fifo);
+    #endif
+
+    // Parked / pushed / bumped / lifted / tilted over sliding FIFO windows
+    #if ENABLE_IMU_FIFO && ENABLE_IMU_CLASSIFIER
+    imu_class_config_t class_cfg = {
+        .window = imu_rates_window_samples(IMU_CLASS_WINDOW_MS, IMU_FIFO_ODR_HZ),
+        .hop = imu_rates_window_samples(IMU_CLASS_WINDOW_MS, IMU_FIFO_ODR_HZ) / 2,
+        .push_var_g2 = IMU_CLASS_PUSH_VAR_G2,
+        .push_gyro_dps = IMU_CLASS_PUSH_GYRO_DPS,
+        .bump_jerk_gps = IMU_CLASS_BUMP_JERK_GPS,
+        .lift_g = IMU_CLASS_LIFT_G,
+        .tilt_deg = IMU_CLASS_TILT_DEG,
+    };
+    imu_classifier = imu_classifier_create(imu_fifo, imu_level, &class_cfg, on_imu_class, NULL);
+    #endif
+
+    // Tip / lift / impact on every FIFO sample, sent from a dedicated alert task
+    #if ENABLE_IMU_FIFO && ENABLE_IMU_ALERTS
+    imu_alert_config_t alert_cfg = {
+        .tip_deg = IMU_ALERT_TIP_DEG,
+        .tip_ms = IMU_ALERT_TIP_MS,
+        .lift_g = IMU_ALERT_LIFT_G,
+        .lift_ms = IMU_ALERT_LIFT_MS,
+        .impact_g = IMU_ALERT_IMPACT_G,
+        .cooldown_ms = IMU_ALERT_COOLDOWN_MS,
+    };
+    imu_alert = imu_alert_create(imu_fifo, imu_level, &alert_cfg, on_imu_alert, NULL);
+    imu_alert_start(imu_alert, IMU_ALERT_TASK_PRIORITY);
+    #endif
+
+    // Sample / feature / event rates, from NVS if IMU_RATE saved some (sets the FIFO config below)
+    imu_rates_t rate_defaults = {
+        .odr_hz = IMU_FIFO_ODR_HZ,
+        .window_ms = IMU_CLASS_WINDOW_MS,
+        .event_ms = IMU_EVENT_INTERVAL_MS,
+    };
+    imu_rates = imu_rates_create(&imu_sensor, imu_fifo, imu_classifier, &rate_defaults, IMU_FIFO_BATCH_MS);
+    imu_rates_load(imu_rates);
+
+    #if ENABLE_IMU_FIFO
+    if (imu_fifo_start(imu_fifo, &imu_fifo->cfg, IMU_FIFO_TASK_PRIORITY) != ESP_OK) {
+        ESP_LOGW(TAG, "IMU FIFO unavailable, polling motion instead");
+    }
+    #endif
+
+    // Idle and resume from the wake-on-motion interrupt instead of counting monitor ticks
+    #if ENABLE_IMU_WAKE_ON_MOTION
+    imu_wake_config_t wake_cfg = {
+        .idle_ms = IMU_IDLE_TIME_MINUTES * 60 * 1000,
+        .wom_thr_mg = IMU_WOM_THRESHOLD_MG,
+        .cycle_hz = IMU_PARKED_ACCEL_HZ,
+    };
+    imu_wake = imu_wake_create(&imu_sensor, imu_fifo, IMU_INT_PIN, &wake_cfg, on_imu_wake, NULL);
+    imu_wake_start(imu_wake, IMU_FIFO_TASK_PRIORITY);
+    #endif
+
     // Create dedicated IMU monitoring task (1 second interval)
+    task_stop_init(&imu_monitor_stop);
+    imu_monitor_running = true;
     xTaskCreate(icm20948_monitor_task, "imu_monitor", 4096, &imu_sensor, IMU_TASK_PRIORITY, &imu_monitor_task_handle);
     ESP_LOGI(TAG, "IMU monitoring task created (5-minute idle timeout)");
 }
@@ -603,8 +1019,9 @@ static void produce_loadcell_setup(void)
     ESP_LOGI(TAG, "Initializing load cell...");
     produce_load_cell = load_cell_create(TOP_LOAD_CLK_PIN, TOP_LOAD_DATA_PIN, 25, false);
     load_cell_begin(produce_load_cell);
-    load_cell_tare(produce_load_cell);
-    ESP_LOGI(TAG, "Load cell initialized and tared.");
+    if (load_cell_cal_load(produce_load_cell) != ESP_OK) {
+        ESP_LOGI(TAG, "No saved produce calibration, using built-in scale");
+    }
 }
 
 static void cart_loadcell_setup(void)
@@ -612,8 +1029,89 @@ static void cart_loadcell_setup(void)
     ESP_LOGI(TAG, "Initializing load cell...");
     cart_load_cell = load_cell_create(BOTTOM_LOAD_CLK_PIN, BOTTOM_LOAD_DATA_PIN, 25, true);
     load_cell_begin(cart_load_cell);
-    load_cell_tare(cart_load_cell);
-    ESP_LOGI(TAG, "Load cell initialized and tared.");
+    if (load_cell_cal_load(cart_load_cell) != ESP_OK) {
+        ESP_LOGI(TAG, "No saved cart calibration, using built-in scale");
+    }
+    #if ENABLE_LOAD_CELL_SPI
+    load_cell_use_spi(cart_load_cell, CART_LOAD_SPI_HOST);
+    #endif
+}
+
+static void loadcell_pipeline_setup(void)
+{
+    #if ENABLE_LOAD_CELL_GROUP
+    LoadCell* cells[] = { produce_load_cell, cart_load_cell };
+    load_cell_group = load_cell_group_create(cells, 2);
+    #endif
+    loadcell_acquisition_start();
+    load_cell_tare_async(produce_load_cell, NULL, NULL);
+    load_cell_tare_async(cart_load_cell, NULL, NULL);
+
+    weight_filter_config_t wf_cfg = {
+        .outlier_g = WF_OUTLIER_G,
+        .outlier_persist = WF_OUTLIER_PERSIST,
+        .iir_alpha = WF_IIR_ALPHA,
+        .settle_window_ms = WF_SETTLE_WINDOW_MS,
+        .settle_band_g = WF_SETTLE_BAND_G,
+        .min_change_g = WF_MIN_CHANGE_G,
+        .still_window_ms = WF_STILL_WINDOW_MS,
+    };
+    produce_weight_filter = weight_filter_create(produce_load_cell, &wf_cfg, NULL);
+    cart_weight_filter = weight_filter_create(cart_load_cell, &wf_cfg, on_cart_weight_event);
+
+    weight_cusum_config_t cusum_cfg = {
+        .drift_g = CUSUM_DRIFT_G,
+        .threshold_g = CUSUM_THRESHOLD_G,
+        .min_step_g = WF_MIN_CHANGE_G,
+        .confirm_samples = CUSUM_CONFIRM_SAMPLES,
+        .motion_holdoff_ms = CUSUM_MOTION_HOLDOFF_MS,
+    };
+    cart_weight_cusum = weight_cusum_create(&cusum_cfg, on_cart_step);
+    weight_cusum_attach(cart_weight_cusum, cart_weight_filter);
+
+    weight_filter_start(produce_weight_filter, WEIGHT_FILTER_TASK_PRIORITY);
+    weight_filter_start(cart_weight_filter, WEIGHT_FILTER_TASK_PRIORITY);
+    produce_stream = weight_stream_create(produce_weight_filter, on_produce_stream);
+
+    load_cell_health_config_t health_cfg = {
+        .interval_ms = LC_HEALTH_INTERVAL_MS,
+        .stall_ms = LC_STALL_MS,
+        .stuck_samples = LC_STUCK_SAMPLES,
+        .az_band_g = LC_AZ_BAND_G,
+        .az_gain = LC_AZ_GAIN,
+        .az_max_step_g = LC_AZ_MAX_STEP_G,
+        .az_max_total_g = LC_AZ_MAX_TOTAL_G,
+    };
+    load_cell_health = load_cell_health_create(&health_cfg, on_load_cell_health);
+    load_cell_health_add(load_cell_health, produce_load_cell, produce_weight_filter, "PROD");
+    load_cell_health_add(load_cell_health, cart_load_cell, cart_weight_filter, "CART");
+    load_cell_health_start(load_cell_health, LOAD_CELL_HEALTH_TASK_PRIORITY);
+    ESP_LOGI(TAG, "Load cells initialized, taring in the background.");
+}
+
+// Both HX711s are clocked together by the group when enabled, otherwise each by its own sampler
+static void loadcell_acquisition_start(void)
+{
+    #if ENABLE_LOAD_CELL_GROUP
+    if (load_cell_group != NULL) {
+        load_cell_group_start(load_cell_group, LOAD_CELL_TASK_PRIORITY);
+        return;
+    }
+    #endif
+    load_cell_start_sampling(produce_load_cell, LOAD_CELL_TASK_PRIORITY);
+    load_cell_start_sampling(cart_load_cell, LOAD_CELL_TASK_PRIORITY);
+}
+
+static void loadcell_acquisition_stop(void)
+{
+    #if ENABLE_LOAD_CELL_GROUP
+    if (load_cell_group != NULL) {
+        load_cell_group_stop(load_cell_group);
+        return;
+    }
+    #endif
+    load_cell_stop_sampling(produce_load_cell);
+    load_cell_stop_sampling(cart_load_cell);
 }
 
 static void item_rfid_setup(void)
@@ -626,6 +1124,31 @@ static void item_rfid_setup(void)
         on_item_scan_complete
     );
     ESP_LOGI(TAG, "Item RFID reader initialized");
+
+    iv_trigger_config_t iv_cfg = {
+        .debounce_ms = IV_TRIGGER_DEBOUNCE_MS,
+        .min_interval_ms = IV_MIN_SCAN_INTERVAL_MS,
+        .fallback_interval_ms = IV_FALLBACK_INTERVAL_MS,
+    };
+    iv_trigger_init(&iv_cfg);
+    task_stop_init(&item_verification_stop);
+
+    tag_classifier_config_t tag_cfg = {
+        .min_reads = TAG_MIN_READS,
+        .rssi_in_basket = TAG_RSSI_IN_BASKET,
+        .rssi_ambient = TAG_RSSI_AMBIENT,
+        .max_rssi_spread = TAG_MAX_RSSI_SPREAD,
+        .persist_scans = TAG_PERSIST_SCANS,
+    };
+    tag_classifier_init(&tag_cfg);
+
+    iv_fusion_config_t fusion_cfg = {
+        .window_ms = IV_FUSION_WINDOW_MS,
+        .min_item_g = IV_FUSION_MIN_ITEM_G,
+    };
+    iv_fusion_init(&fusion_cfg);
+
+    tag_registry_init();
 }
 
 static void cart_tracking_setup(void) {
@@ -672,26 +1195,124 @@ static void icm20948_monitor_task(void *arg)
     ICM20948_t *imu = (ICM20948_t *)arg;
 
     ESP_LOGI(TAG, "IMU monitor task started");
+    enum IMUstatus prev_status = imu->status;
+    uint32_t activity_elapsed_ms = imu->event_ms;
 
-    while (1) {
-        icm20948_activity_task(imu);
+    while (imu_monitor_running) {
+        // Without the FIFO, poll the fast motion state here (on_imu_block does it per batch otherwise)
+        if (!imu_fifo_is_running(imu_fifo) && !imu->parked) {
+            publish_cart_motion(icm20948_update_motion(imu));
+        }
+
+        activity_elapsed_ms += IMU_MOTION_POLL_MS;
+        if (activity_elapsed_ms >= imu->event_ms) {
+            activity_elapsed_ms = 0;
+            if (imu_wake_is_running(imu_wake)) {
+                // Idle and resume are interrupt driven (on_imu_wake), just keep the reported state current
+                icm20948_is_moving(imu);
+                imu->idle_counter_ms = xTaskGetTickCount() * portTICK_PERIOD_MS - imu->last_motion_ms;
+            } else {
+                icm20948_activity_task(imu);
+            }
+
+            // Cart started or stopped moving: items are usually added around these transitions
+            if (imu->status != prev_status) {
+                iv_trigger_post(IV_TRIGGER_MOTION);
+                prev_status = imu->status;
+            }
+        }
+
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMU_MOTION_POLL_MS));
+    }
+
+    task_stop_exit(&imu_monitor_stop);
+}
+
+// Fast motion state gates both scales and the cart step detector
+static void publish_cart_motion(bool moving)
+{
+    weight_filter_set_motion(produce_weight_filter, moving);
+    weight_filter_set_motion(cart_weight_filter, moving);
+    weight_cusum_set_motion(cart_weight_cusum, moving);
+}
+
+// IMU parked after IMU_IDLE_TIME_MINUTES still, or woken by motion (runs in the IMU wake task)
+static void on_imu_wake(void *ctx, imu_wake_event_t evt)
+{
+    uint32_t event = 1;
+    if (evt == IMU_WAKE_PARKED) {
+        publish_cart_motion(false);
+        xQueueSend(imu_idle_evt_queue, &event, 0);
+    } else {
+        xQueueSend(imu_motion_after_idle_queue, &event, 0);
+        iv_trigger_post(IV_TRIGGER_MOTION);
+    }
+}
+
+// Motion class changed (runs in the IMU FIFO task)
+static void on_imu_class(void *ctx, imu_class_t cls, const imu_class_features_t *f)
+{
+    ESP_LOGI(TAG, "IMU class %s (var %.5f g2, jerk peak %.1f g/s, tilt %.1f deg, %lu us)",
+             imu_class_str(cls), f->var_g2, f->jerk_peak_gps, f->tilt_deg, f->cpu_us);
+}
 
-        vTaskDelay(pdMS_TO_TICKS(IMU_MONITOR_INTERVAL_MS));
+// Magnetometer calibration finished (runs in the calibration task)
+static void on_imu_mag_cal(void *ctx, imu_mag_cal_result_t result, const icm20948_mag_cal_t *cal, float fit_err)
+{
+    char msg[96];
+    if (result == IMU_MAG_CAL_DONE) {
+        snprintf(msg, sizeof(msg), "[IMU] MAGCAL DONE: OFFSET=%.1f,%.1f,%.1f ERR=%.1f%%",
+                 cal->hard_ut[0], cal->hard_ut[1], cal->hard_ut[2], fit_err * 100.0f);
+    } else {
+        snprintf(msg, sizeof(msg), "[IMU] MAGCAL FAILED: %s", imu_mag_cal_result_str(result));
     }
+    safe_ble_send_misc_data(msg);
+}
+
+// Tip / lift / impact (runs in the IMU alert task, not the FIFO task or the BLE command path)
+static void on_imu_alert(void *ctx, const imu_alert_t *alert)
+{
+    char msg[64];
+    snprintf(msg, sizeof(msg), "[ALERT] %s %.2f +%lums",
+             imu_alert_str(alert->type), alert->value, alert->latency_us / 1000);
+
+    // Safety alerts wait out a cart tracking transfer instead of being dropped like misc data
+    for (int i = 0; i < 100 && is_cart_tracking_transfer_active(); i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    ble_send_misc_data(msg);
+}
+
+// One FIFO batch of accel + gyro samples (runs in the IMU FIFO task)
+static void on_imu_block(void *ctx, const imu_fifo_block_t *blk)
+{
+    ICM20948_t *imu = (ICM20948_t *)ctx;
+    publish_cart_motion(icm20948_update_motion_block(imu, blk->samples, blk->count));
 }
 
 static void item_verification_task(void *arg)
 {
-    ESP_LOGI(TAG, "Item verification task started (periodic RFID scan every %d ms)", ITEM_VERIFICATION_INTERVAL_MS);
+    ESP_LOGI(TAG, "Item verification task started (event-triggered, fallback scan every %d ms)", IV_FALLBACK_INTERVAL_MS);
+
+    // Weight changes arrive from the cart weight filter (on_cart_weight_event)
+    while (item_verification_running) {
+        uint32_t sources = iv_trigger_wait(pdMS_TO_TICKS(IV_VERDICT_INTERVAL_MS));
+        if (!item_verification_running) {
+            break;
+        }
+
+        if (sources == IV_TRIGGER_NONE) {
+            report_iv_verdict(false);
+            continue;
+        }
 
-    while (1) {
         #if ENABLE_ITEM_VERIFICATION
         if (!item_rfid_is_scanning(item_reader)) {
             esp_err_t scan_ret = item_rfid_scan(item_reader);
             if (scan_ret == ESP_OK) {
-                ESP_LOGI(TAG, "✓ Periodic RFID scan triggered successfully");
+                ESP_LOGI(TAG, "✓ RFID scan triggered (sources=0x%02lx)", sources);
             } else {
-                ESP_LOGW(TAG, "✗ Failed to trigger periodic RFID scan (error: %d)", scan_ret);
+                ESP_LOGW(TAG, "✗ Failed to trigger RFID scan (error: %d)", scan_ret);
             }
         } else {
             ESP_LOGD(TAG, "RFID scan already in progress, skipping trigger");
@@ -699,9 +1320,56 @@ static void item_verification_task(void *arg)
         #else
         ESP_LOGI(TAG, "Item Verification is DISABLED - skipping item scan");
         #endif
+    }
+
+    task_stop_exit(&item_verification_stop);
+}
+
+#if ENABLE_ITEM_VERIFICATION
+_Static_assert(sizeof(IV_CLEAR_PIN) > 4, "IV_CLEAR_PIN: set this store's staff code (4+ characters) in cartediem_defs.h");
+#endif
 
-        vTaskDelay(pdMS_TO_TICKS(ITEM_VERIFICATION_INTERVAL_MS));
+// Staff code check for IV_CLEAR: constant-time compare, locked out after repeated misses
+static bool iv_clear_authorized(const char *pin)
+{
+    static uint32_t failures = 0;
+    static uint32_t locked_until_ms = 0;
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (failures >= IV_CLEAR_MAX_TRIES) {
+        if ((int32_t)(now - locked_until_ms) < 0) {
+            return false;
+        }
+        failures = 0;
     }
+
+    const char *expected = IV_CLEAR_PIN;
+    size_t len = strlen(expected);
+    uint8_t diff = (strlen(pin) != len);
+    for (size_t i = 0; i < len; i++) {
+        diff |= (uint8_t)(pin[i] ^ expected[i]);
+        if (pin[i] == '\0') break;
+    }
+    if (diff == 0) {
+        failures = 0;
+        return true;
+    }
+    if (++failures >= IV_CLEAR_MAX_TRIES) {
+        locked_until_ms = now + IV_CLEAR_LOCKOUT_MS;
+        ESP_LOGW(TAG, "IV_CLEAR locked for %d s after %d wrong codes", IV_CLEAR_LOCKOUT_MS / 1000, IV_CLEAR_MAX_TRIES);
+    }
+    return false;
+}
+
+// Let the verification task finish its pass (it may hold the fusion lock) and exit
+static void item_verification_task_stop(void)
+{
+    if (item_verification_task_handle == NULL) {
+        return;
+    }
+    item_verification_running = false;
+    iv_trigger_cancel();
+    task_stop_join(&item_verification_stop, &item_verification_task_handle);
+    ESP_LOGI(TAG, "Item verification task stopped");
 }
 
 static void cart_tracking_task(void *arg)
@@ -710,7 +1378,10 @@ static void cart_tracking_task(void *arg)
 
     while (1) {
         if (mode_cart_tracking) {
+            // Dead-reckoned track since the last burst goes in ahead of this one
+            cart_odometry_write(cart_odometry, CT_SESSION_LOG);
             BurstRead_CartTracking();
+            cart_odometry_fix(cart_odometry);
             ESP_LOGI(TAG, "Cart tracking burst read completed");
         }
 
@@ -721,26 +1392,245 @@ static void cart_tracking_task(void *arg)
 
 // Other callback functions...
 void on_item_scan_complete(const item_rfid_tag_t *tags, int count) {
-    ESP_LOGI(TAG, "Found %d items in cart", count);
+    // Drop tags heard from nearby shelves before they reach the Pi
+    static tag_class_t classes[ITEM_RFID_MAX_TAGS];
+    int reported = tag_classifier_classify(tags, count, classes);
+    ESP_LOGI(TAG, "Found %d items in cart (%d ambient tags ignored)", reported, count - reported);
 
     float cart_weight = load_cell_display_pounds(cart_load_cell);
+    if (isnan(cart_weight)) {
+        // Scan again with the weight once on_tare_complete runs
+        ESP_LOGW(TAG, "Cart is being tared, weight verification deferred until the tare completes");
+        iv_deferred_by_tare = true;
+    } else if (!weight_filter_is_confident(cart_weight_filter)) {
+        // Pushing the cart makes the weight noise, verify again after the post-motion settle
+        ESP_LOGI(TAG, "Cart moving, weight verification deferred until it is still");
+        iv_deferred_by_motion = true;
+        cart_weight = NAN;
+    }
 
     char verification_msg[512] = {0};
-    int offset = snprintf(verification_msg, sizeof(verification_msg), "%.4f,%d", cart_weight, count);
+    int offset = snprintf(verification_msg, sizeof(verification_msg), "%.4f,%d", cart_weight, reported);
 
     for (int i = 0; i < count && offset < (int)sizeof(verification_msg) - 1; i++) {
+        if (classes[i] == TAG_CLASS_AMBIENT) {
+            continue;
+        }
         offset += snprintf(verification_msg + offset,
                           sizeof(verification_msg) - offset,
                           ",%s",
                           tags[i].tag);
     }
 
-    esp_err_t send_ret = ble_send_item_verification(verification_msg);
+    esp_err_t send_ret = isnan(cart_weight) ? ESP_ERR_INVALID_STATE : ble_send_item_verification(verification_msg);
     if (send_ret == ESP_OK) {
         ESP_LOGI(TAG, "✓ Cart verification sent via BLE: %s", verification_msg);
     } else {
         ESP_LOGW(TAG, "✗ Failed to send cart verification via BLE");
     }
+
+    // Local unscanned-item check against the registry pushed by the Pi; basket tags
+    // claim the scanned units of their UPC before uncertain ones
+    int unscanned_in_basket = 0, unscanned_uncertain = 0;
+    tag_registry_begin_scan();
+    for (int pass = TAG_CLASS_IN_BASKET; pass >= TAG_CLASS_UNCERTAIN; pass--) {
+        for (int i = 0; i < count; i++) {
+            char upc[TAG_REGISTRY_UPC_LEN + 1];
+            if (classes[i] == pass && tag_registry_check(tags[i].tag, upc) == TAG_REG_UNSCANNED) {
+                char alert_msg[128];
+                snprintf(alert_msg, sizeof(alert_msg), "[IV] UNSCANNED %s %s", upc, tags[i].tag);
+                ESP_LOGW(TAG, "Unscanned RFID item: UPC %s (tag %s)", upc, tags[i].tag);
+                safe_ble_send_misc_data(alert_msg);
+
+                if (pass == TAG_CLASS_IN_BASKET) unscanned_in_basket++;
+                else unscanned_uncertain++;
+            }
+        }
+    }
+    iv_fusion_on_tags(unscanned_in_basket, unscanned_uncertain);
+    report_iv_verdict(false);
+}
+
+// Cart weight filter events: publish to the Pi and feed item verification
+static void on_cart_weight_event(WeightFilter *wf, const weight_event_t *evt)
+{
+    char weight_msg[64];
+    if (evt->type == WEIGHT_EVT_SETTLED) {
+        snprintf(weight_msg, sizeof(weight_msg), "[CART_LOAD] SETTLED %.1f", evt->grams);
+        if (iv_deferred_by_motion) {
+            iv_deferred_by_motion = false;
+            iv_trigger_post(IV_TRIGGER_MOTION);
+        }
+    } else {
+        snprintf(weight_msg, sizeof(weight_msg), "[CART_LOAD] %s %.1f %.1f",
+                 weight_event_str(evt->type), evt->delta_g, evt->grams);
+        ESP_LOGI(TAG, "Cart weight %s %.1f g (now %.1f g)", weight_event_str(evt->type), evt->delta_g, evt->grams);
+
+        iv_fusion_on_weight(evt->grams, evt->delta_g);
+        iv_trigger_post(IV_TRIGGER_WEIGHT);
+    }
+    safe_ble_send_misc_data(weight_msg);
+}
+
+// Fast step detection on the cart scale (runs in the weight filter task); the settled
+// ADDED/REMOVED events still drive fusion, this only triggers an early RFID scan
+static void on_cart_step(WeightCusum *det, const cusum_event_t *evt)
+{
+    ESP_LOGI(TAG, "Cart step %s %.1f g (confidence %d%%, %lu ms after the change)",
+             cusum_event_str(evt->type), evt->magnitude_g, evt->confidence, evt->latency_ms);
+    if (evt->type == CUSUM_EVT_TRANSIENT || evt->type == CUSUM_EVT_SHIFT) {
+        return;  // bump, hand on the basket or slow creep: no item moved
+    }
+
+    char step_msg[64];
+    snprintf(step_msg, sizeof(step_msg), "[CART_LOAD] STEP %s %.1f %d",
+             cusum_event_str(evt->type), evt->magnitude_g, evt->confidence);
+    safe_ble_send_misc_data(step_msg);
+    iv_trigger_post(IV_TRIGGER_WEIGHT);
+}
+
+// Load cell fault or drift (runs in the load cell health task)
+static void on_load_cell_health(const char *name, LoadCell *lc, load_cell_health_t state)
+{
+    char health_msg[48];
+    snprintf(health_msg, sizeof(health_msg), "[LOAD] HEALTH %s %s", name, load_cell_health_str(state));
+    safe_ble_send_misc_data(health_msg);
+}
+
+// Async tare finished (runs in the load cell sampler task)
+static void on_tare_complete(LoadCell *lc, void *ctx)
+{
+    char tare_msg[32];
+    snprintf(tare_msg, sizeof(tare_msg), "[TARE] %s DONE", (const char *)ctx);
+    ESP_LOGI(TAG, "%s load cell tared (offset %ld)", (const char *)ctx, lc->tare_offset);
+    safe_ble_send_misc_data(tare_msg);
+
+    if (lc == cart_load_cell && iv_deferred_by_tare) {
+        iv_deferred_by_tare = false;
+        iv_trigger_post(IV_TRIGGER_WEIGHT);
+    }
+}
+
+// Live produce weight (runs in the stream task): "L:<oz>" while it moves, "S:<oz>" once settled
+static void on_produce_stream(WeightStream *ws, float grams, weight_stream_reason_t reason)
+{
+    if (reason == WEIGHT_STREAM_TIMEOUT) {
+        safe_ble_send_misc_data("[PROD] STREAM END");
+        return;
+    }
+
+    if (is_cart_tracking_transfer_active()) {
+        return;  // live values are disposable, don't compete with the transfer
+    }
+
+    float mg = fabsf(grams) * 1000.0f;
+    if (mg < LOAD_CELL_DEADBAND_MG) {
+        mg = 0.0f;
+    }
+    char weight_str[32];
+    snprintf(weight_str, sizeof(weight_str), "%c:%.4f",
+             reason == WEIGHT_STREAM_SETTLED ? 'S' : 'L', mg * LOAD_CELL_OZ_PER_MG);
+    ble_send_produce_weight(weight_str);
+}
+
+// "CAL_<STEP>,<PROD|CART>[,<grams>]" - multi-point load cell calibration from the Pi:
+// CAL_START tares the empty scale, CAL_POINT captures a known mass (repeat for
+// each reference weight), CAL_SAVE applies and stores the map in NVS,
+// CAL_RESET goes back to the built-in scale
+static void handle_cal_command(const char *data)
+{
+    char step[12];
+    char cell[8];
+    float grams = 0.0f;
+    char cal_msg[64];
+
+    int fields = sscanf(data, "CAL_%11[^,],%7[^,],%f", step, cell, &grams);
+    LoadCell *lc = NULL;
+    if (fields >= 2 && strcmp(cell, "PROD") == 0) {
+        lc = produce_load_cell;
+    } else if (fields >= 2 && strcmp(cell, "CART") == 0) {
+        lc = cart_load_cell;
+    }
+    if (lc == NULL) {
+        safe_ble_send_misc_data("[CAL] ERROR BAD_CELL");
+        return;
+    }
+
+    esp_err_t ret;
+    if (strcmp(step, "START") == 0) {
+        ret = load_cell_cal_begin(lc, on_tare_complete, lc == produce_load_cell ? "PROD" : "CART");
+        snprintf(cal_msg, sizeof(cal_msg), "[CAL] %s %s", cell, ret == ESP_OK ? "TARING" : "BUSY");
+    } else if (strcmp(step, "POINT") == 0 && fields == 3) {
+        ret = load_cell_cal_add_point(lc, (int32_t)lroundf(grams * 1000.0f));
+        if (ret == ESP_OK) {
+            snprintf(cal_msg, sizeof(cal_msg), "[CAL] %s POINT %d %.1f", cell, lc->cal_pending, grams);
+        } else {
+            snprintf(cal_msg, sizeof(cal_msg), "[CAL] %s ERROR %s", cell, esp_err_to_name(ret));
+        }
+    } else if (strcmp(step, "SAVE") == 0) {
+        uint8_t points = lc->cal_pending;
+        ret = load_cell_cal_commit(lc);
+        if (ret == ESP_OK) {
+            snprintf(cal_msg, sizeof(cal_msg), "[CAL] %s SAVED %d", cell, points);
+        } else {
+            snprintf(cal_msg, sizeof(cal_msg), "[CAL] %s ERROR %s", cell, esp_err_to_name(ret));
+        }
+    } else if (strcmp(step, "RESET") == 0) {
+        ret = load_cell_cal_reset(lc);
+        snprintf(cal_msg, sizeof(cal_msg), "[CAL] %s RESET%s", cell, ret == ESP_OK ? "" : " NOT_SAVED");
+    } else {
+        snprintf(cal_msg, sizeof(cal_msg), "[CAL] ERROR BAD_STEP");
+    }
+    ESP_LOGI(TAG, "%s", cal_msg);
+    safe_ble_send_misc_data(cal_msg);
+}
+
+// Send the fused verdict when it changes (or always if forced), freeze checkout on failure
+static void report_iv_verdict(bool force)
+{
+    // Hold unprompted verdicts while the cart moves; they'd judge shaken weights
+    if (!force && !weight_filter_is_confident(cart_weight_filter)) {
+        return;
+    }
+
+    iv_verdict_t verdict;
+    bool changed = iv_fusion_evaluate(&verdict);
+    if (!changed && !force) {
+        return;
+    }
+
+    char verdict_msg[96];
+    snprintf(verdict_msg, sizeof(verdict_msg), "[IV] VERDICT %s %u 0x%02lx %.0f %.0f %d %d",
+             iv_verdict_str(verdict.level), verdict.confidence, verdict.reasons,
+             verdict.measured_g, verdict.expected_g, verdict.scanned_items, verdict.placed_items);
+    ESP_LOGI(TAG, "Item verification verdict: %s", verdict_msg);
+    safe_ble_send_misc_data(verdict_msg);
+
+    if (iv_fusion_checkout_frozen() && mode_payment) {
+        ESP_LOGW(TAG, "Checkout frozen by item verification, payment cancelled");
+        mode_payment = false;
+        safe_ble_send_misc_data("[PAY] FROZEN");
+    }
+}
+
+// Parse "<epc>,<upc>,<epc>,<upc>..." and add each pair to the registry
+static int registry_add_batch(const char *args)
+{
+    char batch[512];
+    strncpy(batch, args, sizeof(batch) - 1);
+    batch[sizeof(batch) - 1] = '\0';
+
+    int failed = 0;
+    char *save = NULL;
+    char *epc = strtok_r(batch, ",", &save);
+    while (epc != NULL) {
+        char *upc = strtok_r(NULL, ",", &save);
+        if (upc == NULL || tag_registry_add(epc, upc) != ESP_OK) {
+            failed++;
+        }
+        epc = strtok_r(NULL, ",", &save);
+    }
+    return failed;
 }
 
 static void handle_imu_idle_event(void)
@@ -772,18 +1662,15 @@ static void outdoor_setting(){
     ESP_LOGI(TAG, "Disabling all components except BLE...");
 
     // Stop item verification task if running
-    if (item_verification_task_handle != NULL) {
-        vTaskDelete(item_verification_task_handle);
-        item_verification_task_handle = NULL;
-        ESP_LOGI(TAG, "Item verification task stopped");
-    }
+    item_verification_task_stop();
 
-    // Stop IMU monitoring task
-    if (imu_monitor_task_handle != NULL) {
-        vTaskDelete(imu_monitor_task_handle);
-        imu_monitor_task_handle = NULL;
-        ESP_LOGI(TAG, "IMU monitoring task stopped");
-    }
+    // Stop IMU monitoring task and FIFO batching (let them finish their bus transfers)
+    imu_wake_stop(imu_wake);
+    imu_fifo_stop(imu_fifo);
+    imu_ahrs_stop(imu_ahrs);
+    imu_monitor_running = false;
+    task_stop_join(&imu_monitor_stop, &imu_monitor_task_handle);
+    ESP_LOGI(TAG, "IMU monitoring task stopped");
 
     // Stop cart tracking
     #if ENABLE_CART_TRACKING
@@ -793,6 +1680,7 @@ static void outdoor_setting(){
         cart_tracking_task_handle = NULL;
         ESP_LOGI(TAG, "Cart tracking task stopped");
     }
+    cart_odometry_stop(cart_odometry);
 
     ESP_LOGI(TAG, "Cart tracking disabled");
     #endif
@@ -819,6 +1707,14 @@ static void outdoor_setting(){
     mode_payment = false;
     ESP_LOGI(TAG, "Payment mode disabled");
 
+    // Stop load cell samplers
+    weight_stream_stop(produce_stream);
+    load_cell_health_stop(load_cell_health);
+    weight_filter_stop(produce_weight_filter);
+    weight_filter_stop(cart_weight_filter);
+    loadcell_acquisition_stop();
+    ESP_LOGI(TAG, "Load cell samplers stopped");
+
     // Disable item verification (RFID)
     #if ENABLE_ITEM_VERIFICATION
     if (item_reader != NULL) {
@@ -838,6 +1734,12 @@ static void indoor_setting(){
 
     // Re-enable IMU monitoring task
     if (imu_monitor_task_handle == NULL) {
+        #if ENABLE_IMU_FIFO
+        imu_fifo_start(imu_fifo, &imu_fifo->cfg, IMU_FIFO_TASK_PRIORITY);   // last IMU_RATE config
+        #endif
+        imu_ahrs_start(imu_ahrs, IMU_AHRS_TASK_PRIORITY);
+        imu_wake_start(imu_wake, IMU_FIFO_TASK_PRIORITY);
+        imu_monitor_running = true;
         xTaskCreate(icm20948_monitor_task, "imu_monitor", 4096, &imu_sensor, IMU_TASK_PRIORITY, &imu_monitor_task_handle);
         ESP_LOGI(TAG, "IMU monitoring task re-enabled");
     }
@@ -846,6 +1748,13 @@ static void indoor_setting(){
     barcode_set_manual_mode(&barcanner);
     ESP_LOGI(TAG, "Barcode scanner re-enabled");
 
+    // Restart load cell samplers
+    loadcell_acquisition_start();
+    weight_filter_start(produce_weight_filter, WEIGHT_FILTER_TASK_PRIORITY);
+    weight_filter_start(cart_weight_filter, WEIGHT_FILTER_TASK_PRIORITY);
+    load_cell_health_start(load_cell_health, LOAD_CELL_HEALTH_TASK_PRIORITY);
+    ESP_LOGI(TAG, "Load cell samplers restarted");
+
     // Re-enable button interrupt
     gpio_isr_handler_add(BUTTON_PIN, button_isr, NULL);
     ESP_LOGI(TAG, "Button interrupt re-enabled");
@@ -0,0 +1,6 @@
+#ifndef DRIVER_UART_H
+#define DRIVER_UART_H
+
+typedef int uart_port_t;
+
+#endif // DRIVER_UART_H
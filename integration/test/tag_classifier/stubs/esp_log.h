@@ -0,0 +1,10 @@
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+// Host build: firmware logging compiled out
+#define ESP_LOGE(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGW(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGI(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGD(tag, fmt, ...) ((void)(tag))
+
+#endif // ESP_LOG_H